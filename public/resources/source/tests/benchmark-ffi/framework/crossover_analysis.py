@@ -547,6 +547,31 @@ class CrossoverAnalyzer:
         except ImportError:
             return lambda size: float('inf')
     
+    def create_pybind11_blocked_matmul_benchmark(self) -> Callable[[int], float]:
+        """Create pybind11 blocked/SIMD matrix multiplication benchmark function.
+        
+        Same call shape as create_pybind11_matmul_benchmark, so the gap between
+        the two shows where compute efficiency, not FFI overhead, dominates.
+        """
+        try:
+            import benchlib_pybind11 as pybind11_lib
+            
+            def pybind11_blocked_matmul(size: int) -> float:
+                # Create test matrices
+                a = np.random.random((size, size)).astype(np.float64)
+                b = np.random.random((size, size)).astype(np.float64)
+                c = np.zeros((size, size), dtype=np.float64)
+                
+                # Call blocked matrix multiplication via pybind11
+                pybind11_lib.matrix_multiply_blocked(a, b, c, size, size, size)
+                
+                return float(np.sum(c))
+            
+            return pybind11_blocked_matmul
+            
+        except ImportError:
+            return lambda size: float('inf')
+    
     def _determine_fastest_method(self, crossover_points: List[CrossoverPoint]) -> str:
         """Determine the fastest method overall."""
         if not crossover_points:
@@ -8,6 +8,8 @@ Python list approach as ctypes.
 
 import os
 import sys
+from array import array
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from typing import List, Tuple, Any, Optional
 
@@ -29,6 +31,15 @@ class Pybind11Benchmark:
     def __init__(self):
         """Initialize the pybind11 library wrapper."""
         self.lib = pybind11_lib
+        # Input/output buffers keyed by size, built outside the timed calls
+        self._batch_buffers_cache = {}
+        self._parallel_inputs_cache = {}
+        self._parallel_threads = None
+        # Inputs per (kernel, size, threads) and one executor reused across calls,
+        # so the threaded benchmarks time the kernels rather than setup
+        self._threaded_inputs_cache = {}
+        self._executor = None
+        self._executor_threads = 0
         
     # =============================================================================
     # Benchmark Functions (matching ctypes exactly)
@@ -54,6 +65,28 @@ class Pybind11Benchmark:
         """64-bit integer arithmetic operations."""
         return self.lib.add_int64(a, b)
     
+    def _batch_buffers(self, typecode: str, size: int):
+        """(a, b, out) arrays for the batch benchmarks, built once per size."""
+        # array.array exposes the buffer protocol, so no numpy import needed here
+        key = (typecode, size)
+        if key not in self._batch_buffers_cache:
+            self._batch_buffers_cache[key] = (array(typecode, range(size)),
+                          array(typecode, (i * 2 for i in range(size))),
+                          array(typecode, bytes(array(typecode).itemsize * size)))
+        return self._batch_buffers_cache[key]
+    
+    def integer_operations_batch(self, size: int = 1000):
+        """Batched integer addition (one FFI crossing for `size` calls)."""
+        a, b, out = self._batch_buffers('i', size)
+        self.lib.add_int32_batch(a, b, out)
+        return out[:min(5, size)].tolist()
+    
+    def float_operations_batch(self, size: int = 1000):
+        """Batched double addition (one FFI crossing for `size` calls)."""
+        a, b, out = self._batch_buffers('d', size)
+        self.lib.add_double_batch(a, b, out)
+        return out[:min(5, size)].tolist()
+    
     def string_operations_bytes(self, data: bytes = b"hello world"):
         """String operations using bytes."""
         return self.lib.bytes_length(data, len(data))
@@ -71,6 +104,19 @@ class Pybind11Benchmark:
         result = self.lib.string_concat(a_bytes, b_bytes)
         return result
     
+    def string_operations_bytes_view(self, data: bytes = b"hello world"):
+        """String operations using bytes (zero-copy, no std::string)."""
+        return self.lib.bytes_length_view(data, len(data))
+    
+    def string_operations_str_view(self, text: str = "hello world"):
+        """UTF-8 length over borrowed bytes (zero-copy, no std::string)."""
+        data = text.encode('utf-8')
+        return self.lib.utf8_length_view(data)
+    
+    def string_concat_operations_view(self, a: str = "hello", b: str = " world"):
+        """String concatenation over borrowed inputs (zero-copy, no std::string)."""
+        return self.lib.string_concat_view(a.encode('utf-8'), b.encode('utf-8'))
+    
     def array_operations_readonly(self, size: int = 1000):
         """Read-only array operations."""
         # Create array using Python list (same as ctypes)
@@ -90,6 +136,13 @@ class Pybind11Benchmark:
         # Return first few elements for verification
         return data[:min(5, size)]
     
+    def array_operations_strided(self, size: int = 1000, step: int = 2):
+        """Strided read-only array operations (no conversion copy)."""
+        # memoryview slicing gives a non-contiguous float64 buffer
+        data = memoryview(array('d', (float(i) for i in range(size * step))))[::step]
+        
+        return self.lib.sum_doubles_strided(data)
+    
     def array_operations_int32(self, size: int = 1000):
         """Integer array operations."""
         # Create array using Python list (same as ctypes)
@@ -109,6 +162,18 @@ class Pybind11Benchmark:
         # Access struct fields (pybind11 exposes them as properties)
         return struct.x + struct.y + struct.value
     
+    def structure_operations_array(self, size: int = 100, value: float = 3.14):
+        """Structured-array operations (one call for all records)."""
+        records = self.lib.create_simple_array(size)
+        self.lib.modify_simple_array(records, value)
+        return self.lib.sum_simple_array(records)
+    
+    def structure_operations_complex(self, size: int = 100):
+        """ComplexStruct capsule with a zero-copy buffer view."""
+        s = self.lib.create_complex("bench", size)
+        self.lib.complex_buffer(s).fill(1.0)
+        return self.lib.sum_complex_buffer(s)
+    
     def callback_operations_simple(self, value: int = 42):
         """Simple callback operations."""
         def transform(x):
@@ -128,6 +193,28 @@ class Pybind11Benchmark:
         
         return self.lib.sum_with_transform(data, transform)
     
+    def callback_operations_native(self, value: int = 42):
+        """Simple callback with a native transform (no Python frame per call)."""
+        return self.lib.apply_callback(value, self.lib.c_transform)
+    
+    def callback_operations_array_native(self, size: int = 100):
+        """Array callback with a native transform over the whole array."""
+        data = list(range(size))
+        return self.lib.sum_with_transform(data, self.lib.c_transform)
+    
+    def callback_operations_iterate(self, size: int = 100):
+        """Per-element callback through iterate_with_callback."""
+        data = [float(i) for i in range(size)]
+        total = 0.0
+        
+        def process(index, value):
+            nonlocal total
+            total += value
+            return 0
+        
+        self.lib.iterate_with_callback(data, process)
+        return total
+    
     def memory_operations_alloc(self, size: int = 1024):
         """Memory allocation operations."""
         ptr = self.lib.allocate_sized(size)
@@ -136,6 +223,12 @@ class Pybind11Benchmark:
             return True
         return False
     
+    def memory_operations_pool_alloc(self, size: int = 1024):
+        """Pool allocation operations (block freed when the object is dropped)."""
+        block = self.lib.pool_allocate(size)
+        memoryview(block)[0] = 1
+        return True
+    
     def compute_operations_dot_product(self, size: int = 1000):
         """Dot product computation."""
         # Create arrays using Python lists (same as ctypes)
@@ -156,6 +249,67 @@ class Pybind11Benchmark:
         # Return checksum for verification
         return sum(c_data)
     
+    def _thread_pool(self, threads: int) -> ThreadPoolExecutor:
+        """Long-lived executor with `threads` workers, replaced only when the count changes."""
+        if self._executor is None or self._executor_threads != threads:
+            if self._executor is not None:
+                self._executor.shutdown(wait=True)
+            self._executor = ThreadPoolExecutor(max_workers=threads)
+            self._executor_threads = threads
+        return self._executor
+    
+    def compute_operations_dot_product_threaded(self, size: int = 100000, threads: int = 4,
+                                                release_gil: bool = True):
+        """Dot product from `threads` Python threads at once (GIL-released kernel)."""
+        # Buffers are built once per size (and shared, since they are only read)
+        key = ('dot', size)
+        if key not in self._threaded_inputs_cache:
+            self._threaded_inputs_cache[key] = (array('d', (float(i) for i in range(size))),
+                                                array('d', (float(i * 2) for i in range(size))))
+        a_data, b_data = self._threaded_inputs_cache[key]
+        func = self.lib.dot_product_nogil if release_gil else self.lib.dot_product
+        
+        executor = self._thread_pool(threads)
+        results = list(executor.map(lambda _: func(a_data, b_data), range(threads)))
+        return results[0]
+    
+    def compute_operations_dot_product_parallel(self, size: int = 1 << 22, threads: int = 0):
+        """Dot product split across the native reduction pool (0 = all threads)."""
+        # Building 4M-element inputs dwarfs the kernel, so they are made once per size
+        if size not in self._parallel_inputs_cache:
+            self._parallel_inputs_cache[size] = (array('d', (float(i % 1000) for i in range(size))),
+                                                 array('d', (2.0 for _ in range(size))))
+        a_data, b_data = self._parallel_inputs_cache[size]
+        
+        if threads != self._parallel_threads:
+            self.lib.set_parallel_threads(threads)
+            self._parallel_threads = threads
+        return self.lib.dot_product_parallel(a_data, b_data)
+    
+    def compute_operations_matrix_multiply_threaded(self, size: int = 128, threads: int = 4,
+                                                    release_gil: bool = True):
+        """Matrix multiply from `threads` Python threads at once (GIL-released kernel)."""
+        # Shared inputs and one output per thread, built once per (size, threads);
+        # the kernel overwrites every element of C, so outputs are reused as is
+        key = ('gemm', size, threads)
+        if key not in self._threaded_inputs_cache:
+            import numpy as np  # 2-D buffers; only needed for the threaded GEMM case
+            self._threaded_inputs_cache[key] = (
+                np.arange(size * size, dtype=np.float64).reshape(size, size),
+                np.ones((size, size), dtype=np.float64),
+                [np.zeros((size, size), dtype=np.float64) for _ in range(threads)])
+        a_data, b_data, outputs = self._threaded_inputs_cache[key]
+        func = (self.lib.matrix_multiply_naive_nogil if release_gil
+                else self.lib.matrix_multiply_naive)
+        
+        def run(c_data):
+            func(a_data, b_data, c_data, size, size, size)
+            return float(c_data.sum())
+        
+        executor = self._thread_pool(threads)
+        results = list(executor.map(run, outputs))
+        return results[0]
+    
     # =============================================================================
     # Dispatch Pattern Benchmarks
     # =============================================================================
@@ -190,10 +344,26 @@ class Pybind11Benchmark:
             return method(arg)
         return 0
     
+    # =============================================================================
+    # Native Timing Reference
+    # =============================================================================
+
+    def native_call_distribution(self, func_name: str = "noop", samples: int = 10000,
+                                 batch: int = 64) -> dict:
+        """Per-call ns distribution of a C function timed inside the extension.
+
+        Only scalar-argument functions can be timed natively; the extension's
+        native_time_functions() lists them, and any other name raises KeyError.
+
+        `samples_ns` has the same shape as the Python timer's samples, so it can
+        go straight into AdvancedStatistics.compare_methods as the no-FFI floor.
+        """
+        return self.lib.native_time(func_name, samples=samples, batch=batch)
+
     # =============================================================================
     # Utility Methods
     # =============================================================================
-    
+
     def validate_library(self) -> bool:
         """Validate that the library is working correctly."""
         try:
@@ -234,19 +404,34 @@ PYBIND11_BENCHMARKS = {
     'return_int64': lambda bench: bench.return_int64,
     'integer_ops': lambda bench: bench.integer_operations,
     'integer_ops_64': lambda bench: bench.integer_operations_64bit,
+    'integer_ops_batch': lambda bench: bench.integer_operations_batch,
+    'float_ops_batch': lambda bench: bench.float_operations_batch,
     'string_bytes': lambda bench: bench.string_operations_bytes,
     'string_str': lambda bench: bench.string_operations_str,
     'string_concat': lambda bench: bench.string_concat_operations,
+    'string_bytes_view': lambda bench: bench.string_operations_bytes_view,
+    'string_str_view': lambda bench: bench.string_operations_str_view,
+    'string_concat_view': lambda bench: bench.string_concat_operations_view,
     'array_readonly': lambda bench: bench.array_operations_readonly,
     'array_inplace': lambda bench: bench.array_operations_inplace,
+    'array_strided': lambda bench: bench.array_operations_strided,
     'array_int32': lambda bench: bench.array_operations_int32,
     'struct_simple': lambda bench: bench.structure_operations_simple,
     'struct_create': lambda bench: bench.structure_operations_create,
+    'struct_array': lambda bench: bench.structure_operations_array,
+    'struct_complex': lambda bench: bench.structure_operations_complex,
     'callback_simple': lambda bench: bench.callback_operations_simple,
     'callback_array': lambda bench: bench.callback_operations_array,
+    'callback_native': lambda bench: bench.callback_operations_native,
+    'callback_array_native': lambda bench: bench.callback_operations_array_native,
+    'callback_iterate': lambda bench: bench.callback_operations_iterate,
     'memory_alloc': lambda bench: bench.memory_operations_alloc,
+    'memory_pool_alloc': lambda bench: bench.memory_operations_pool_alloc,
     'compute_dot': lambda bench: bench.compute_operations_dot_product,
     'compute_matrix': lambda bench: bench.compute_operations_matrix_multiply,
+    'compute_dot_threaded': lambda bench: bench.compute_operations_dot_product_threaded,
+    'compute_dot_parallel': lambda bench: bench.compute_operations_dot_product_parallel,
+    'compute_matrix_threaded': lambda bench: bench.compute_operations_matrix_multiply_threaded,
 }
 
 
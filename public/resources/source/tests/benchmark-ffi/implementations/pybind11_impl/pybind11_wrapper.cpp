@@ -9,11 +9,65 @@
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
+#include <pybind11/gil_safe_call_once.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Native helpers shared with race/threadtest.cpp
+#include "native_timer.hpp"
+#include "perf_counters.hpp"
+#include "pool_allocator.hpp"
+
+// Expands X(n) for every dispatch_test_n generated in benchlib.c
+#define BENCHLIB_DISPATCH_IDS(X) \
+    X(0)    X(1)    X(2)    X(3)    X(4) \
+    X(5)    X(6)    X(7)    X(8)    X(9) \
+    X(10)   X(11)   X(12)   X(13)   X(14) \
+    X(15)   X(16)   X(17)   X(18)   X(19) \
+    X(20)   X(21)   X(22)   X(23)   X(24) \
+    X(25)   X(26)   X(27)   X(28)   X(29) \
+    X(30)   X(31)   X(32)   X(33)   X(34) \
+    X(35)   X(36)   X(37)   X(38)   X(39) \
+    X(40)   X(41)   X(42)   X(43)   X(44) \
+    X(45)   X(46)   X(47)   X(48)   X(49) \
+    X(50)   X(51)   X(52)   X(53)   X(54) \
+    X(55)   X(56)   X(57)   X(58)   X(59) \
+    X(60)   X(61)   X(62)   X(63)   X(64) \
+    X(65)   X(66)   X(67)   X(68)   X(69) \
+    X(70)   X(71)   X(72)   X(73)   X(74) \
+    X(75)   X(76)   X(77)   X(78)   X(79) \
+    X(80)   X(81)   X(82)   X(83)   X(84) \
+    X(85)   X(86)   X(87)   X(88)   X(89) \
+    X(90)   X(91)   X(92)   X(93)   X(94) \
+    X(95)   X(96)   X(97)   X(98)   X(99)
 
 // Include the original benchlib header functionality
 extern "C" {
     // Forward declarations for benchlib functions
     void noop();
+    
+    // Dispatch pattern functions
+#define DECLARE_DISPATCH_FUNC(n) int dispatch_test_##n(int a, int b);
+    BENCHLIB_DISPATCH_IDS(DECLARE_DISPATCH_FUNC)
+#undef DECLARE_DISPATCH_FUNC
+    int dispatch_c_baseline(int func_id, int a, int b);
     int return_int();
     int add_int32(int a, int b);
     long long add_int64(long long a, long long b);
@@ -28,6 +82,7 @@ extern "C" {
     // Array operations
     double sum_doubles_readonly(const double* arr, size_t n);
     void scale_doubles_inplace(double* arr, size_t n, double factor);
+    double sum_strided(const double* arr, size_t n, ptrdiff_t stride);
     int sum_int32_array(const int* arr, size_t n);
     void fill_int32_array(int* arr, size_t n, int value);
     
@@ -45,17 +100,36 @@ extern "C" {
         double value;
     } SimpleStruct;
     
+    typedef struct {
+        SimpleStruct points[4];
+        char name[32];
+        struct {
+            size_t count;
+            double* data;  // Owned pointer
+        } buffer;
+    } ComplexStruct;
+    
     SimpleStruct create_simple(int x, int y, double value);
     double sum_simple(const SimpleStruct* s);
     void modify_simple(SimpleStruct* s, double new_value);
+    ComplexStruct* create_complex(const char* name, size_t count);
+    void free_complex(ComplexStruct* s);
+    double sum_complex_buffer(const ComplexStruct* s);
     
     // Callback operations
     int apply_callback(int x, int (*transform)(int));
     int c_transform(int x);
+    int sum_with_transform(const int* arr, size_t n, int (*transform)(int));
+    int iterate_with_callback(const double* data, size_t n,
+                              int (*process)(size_t index, double value, void* context),
+                              void* context);
     
     // Matrix operations
     void matrix_multiply_naive(const double* a, const double* b, double* c,
                               size_t m, size_t n, size_t k);
+    void matrix_multiply_blocked(const double* a, const double* b, double* c,
+                                 size_t m, size_t n, size_t k);
+    const char* matrix_multiply_blocked_kernel();
     double dot_product(const double* a, const double* b, size_t n);
     void vector_add(const double* a, const double* b, double* c, size_t n);
     double vector_norm(const double* v, size_t n);
@@ -65,6 +139,28 @@ namespace py = pybind11;
 
 // Wrapper functions for better pybind11 integration
 
+// Borrow obj as a writable, C-contiguous ndim-D buffer of exactly T. Results
+// written into a converted copy would be lost, so outputs are never converted:
+// anything else throws with the given message.
+template <typename T>
+static py::buffer_info borrow_output(py::handle obj, py::ssize_t ndim, const char* error) {
+    py::buffer_info info;
+    if (PyObject_CheckBuffer(obj.ptr())) {
+        info = py::reinterpret_borrow<py::buffer>(obj).request();
+    }
+    
+    bool ok = info.ndim == ndim && !info.readonly && info.item_type_is_equivalent_to<T>();
+    py::ssize_t expected_stride = sizeof(T);
+    for (py::ssize_t d = info.ndim - 1; ok && d >= 0; d--) {
+        ok = info.strides[d] == expected_stride;
+        expected_stride *= info.shape[d];
+    }
+    if (!ok) {
+        throw std::runtime_error(error);
+    }
+    return info;
+}
+
 // Array operation wrappers
 double sum_doubles_readonly_wrapper(py::array_t<double> input) {
     py::buffer_info buf_info = input.request();
@@ -118,6 +214,18 @@ void fill_int32_array_wrapper(py::array_t<int> input, int value) {
     fill_int32_array(ptr, size, value);
 }
 
+// Hardware counter regions around the compute kernels. Ids below 8 are
+// left to ad-hoc counters_begin/counters_end pairs from Python.
+enum KernelRegion : int {
+    REGION_MATMUL_NAIVE = 8,
+    REGION_MATMUL_BLOCKED,
+    REGION_DOT_PRODUCT,
+    REGION_VECTOR_NORM,
+    REGION_PARALLEL_SUM,
+    REGION_PARALLEL_DOT,
+    REGION_PARALLEL_NORM,
+};
+
 // Matrix operation wrappers
 void matrix_multiply_naive_wrapper(py::array_t<double> a, py::array_t<double> b, py::array_t<double> c,
                                   size_t m, size_t n, size_t k) {
@@ -133,9 +241,47 @@ void matrix_multiply_naive_wrapper(py::array_t<double> a, py::array_t<double> b,
     const double* b_ptr = static_cast<const double*>(b_info.ptr);
     double* c_ptr = static_cast<double*>(c_info.ptr);
     
+    benchperf::ScopedRegion counted(REGION_MATMUL_NAIVE);
     matrix_multiply_naive(a_ptr, b_ptr, c_ptr, m, n, k);
 }
 
+// Throws unless a is m x k, b is k x n and c is m x n. Each extent is
+// compared on its own, so transposed or oversized operands are rejected; the
+// products are checked first so m, n and k that wrap size_t fail cleanly.
+static void check_matmul_shapes(const py::ssize_t* a_shape, const py::ssize_t* b_shape,
+                                const py::ssize_t* c_shape, size_t m, size_t n, size_t k) {
+    auto product_overflows = [](size_t x, size_t y) { return y != 0 && x > SIZE_MAX / y; };
+    if (product_overflows(m, k) || product_overflows(k, n) || product_overflows(m, n)) {
+        throw std::runtime_error("Matrix dimensions overflow");
+    }
+    auto dims_are = [](const py::ssize_t* shape, size_t rows, size_t cols) {
+        return static_cast<size_t>(shape[0]) == rows && static_cast<size_t>(shape[1]) == cols;
+    };
+    if (!dims_are(a_shape, m, k) || !dims_are(b_shape, k, n) || !dims_are(c_shape, m, n)) {
+        throw std::runtime_error("Matrix shapes must be a: m x k, b: k x n, c: m x n");
+    }
+}
+
+// The blocked kernel tiles n, k and m into GEMM_NC x GEMM_KC x GEMM_MC blocks
+// and runs its micro-kernel in place on the row-major operands (leading
+// dimensions k and n, no packing), so unlike the naive binding it needs real
+// C-contiguous m x k, k x n and m x n operands
+void matrix_multiply_blocked_wrapper(const py::array_t<double, py::array::c_style | py::array::forcecast>& a,
+                                     const py::array_t<double, py::array::c_style | py::array::forcecast>& b,
+                                     py::handle c,
+                                     size_t m, size_t n, size_t k) {
+    py::buffer_info c_info = borrow_output<double>(
+        c, 2, "Output must be a writable, C-contiguous 2-D float64 buffer");
+    
+    if (a.ndim() != 2 || b.ndim() != 2) {
+        throw std::runtime_error("All matrices must be 2-dimensional");
+    }
+    check_matmul_shapes(a.shape(), b.shape(), c_info.shape.data(), m, n, k);
+    
+    benchperf::ScopedRegion counted(REGION_MATMUL_BLOCKED);
+    matrix_multiply_blocked(a.data(), b.data(), static_cast<double*>(c_info.ptr), m, n, k);
+}
+
 double dot_product_wrapper(py::array_t<double> a, py::array_t<double> b) {
     py::buffer_info a_info = a.request();
     py::buffer_info b_info = b.request();
@@ -152,6 +298,7 @@ double dot_product_wrapper(py::array_t<double> a, py::array_t<double> b) {
     const double* b_ptr = static_cast<const double*>(b_info.ptr);
     size_t n = a_info.shape[0];
     
+    benchperf::ScopedRegion counted(REGION_DOT_PRODUCT);
     return dot_product(a_ptr, b_ptr, n);
 }
 
@@ -186,12 +333,978 @@ double vector_norm_wrapper(py::array_t<double> v) {
     const double* v_ptr = static_cast<const double*>(v_info.ptr);
     size_t n = v_info.shape[0];
     
+    benchperf::ScopedRegion counted(REGION_VECTOR_NORM);
     return vector_norm(v_ptr, n);
 }
 
-// Callback wrapper - allow Python functions as callbacks
-int apply_callback_wrapper(int x, std::function<int(int)> transform) {
-    return transform(x);
+// No-copy array wrappers - explicit opt-out of pybind11's implicit conversion
+// The default py::array_t<double> arguments above silently build a converted
+// copy for lists and other dtypes, and accept strided views while ignoring
+// buf_info.strides. These variants borrow float64 buffers as-is, send strided
+// views to sum_strided, and only copy (explicitly, and counted) when a
+// contiguous kernel has no other way to run.
+using c_double_array = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+static std::atomic<size_t> conversion_copy_count{0};
+
+// Borrow obj as a 1-D float64 buffer with its real strides (no conversion)
+static bool borrow_doubles_1d(py::handle obj, py::buffer_info& info) {
+    if (!PyObject_CheckBuffer(obj.ptr())) {
+        return false;
+    }
+    info = py::reinterpret_borrow<py::buffer>(obj).request();
+    return info.ndim == 1 && info.itemsize == sizeof(double) &&
+           info.format == py::format_descriptor<double>::format();
+}
+
+// C-contiguous float64 view of obj; copies only if the buffer can't be used
+static c_double_array contiguous_doubles(py::handle obj) {
+    py::buffer_info info;
+    bool borrowed = c_double_array::check_(obj) ||
+                    (borrow_doubles_1d(obj, info) && info.strides[0] == sizeof(double));
+    if (!borrowed) {
+        conversion_copy_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    c_double_array arr = c_double_array::ensure(obj);
+    if (!arr) {
+        throw py::error_already_set();
+    }
+    if (arr.ndim() != 1) {
+        throw std::runtime_error("Input array must be 1-dimensional");
+    }
+    return arr;
+}
+
+double sum_doubles_strided_wrapper(py::handle input) {
+    py::buffer_info buf_info;
+    if (borrow_doubles_1d(input, buf_info)) {
+        const double* ptr = static_cast<const double*>(buf_info.ptr);
+        size_t size = buf_info.shape[0];
+        ptrdiff_t stride = buf_info.strides[0];
+        
+        if (stride == sizeof(double)) {
+            return sum_doubles_readonly(ptr, size);
+        }
+        return sum_strided(ptr, size, stride);
+    }
+    
+    c_double_array arr = contiguous_doubles(input);
+    return sum_doubles_readonly(arr.data(), arr.size());
+}
+
+void scale_doubles_inplace_nocopy_wrapper(py::handle input, double factor) {
+    // In-place results would be lost on a converted copy, so refuse instead
+    py::buffer_info buf_info;
+    if (!borrow_doubles_1d(input, buf_info) || buf_info.readonly ||
+        buf_info.strides[0] != sizeof(double)) {
+        throw std::runtime_error("Input must be a writable, contiguous 1-D float64 buffer");
+    }
+    
+    double* ptr = static_cast<double*>(buf_info.ptr);
+    size_t size = buf_info.shape[0];
+    
+    scale_doubles_inplace(ptr, size, factor);
+}
+
+double dot_product_nocopy_wrapper(py::handle a, py::handle b) {
+    c_double_array a_arr = contiguous_doubles(a);
+    c_double_array b_arr = contiguous_doubles(b);
+    
+    if (a_arr.size() != b_arr.size()) {
+        throw std::runtime_error("Arrays must have the same length");
+    }
+    
+    return dot_product(a_arr.data(), b_arr.data(), a_arr.size());
+}
+
+void vector_add_nocopy_wrapper(py::handle a, py::handle b, py::handle c) {
+    c_double_array a_arr = contiguous_doubles(a);
+    c_double_array b_arr = contiguous_doubles(b);
+    
+    py::buffer_info c_info;
+    if (!borrow_doubles_1d(c, c_info) || c_info.readonly ||
+        c_info.strides[0] != sizeof(double)) {
+        throw std::runtime_error("Output must be a writable, contiguous 1-D float64 buffer");
+    }
+    
+    auto n = a_arr.size();
+    if (b_arr.size() != n || c_info.shape[0] != n) {
+        throw std::runtime_error("All arrays must have the same length");
+    }
+    
+    vector_add(a_arr.data(), b_arr.data(), static_cast<double*>(c_info.ptr),
+               static_cast<size_t>(n));
+}
+
+double vector_norm_nocopy_wrapper(py::handle v) {
+    c_double_array v_arr = contiguous_doubles(v);
+    return vector_norm(v_arr.data(), v_arr.size());
+}
+
+size_t get_conversion_copy_count() {
+    return conversion_copy_count.load(std::memory_order_relaxed);
+}
+
+void reset_conversion_copy_count() {
+    conversion_copy_count.store(0, std::memory_order_relaxed);
+}
+
+// GIL-releasing kernel wrappers - bound with py::call_guard<py::gil_scoped_release>
+// Read-only arguments are converted (c_style, so no stride surprises) while the
+// GIL is still held; the bodies then only read array headers and run the C
+// kernel. Taking the arrays by reference keeps refcount traffic out of the
+// released region. Outputs are borrowed with borrow_output (never converted, so
+// a mismatch throws) and those wrappers release the GIL themselves once the
+// buffer is checked; the buffer_info is destroyed with the GIL re-acquired.
+void matrix_multiply_naive_nogil_wrapper(const c_double_array& a, const c_double_array& b,
+                                         py::handle c,
+                                         size_t m, size_t n, size_t k) {
+    py::buffer_info c_info = borrow_output<double>(
+        c, 2, "Output must be a writable, C-contiguous 2-D float64 buffer");
+    
+    if (a.ndim() != 2 || b.ndim() != 2) {
+        throw std::runtime_error("All matrices must be 2-dimensional");
+    }
+    check_matmul_shapes(a.shape(), b.shape(), c_info.shape.data(), m, n, k);
+    
+    py::gil_scoped_release release;
+    matrix_multiply_naive(a.data(), b.data(), static_cast<double*>(c_info.ptr), m, n, k);
+}
+
+double dot_product_nogil_wrapper(const c_double_array& a, const c_double_array& b) {
+    if (a.ndim() != 1 || b.ndim() != 1) {
+        throw std::runtime_error("Input arrays must be 1-dimensional");
+    }
+    
+    if (a.size() != b.size()) {
+        throw std::runtime_error("Arrays must have the same length");
+    }
+    
+    return dot_product(a.data(), b.data(), a.size());
+}
+
+double vector_norm_nogil_wrapper(const c_double_array& v) {
+    if (v.ndim() != 1) {
+        throw std::runtime_error("Input array must be 1-dimensional");
+    }
+    
+    return vector_norm(v.data(), v.size());
+}
+
+void scale_doubles_inplace_nogil_wrapper(py::handle input, double factor) {
+    py::buffer_info buf_info = borrow_output<double>(
+        input, 1, "Input must be a writable, contiguous 1-D float64 buffer");
+    
+    py::gil_scoped_release release;
+    scale_doubles_inplace(static_cast<double*>(buf_info.ptr),
+                          static_cast<size_t>(buf_info.shape[0]), factor);
+}
+
+// Parallel reduction wrappers - persistent worker pool, deterministic combine
+// Inputs above parallel_threshold elements are cut into fixed-size chunks; each
+// chunk's partial comes from the C kernel and partials are combined with a
+// pairwise tree in chunk order. Chunking does not depend on the thread count,
+// so results are bit-identical for 1..N threads (they may differ from the
+// serial C loop in the last ulp). Bound with the GIL released.
+class ReductionPool {
+public:
+    explicit ReductionPool(size_t n_workers) {
+        for (size_t id = 0; id < n_workers; id++) {
+            workers_.emplace_back([this, id] { worker_loop(id); });
+        }
+    }
+    
+    size_t size() const { return workers_.size(); }
+    
+    // Runs task(0..n_chunks-1) on the caller plus up to `helpers` workers.
+    // Returns false (without running anything) if another caller owns the pool.
+    bool try_run(size_t n_chunks, size_t helpers, const std::function<void(size_t)>& task) {
+        std::unique_lock submit(submit_mutex_, std::try_to_lock);
+        if (!submit.owns_lock()) {
+            return false;
+        }
+        
+        {
+            std::lock_guard lock(mutex_);
+            task_ = &task;
+            n_chunks_ = n_chunks;
+            next_chunk_.store(0, std::memory_order_relaxed);
+            participants_ = std::min(helpers, workers_.size());
+            active_ = participants_;
+            generation_++;
+        }
+        work_cv_.notify_all();
+        
+        drain(task, n_chunks);
+        
+        std::unique_lock lock(mutex_);
+        done_cv_.wait(lock, [this] { return active_ == 0; });
+        task_ = nullptr;
+        return true;
+    }
+
+private:
+    void drain(const std::function<void(size_t)>& task, size_t n_chunks) {
+        for (size_t chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed); chunk < n_chunks;
+             chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed)) {
+            task(chunk);
+        }
+    }
+    
+    void worker_loop(size_t id) {
+        uint64_t seen = 0;
+        std::unique_lock lock(mutex_);
+        for (;;) {
+            work_cv_.wait(lock, [&] { return generation_ != seen; });
+            seen = generation_;
+            if (id >= participants_) {
+                continue;  // Not needed for this job
+            }
+            
+            const std::function<void(size_t)>* task = task_;
+            size_t n_chunks = n_chunks_;
+            lock.unlock();
+            drain(*task, n_chunks);
+            lock.lock();
+            
+            if (--active_ == 0) {
+                done_cv_.notify_one();
+            }
+        }
+    }
+    
+    std::vector<std::thread> workers_;
+    std::mutex submit_mutex_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t n_chunks_ = 0;
+    std::atomic<size_t> next_chunk_{0};
+    size_t participants_ = 0;
+    size_t active_ = 0;
+    uint64_t generation_ = 0;
+};
+
+static constexpr size_t reduction_chunk = 16384;  // doubles per partial (128 KiB)
+static std::atomic<size_t> parallel_threshold{1 << 18};
+static std::atomic<size_t> parallel_threads{0};  // 0 = every pool worker + caller
+
+// Created on first use and intentionally leaked: workers never touch Python,
+// and joining them during interpreter finalisation buys nothing.
+static ReductionPool& reduction_pool() {
+    static ReductionPool* pool = new ReductionPool(
+        std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return *pool;
+}
+
+static double pairwise_combine(std::vector<double>& partials) {
+    size_t count = partials.size();
+    for (size_t width = 1; width < count; width *= 2) {
+        for (size_t i = 0; i + width < count; i += 2 * width) {
+            partials[i] += partials[i + width];
+        }
+    }
+    return count ? partials[0] : 0.0;
+}
+
+// partial(offset, len) reduces one chunk; returns the tree-combined total
+template <typename Partial>
+static double parallel_reduce(size_t n, Partial partial) {
+    size_t n_chunks = (n + reduction_chunk - 1) / reduction_chunk;
+    std::vector<double> partials(n_chunks);
+    std::function<void(size_t)> task = [&](size_t chunk) {
+        size_t offset = chunk * reduction_chunk;
+        partials[chunk] = partial(offset, std::min(reduction_chunk, n - offset));
+    };
+    
+    ReductionPool& pool = reduction_pool();
+    size_t threads = parallel_threads.load(std::memory_order_relaxed);
+    size_t helpers = threads ? threads - 1 : pool.size();
+    
+    // Pool busy with another caller: same chunks, same tree, on this thread
+    if (helpers == 0 || !pool.try_run(n_chunks, helpers, task)) {
+        for (size_t chunk = 0; chunk < n_chunks; chunk++) {
+            task(chunk);
+        }
+    }
+    return pairwise_combine(partials);
+}
+
+static bool use_parallel(size_t n) {
+    return n >= parallel_threshold.load(std::memory_order_relaxed);
+}
+
+double sum_doubles_readonly_parallel_wrapper(const c_double_array& input) {
+    if (input.ndim() != 1) {
+        throw std::runtime_error("Input array must be 1-dimensional");
+    }
+    
+    const double* ptr = input.data();
+    size_t n = input.size();
+    if (!use_parallel(n)) {
+        benchperf::ScopedRegion counted(REGION_PARALLEL_SUM);
+        return sum_doubles_readonly(ptr, n);
+    }
+    // Regions open inside the chunk so every pool thread's share is counted
+    return parallel_reduce(n, [ptr](size_t offset, size_t len) {
+        benchperf::ScopedRegion counted(REGION_PARALLEL_SUM);
+        return sum_doubles_readonly(ptr + offset, len);
+    });
+}
+
+double dot_product_parallel_wrapper(const c_double_array& a, const c_double_array& b) {
+    if (a.ndim() != 1 || b.ndim() != 1) {
+        throw std::runtime_error("Input arrays must be 1-dimensional");
+    }
+    
+    if (a.size() != b.size()) {
+        throw std::runtime_error("Arrays must have the same length");
+    }
+    
+    const double* a_ptr = a.data();
+    const double* b_ptr = b.data();
+    size_t n = a.size();
+    if (!use_parallel(n)) {
+        benchperf::ScopedRegion counted(REGION_PARALLEL_DOT);
+        return dot_product(a_ptr, b_ptr, n);
+    }
+    return parallel_reduce(n, [a_ptr, b_ptr](size_t offset, size_t len) {
+        benchperf::ScopedRegion counted(REGION_PARALLEL_DOT);
+        return dot_product(a_ptr + offset, b_ptr + offset, len);
+    });
+}
+
+double vector_norm_parallel_wrapper(const c_double_array& v) {
+    if (v.ndim() != 1) {
+        throw std::runtime_error("Input array must be 1-dimensional");
+    }
+    
+    const double* ptr = v.data();
+    size_t n = v.size();
+    if (!use_parallel(n)) {
+        benchperf::ScopedRegion counted(REGION_PARALLEL_NORM);
+        return vector_norm(ptr, n);
+    }
+    // Sum of squares per chunk via dot_product(v, v), sqrt once at the end
+    return std::sqrt(parallel_reduce(n, [ptr](size_t offset, size_t len) {
+        benchperf::ScopedRegion counted(REGION_PARALLEL_NORM);
+        return dot_product(ptr + offset, ptr + offset, len);
+    }));
+}
+
+void set_parallel_threshold(size_t n) {
+    parallel_threshold.store(n, std::memory_order_relaxed);
+}
+
+size_t get_parallel_threshold() {
+    return parallel_threshold.load(std::memory_order_relaxed);
+}
+
+// Total threads per reduction including the caller (0 = whole pool)
+void set_parallel_threads(size_t n) {
+    parallel_threads.store(n, std::memory_order_relaxed);
+}
+
+size_t get_parallel_pool_size() {
+    return reduction_pool().size() + 1;
+}
+
+// Batch wrappers - one boundary crossing for N scalar calls
+// Loops over the C function in native code so the harness can compare
+// amortized FFI cost against the per-call bindings above.
+template <typename T, typename R, R (*Func)(T, T)>
+void binary_batch_wrapper(const py::array_t<T, py::array::c_style | py::array::forcecast>& a,
+                          const py::array_t<T, py::array::c_style | py::array::forcecast>& b,
+                          py::handle out) {
+    py::buffer_info out_info = borrow_output<R>(
+        out, 1, "Output must be a writable, contiguous 1-D buffer of the result type");
+    
+    if (a.ndim() != 1 || b.ndim() != 1) {
+        throw std::runtime_error("All arrays must be 1-dimensional");
+    }
+    
+    auto n = a.shape(0);
+    if (b.shape(0) != n || out_info.shape[0] != n) {
+        throw std::runtime_error("All arrays must have the same length");
+    }
+    
+    const T* a_ptr = a.data();
+    const T* b_ptr = b.data();
+    R* out_ptr = static_cast<R*>(out_info.ptr);
+    
+    for (py::ssize_t i = 0; i < n; i++) {
+        out_ptr[i] = Func(a_ptr[i], b_ptr[i]);
+    }
+}
+
+// Pool allocator front end
+//
+// PoolBlock owns one benchpool block and exports it through the buffer
+// protocol (unsigned bytes), so memoryview(block) / np.frombuffer(block) are
+// zero-copy. Any memoryview keeps the block alive; the block returns to the
+// freeing thread's cache when the last reference goes away.
+class PoolBlock {
+public:
+    explicit PoolBlock(size_t size) : ptr_(benchpool::allocate(size)), size_(size) {
+        if (size == 0 || size > benchpool::MAX_BLOCK_SIZE) {
+            throw py::value_error("pool block size must be in [1, " +
+                                  std::to_string(benchpool::MAX_BLOCK_SIZE) + "]");
+        }
+        if (ptr_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    
+    ~PoolBlock() { benchpool::deallocate(ptr_); }
+    
+    PoolBlock(const PoolBlock&) = delete;
+    PoolBlock& operator=(const PoolBlock&) = delete;
+    
+    size_t size() const { return size_; }
+    size_t capacity() const { return benchpool::block_size(ptr_); }
+    
+    py::buffer_info buffer() {
+        return py::buffer_info(ptr_, 1, py::format_descriptor<unsigned char>::format(),
+                               static_cast<py::ssize_t>(size_));
+    }
+    
+private:
+    void* ptr_;
+    size_t size_;
+};
+
+std::unique_ptr<PoolBlock> pool_allocate_wrapper(size_t size) {
+    return std::make_unique<PoolBlock>(size);
+}
+
+py::dict pool_stats_wrapper() {
+    benchpool::Stats stats = benchpool::stats();
+    py::dict out;
+    out["slab_bytes"] = stats.slab_bytes;
+    out["slabs"] = stats.slabs;
+    out["shared_free_blocks"] = stats.shared_free_blocks;
+    out["max_block_size"] = benchpool::MAX_BLOCK_SIZE;
+    return out;
+}
+
+// Hardware counter wrappers
+py::dict counters_read_wrapper(int region) {
+    if (!benchperf::valid_region(region)) {
+        throw py::index_error("Counter region out of range");
+    }
+    benchperf::RegionStats stats = benchperf::read(region);
+    py::dict out;
+    out["calls"] = stats.calls;
+    out["cycles"] = stats.values[benchperf::CYCLES];
+    out["instructions"] = stats.values[benchperf::INSTRUCTIONS];
+    out["llc_misses"] = stats.values[benchperf::LLC_MISSES];
+    out["branch_misses"] = stats.values[benchperf::BRANCH_MISSES];
+    out["time_enabled_ns"] = stats.time_enabled_ns;
+    out["time_running_ns"] = stats.time_running_ns;
+    out["threads"] = stats.threads;
+    
+    double cycles = static_cast<double>(stats.values[benchperf::CYCLES]);
+    double kinstr = static_cast<double>(stats.values[benchperf::INSTRUCTIONS]) / 1000.0;
+    out["ipc"] = cycles > 0.0 ? kinstr * 1000.0 / cycles : 0.0;
+    out["llc_misses_per_kinstr"] = kinstr > 0.0
+        ? static_cast<double>(stats.values[benchperf::LLC_MISSES]) / kinstr : 0.0;
+    out["branch_misses_per_kinstr"] = kinstr > 0.0
+        ? static_cast<double>(stats.values[benchperf::BRANCH_MISSES]) / kinstr : 0.0;
+    return out;
+}
+
+void counters_begin_wrapper(int region) {
+    if (!benchperf::valid_region(region)) {
+        throw py::index_error("Counter region out of range");
+    }
+    benchperf::begin(region);
+}
+
+void counters_end_wrapper(int region) {
+    if (!benchperf::valid_region(region)) {
+        throw py::index_error("Counter region out of range");
+    }
+    benchperf::end(region);
+}
+
+// Structure array wrappers
+//
+// SimpleStruct arrays are NumPy structured arrays with the C layout
+// (PYBIND11_NUMPY_DTYPE in the module init), processed in place so no
+// per-record Python wrapper is ever allocated.
+static py::buffer_info simple_struct_buffer(const py::array& arr, bool writable) {
+    if (!py::isinstance<py::array_t<SimpleStruct>>(arr)) {
+        throw std::runtime_error("Input must be a SimpleStruct structured array");
+    }
+    py::buffer_info info = arr.request(writable);
+    if (info.ndim != 1) {
+        throw std::runtime_error("Input array must be 1-dimensional");
+    }
+    return info;
+}
+
+py::array_t<SimpleStruct> create_simple_array(size_t n) {
+    py::array_t<SimpleStruct> arr(static_cast<py::ssize_t>(n));
+    std::memset(arr.mutable_data(), 0, n * sizeof(SimpleStruct));
+    return arr;
+}
+
+double sum_simple_array_wrapper(const py::array& arr) {
+    py::buffer_info info = simple_struct_buffer(arr, false);
+    const char* base = static_cast<const char*>(info.ptr);
+    py::ssize_t stride = info.strides[0];
+    
+    py::gil_scoped_release release;
+    double sum = 0.0;
+    for (py::ssize_t i = 0; i < info.shape[0]; i++) {
+        sum += sum_simple(reinterpret_cast<const SimpleStruct*>(base + i * stride));
+    }
+    return sum;
+}
+
+void modify_simple_array_wrapper(const py::array& arr, double new_value) {
+    py::buffer_info info = simple_struct_buffer(arr, true);
+    char* base = static_cast<char*>(info.ptr);
+    py::ssize_t stride = info.strides[0];
+    
+    py::gil_scoped_release release;
+    for (py::ssize_t i = 0; i < info.shape[0]; i++) {
+        modify_simple(reinterpret_cast<SimpleStruct*>(base + i * stride), new_value);
+    }
+}
+
+// ComplexStruct lives in a named capsule that calls free_complex when the
+// last reference (including any array views below) goes away
+static constexpr const char* complex_capsule_name = "benchlib.ComplexStruct";
+
+static void complex_capsule_destructor(PyObject* capsule) {
+    free_complex(static_cast<ComplexStruct*>(PyCapsule_GetPointer(capsule, complex_capsule_name)));
+}
+
+static ComplexStruct* complex_from_capsule(const py::capsule& capsule) {
+    auto* s = static_cast<ComplexStruct*>(PyCapsule_GetPointer(capsule.ptr(), complex_capsule_name));
+    if (!s) {
+        throw py::error_already_set();
+    }
+    return s;
+}
+
+py::capsule create_complex_wrapper(const std::string& name, size_t count) {
+    ComplexStruct* s = create_complex(name.c_str(), count);
+    if (!s) {
+        throw std::bad_alloc();
+    }
+    PyObject* capsule = PyCapsule_New(s, complex_capsule_name, complex_capsule_destructor);
+    if (!capsule) {
+        free_complex(s);
+        throw py::error_already_set();
+    }
+    return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+double sum_complex_buffer_wrapper(const py::capsule& capsule) {
+    return sum_complex_buffer(complex_from_capsule(capsule));
+}
+
+std::string complex_name_wrapper(const py::capsule& capsule) {
+    return complex_from_capsule(capsule)->name;
+}
+
+// Writable zero-copy views; the capsule is the array base, keeping it alive
+py::array_t<double> complex_buffer_view(const py::capsule& capsule) {
+    ComplexStruct* s = complex_from_capsule(capsule);
+    if (s->buffer.count == 0) {
+        return py::array_t<double>(0);
+    }
+    auto count = static_cast<py::ssize_t>(s->buffer.count);
+    return py::array_t<double>({count}, {static_cast<py::ssize_t>(sizeof(double))},
+                               s->buffer.data, capsule);
+}
+
+py::array_t<SimpleStruct> complex_points_view(const py::capsule& capsule) {
+    ComplexStruct* s = complex_from_capsule(capsule);
+    constexpr auto n_points = static_cast<py::ssize_t>(sizeof(s->points) / sizeof(s->points[0]));
+    return py::array_t<SimpleStruct>({n_points}, {static_cast<py::ssize_t>(sizeof(SimpleStruct))},
+                                     s->points, capsule);
+}
+
+// Dispatch table - the benchlib dispatch_test_N functions by id, built at
+// compile time so both the per-function bindings and dispatch_batch index it
+using dispatch_func_t = int (*)(int, int);
+
+#define DISPATCH_TABLE_ENTRY(n) dispatch_test_##n,
+#define DISPATCH_NAME_ENTRY(n) "dispatch_test_" #n,
+constexpr dispatch_func_t dispatch_table[] = { BENCHLIB_DISPATCH_IDS(DISPATCH_TABLE_ENTRY) };
+constexpr const char* dispatch_names[] = { BENCHLIB_DISPATCH_IDS(DISPATCH_NAME_ENTRY) };
+#undef DISPATCH_TABLE_ENTRY
+#undef DISPATCH_NAME_ENTRY
+
+constexpr size_t dispatch_count = sizeof(dispatch_table) / sizeof(dispatch_table[0]);
+static_assert(sizeof(dispatch_names) / sizeof(dispatch_names[0]) == dispatch_count);
+
+template <size_t... I>
+void bind_dispatch_functions(py::module_& m, std::index_sequence<I...>) {
+    (m.def(dispatch_names[I], dispatch_table[I], "Dispatch pattern test function",
+           py::arg("a"), py::arg("b")), ...);
+}
+
+// One boundary crossing for a whole stream of (func_id, a, b) calls
+void dispatch_batch_wrapper(const py::array_t<int, py::array::c_style | py::array::forcecast>& func_ids,
+                            const py::array_t<int, py::array::c_style | py::array::forcecast>& a,
+                            const py::array_t<int, py::array::c_style | py::array::forcecast>& b,
+                            py::handle out) {
+    py::buffer_info ids_info = func_ids.request();
+    py::buffer_info a_info = a.request();
+    py::buffer_info b_info = b.request();
+    py::buffer_info out_info = borrow_output<int>(
+        out, 1, "Output must be a writable, contiguous 1-D int32 buffer");
+    
+    if (ids_info.ndim != 1 || a_info.ndim != 1 || b_info.ndim != 1) {
+        throw std::runtime_error("All arrays must be 1-dimensional");
+    }
+    
+    auto n = ids_info.shape[0];
+    if (a_info.shape[0] != n || b_info.shape[0] != n || out_info.shape[0] != n) {
+        throw std::runtime_error("All arrays must have the same length");
+    }
+    
+    const int* ids_ptr = static_cast<const int*>(ids_info.ptr);
+    const int* a_ptr = static_cast<const int*>(a_info.ptr);
+    const int* b_ptr = static_cast<const int*>(b_info.ptr);
+    int* out_ptr = static_cast<int*>(out_info.ptr);
+    
+    // Every id is checked before anything is written, so an IndexError
+    // leaves out exactly as the caller passed it
+    py::ssize_t invalid = 0;
+    {
+        py::gil_scoped_release release;
+        for (py::ssize_t i = 0; i < n; i++) {
+            invalid += static_cast<size_t>(ids_ptr[i]) >= dispatch_count;
+        }
+        if (invalid == 0) {
+            for (py::ssize_t i = 0; i < n; i++) {
+                out_ptr[i] = dispatch_table[static_cast<size_t>(ids_ptr[i])](a_ptr[i], b_ptr[i]);
+            }
+        }
+    }
+    
+    if (invalid > 0) {
+        throw py::index_error("dispatch_batch: " + std::to_string(invalid) + " function id(s) out of range");
+    }
+}
+
+// Native timing harness
+//
+// Each entry times one benchlib call in a tight native loop (see
+// native_timer.hpp), so the result is the C call itself with no FFI on the
+// path - the floor each binding's Python-side number should be compared to.
+// Entries are (function, arguments...); the arguments live in the loop's
+// closure and go through call_opaque on every call, so the compiler sees
+// neither constant inputs nor a loop-invariant result. The table covers every
+// bound function whose arguments and result are all scalars (the dispatch
+// tests come from BENCHLIB_DISPATCH_IDS); array, string, struct and callback
+// functions need inputs a fixed entry can't supply and stay Python-timed.
+#define BENCHLIB_TIMED_FUNCTIONS(X) \
+    X(noop) \
+    X(return_int) \
+    X(add_int32, 10, 20) \
+    X(add_int64, 1000000000000LL, 2000000000000LL) \
+    X(add_uint64, 1000000000000ULL, 2000000000000ULL) \
+    X(logical_and, true, false) \
+    X(logical_or, true, false) \
+    X(logical_not, true) \
+    X(add_float, 1.5f, 2.5f) \
+    X(add_double, 1.5, 2.5) \
+    X(multiply_double, 1.5, 2.5) \
+    X(c_transform, 21) \
+    X(dispatch_c_baseline, 42, 1, 2)
+
+using timed_run_fn = benchtime::Measurement (*)(size_t samples, size_t batch, size_t bins);
+
+struct TimedFunction {
+    const char* name;
+    timed_run_fn run;
+};
+
+#define DEFINE_TIMED_FUNCTION(name, ...) \
+    {#name, [](size_t samples, size_t batch, size_t bins) { \
+        return benchtime::measure([inputs = std::make_tuple(__VA_ARGS__)]() mutable { \
+            std::apply([](auto&... args) { benchtime::call_opaque(name, args...); }, inputs); \
+        }, samples, batch, bins); \
+    }},
+#define DEFINE_TIMED_DISPATCH(n) DEFINE_TIMED_FUNCTION(dispatch_test_##n, 1, 2)
+static const TimedFunction timed_functions[] = {
+    BENCHLIB_TIMED_FUNCTIONS(DEFINE_TIMED_FUNCTION)
+    BENCHLIB_DISPATCH_IDS(DEFINE_TIMED_DISPATCH)
+};
+#undef DEFINE_TIMED_DISPATCH
+#undef DEFINE_TIMED_FUNCTION
+
+py::list native_time_functions() {
+    py::list names;
+    for (const TimedFunction& entry : timed_functions) {
+        names.append(entry.name);
+    }
+    return names;
+}
+
+py::dict native_time_wrapper(const std::string& name, size_t samples, size_t batch, size_t bins) {
+    const TimedFunction* entry = nullptr;
+    for (const TimedFunction& candidate : timed_functions) {
+        if (name == candidate.name) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (entry == nullptr) {
+        throw py::key_error("native_time: '" + name + "' is not a scalar benchlib function "
+                            "(see native_time_functions())");
+    }
+    if (samples == 0 || batch == 0 || bins == 0) {
+        throw py::value_error("native_time: samples, batch and bins must be positive");
+    }
+    
+    benchtime::Measurement result;
+    {
+        py::gil_scoped_release release;
+        result = entry->run(samples, batch, bins);
+    }
+    
+    py::dict hist;
+    hist["lo_ns"] = result.histogram.lo_ns;
+    hist["bin_width_ns"] = result.histogram.bin_width_ns;
+    hist["counts"] = result.histogram.counts;
+    
+    py::dict out;
+    out["function"] = name;
+    out["clock"] = benchtime::clock_name();
+    out["ns_per_tick"] = benchtime::ns_per_tick();
+    out["batch"] = batch;
+    out["overhead_ns"] = result.overhead_ns;
+    out["min_ns"] = result.min_ns;
+    out["p50_ns"] = result.p50_ns;
+    out["p90_ns"] = result.p90_ns;
+    out["p99_ns"] = result.p99_ns;
+    out["max_ns"] = result.max_ns;
+    out["mean_ns"] = result.mean_ns;
+    out["samples_ns"] = result.per_call_ns;
+    out["histogram"] = hist;
+    return out;
+}
+
+// Callback wrappers
+//
+// Native callables (a stateless pybind11-bound function such as c_transform,
+// or a ctypes/cffi function pointer) are unwrapped to their raw C pointer and
+// handed straight to benchlib, so no Python frame runs per call. Anything else
+// is called through the py::function handle taken once per wrapper call,
+// skipping the std::function type erasure the old binding paid.
+using int_transform_fn = int (*)(int);
+using process_fn = int (*)(size_t, double, void*);
+
+// True if some class in obj's MRO has the given tp_name
+static bool type_in_mro(py::handle obj, const char* tp_name) {
+    PyObject* mro = Py_TYPE(obj.ptr())->tp_mro;
+    for (Py_ssize_t i = 0; mro && i < PyTuple_GET_SIZE(mro); i++) {
+        auto* type = reinterpret_cast<PyTypeObject*>(PyTuple_GET_ITEM(mro, i));
+        if (std::strcmp(type->tp_name, tp_name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Python objects a signature is checked against, resolved on first use and
+// kept for the life of the process (the stores never destroy them). ctypes
+// and cffi are resolved separately so cffi is only imported for cffi callbacks.
+struct CtypesSignatureTypes {
+    py::object restype;
+    py::tuple argtypes;
+};
+
+struct CffiSignatureTypes {
+    py::object typeof_fn;  // _cffi_backend.typeof
+    py::object expected;
+    py::object cast;
+    py::object intptr_type;
+};
+
+struct ForeignTypeCache {
+    py::gil_safe_call_once_and_store<CtypesSignatureTypes> ctypes;
+    py::gil_safe_call_once_and_store<CffiSignatureTypes> cffi;
+};
+
+// C signature a ctypes/cffi function pointer must declare before its address
+// is called natively; calling through a mismatched prototype is undefined, so
+// a declared mismatch is a TypeError rather than a fallback
+struct ForeignSignature {
+    const char* ctypes_restype;
+    std::vector<const char*> ctypes_argtypes;
+    const char* cffi_type;
+    ForeignTypeCache* cache;
+};
+
+PYBIND11_CONSTINIT static ForeignTypeCache int_transform_types;
+PYBIND11_CONSTINIT static ForeignTypeCache process_types;
+static const ForeignSignature int_transform_signature{
+    "c_int", {"c_int"}, "int(*)(int)", &int_transform_types};
+static const ForeignSignature process_signature{
+    "c_int", {"c_size_t", "c_double", "c_void_p"}, "int(*)(size_t, double, void *)", &process_types};
+
+static const CtypesSignatureTypes& ctypes_signature_types(const ForeignSignature& sig) {
+    return sig.cache->ctypes
+        .call_once_and_store_result([&sig] {
+            py::module_ ctypes = py::module_::import("ctypes");
+            py::tuple argtypes(sig.ctypes_argtypes.size());
+            for (size_t i = 0; i < sig.ctypes_argtypes.size(); i++) {
+                argtypes[i] = ctypes.attr(sig.ctypes_argtypes[i]);
+            }
+            return CtypesSignatureTypes{ctypes.attr(sig.ctypes_restype), argtypes};
+        })
+        .get_stored();
+}
+
+static const CffiSignatureTypes& cffi_signature_types(const ForeignSignature& sig) {
+    return sig.cache->cffi
+        .call_once_and_store_result([&sig] {
+            py::object backend = py::module_::import("_cffi_backend");
+            // CTypes are interned by the backend, so any FFI instance's type compares equal
+            return CffiSignatureTypes{backend.attr("typeof"),
+                                      backend.attr("FFI")().attr("typeof")(sig.cffi_type),
+                                      backend.attr("cast"),
+                                      backend.attr("new_primitive_type")("intptr_t")};
+        })
+        .get_stored();
+}
+
+// Address held by a ctypes or cffi function pointer object of signature sig,
+// nullptr for any other object, and for a ctypes pointer with no argtypes
+// (it still works through the Python call)
+static void* foreign_function_address(py::handle fn, const ForeignSignature& sig) {
+    if (type_in_mro(fn, "_ctypes.CFuncPtr")) {
+        // argtypes reads back as whatever sequence was assigned (None if unset)
+        py::object declared = fn.attr("argtypes");
+        if (declared.is_none()) {
+            return nullptr;
+        }
+        const CtypesSignatureTypes& types = ctypes_signature_types(sig);
+        if (!fn.attr("restype").is(types.restype) || !py::tuple(declared).equal(types.argtypes)) {
+            throw py::type_error(std::string("ctypes function pointer must be declared as ") +
+                                 sig.cffi_type + " (restype " + sig.ctypes_restype +
+                                 ", argtypes " + py::str(types.argtypes).cast<std::string>() + ")");
+        }
+        
+        // A ctypes function object's buffer is the pointer-sized slot holding its address
+        Py_buffer view;
+        if (PyObject_GetBuffer(fn.ptr(), &view, PyBUF_SIMPLE) != 0) {
+            throw py::error_already_set();
+        }
+        void* address = nullptr;
+        if (view.len == static_cast<Py_ssize_t>(sizeof(address))) {
+            std::memcpy(&address, view.buf, sizeof(address));
+        }
+        PyBuffer_Release(&view);
+        return address;
+    }
+    if (type_in_mro(fn, "_cffi_backend._CDataBase")) {
+        const CffiSignatureTypes& types = cffi_signature_types(sig);
+        if (!types.typeof_fn(fn).equal(types.expected)) {
+            throw py::type_error(std::string("cffi function pointer must have type ") + sig.cffi_type);
+        }
+        return reinterpret_cast<void*>(types.cast(types.intptr_type, fn).cast<std::intptr_t>());
+    }
+    return nullptr;
+}
+
+static int_transform_fn native_int_transform(const py::function& fn) {
+    if (fn.cpp_function()) {
+        // pybind11's std::function caster unwraps stateless bound functions
+        // of the exact signature to the underlying function pointer
+        auto wrapped = fn.cast<std::function<int(int)>>();
+        if (auto* target = wrapped.target<int_transform_fn>()) {
+            return *target;
+        }
+        return nullptr;
+    }
+    return reinterpret_cast<int_transform_fn>(foreign_function_address(fn, int_transform_signature));
+}
+
+int apply_callback_wrapper(int x, const py::function& transform) {
+    if (int_transform_fn native = native_int_transform(transform)) {
+        return apply_callback(x, native);
+    }
+    return transform(x).cast<int>();
+}
+
+int sum_with_transform_wrapper(const py::array_t<int, py::array::c_style | py::array::forcecast>& input,
+                               const py::function& transform) {
+    py::buffer_info buf_info = input.request();
+    
+    if (buf_info.ndim != 1) {
+        throw std::runtime_error("Input array must be 1-dimensional");
+    }
+    
+    const int* ptr = static_cast<const int*>(buf_info.ptr);
+    size_t size = buf_info.shape[0];
+    
+    if (int_transform_fn native = native_int_transform(transform)) {
+        // Pure C loop; ctypes/cffi trampolines re-acquire the GIL themselves
+        py::gil_scoped_release release;
+        return sum_with_transform(ptr, size, native);
+    }
+    
+    // Same wrapping int32 sum as benchlib, one Python call per element
+    uint32_t sum = 0;
+    for (size_t i = 0; i < size; i++) {
+        sum += static_cast<uint32_t>(transform(ptr[i]).cast<int>());
+    }
+    return static_cast<int>(sum);
+}
+
+// Context threaded through benchlib's void* for Python process callbacks
+struct PyProcessContext {
+    const py::function* process;
+    std::exception_ptr error;
+};
+
+static int py_process_trampoline(size_t index, double value, void* context) {
+    auto* ctx = static_cast<PyProcessContext*>(context);
+    try {
+        py::object result = (*ctx->process)(index, value);
+        return result.is_none() ? 0 : result.cast<int>();
+    } catch (...) {
+        // Never unwind through C frames: stop iterating and rethrow in the wrapper
+        ctx->error = std::current_exception();
+        return -1;
+    }
+}
+
+// process(index, value) -> status; 0/None continues, anything else stops
+// the walk and is returned
+int iterate_with_callback_wrapper(const py::array_t<double, py::array::c_style | py::array::forcecast>& data,
+                                  const py::function& process) {
+    py::buffer_info buf_info = data.request();
+    
+    if (buf_info.ndim != 1) {
+        throw std::runtime_error("Input array must be 1-dimensional");
+    }
+    
+    const double* ptr = static_cast<const double*>(buf_info.ptr);
+    size_t size = buf_info.shape[0];
+    
+    if (void* address = foreign_function_address(process, process_signature)) {
+        py::gil_scoped_release release;
+        return iterate_with_callback(ptr, size, reinterpret_cast<process_fn>(address), nullptr);
+    }
+    
+    PyProcessContext ctx{&process, nullptr};
+    int status = iterate_with_callback(ptr, size, py_process_trampoline, &ctx);
+    if (ctx.error) {
+        std::rethrow_exception(ctx.error);
+    }
+    return status;
 }
 
 // String operation wrappers
@@ -217,6 +1330,105 @@ std::string string_concat_wrapper(py::bytes a, py::bytes b) {
     return "";
 }
 
+// Zero-copy string wrappers - borrow the caller's storage instead of
+// materialising a std::string. bytes objects take the PyBytes fast path
+// (always NUL-terminated); other bytes-like objects go through the buffer
+// protocol and are held until the view goes out of scope.
+class BytesView {
+public:
+    explicit BytesView(py::handle obj) {
+        if (PyBytes_Check(obj.ptr())) {
+            char* data = nullptr;
+            Py_ssize_t len = 0;
+            if (PyBytes_AsStringAndSize(obj.ptr(), &data, &len) != 0) {
+                throw py::error_already_set();
+            }
+            view_ = std::string_view(data, static_cast<size_t>(len));
+            nul_terminated_ = true;
+        } else {
+            if (PyObject_GetBuffer(obj.ptr(), &buffer_, PyBUF_SIMPLE) != 0) {
+                throw py::error_already_set();
+            }
+            has_buffer_ = true;
+            view_ = std::string_view(static_cast<const char*>(buffer_.buf),
+                                     static_cast<size_t>(buffer_.len));
+        }
+    }
+    
+    ~BytesView() {
+        if (has_buffer_) {
+            PyBuffer_Release(&buffer_);
+        }
+    }
+    
+    BytesView(const BytesView&) = delete;
+    BytesView& operator=(const BytesView&) = delete;
+    
+    std::string_view view() const { return view_; }
+    
+    // C-string semantics: stop at the first embedded NUL like strlen does
+    std::string_view c_view() const { return view_.substr(0, view_.find('\0')); }
+    
+    // True when data()[size()] is a readable NUL, so C functions can take it as-is
+    bool nul_terminated() const { return nul_terminated_; }
+
+private:
+    Py_buffer buffer_{};
+    std::string_view view_;
+    bool has_buffer_ = false;
+    bool nul_terminated_ = false;
+};
+
+size_t bytes_length_view_wrapper(py::handle data, size_t len) {
+    BytesView view(data);
+    return bytes_length(view.view().data(), len);
+}
+
+size_t utf8_length_view_wrapper(py::handle data) {
+    BytesView view(data);
+    if (view.nul_terminated()) {
+        return utf8_length(view.view().data());
+    }
+    
+    // Not NUL-terminated: count in place with the same rule as utf8_length
+    size_t chars = 0;
+    for (char c : view.c_view()) {
+        if ((c & 0xC0) != 0x80) chars++;
+    }
+    return chars;
+}
+
+py::bytes string_concat_view_wrapper(py::handle a, py::handle b) {
+    BytesView view_a(a);
+    BytesView view_b(b);
+    std::string_view str_a = view_a.c_view();
+    std::string_view str_b = view_b.c_view();
+    
+    if (view_a.nul_terminated() && view_b.nul_terminated()) {
+        char* result = string_concat(str_a.data(), str_b.data());
+        if (!result) {
+            throw std::bad_alloc();
+        }
+        // Single copy: C result straight into the returned bytes object
+        PyObject* out = PyBytes_FromStringAndSize(result, str_a.size() + str_b.size());
+        free_string(result);
+        if (!out) {
+            throw py::error_already_set();
+        }
+        return py::reinterpret_steal<py::bytes>(out);
+    }
+    
+    // Buffers without a terminator: concatenate directly into the result
+    PyObject* out = PyBytes_FromStringAndSize(nullptr, str_a.size() + str_b.size());
+    if (!out) {
+        throw py::error_already_set();
+    }
+    char* dst = PyBytes_AS_STRING(out);
+    std::memcpy(dst, str_a.data(), str_a.size());
+    std::memcpy(dst + str_a.size(), str_b.data(), str_b.size());
+    return py::reinterpret_steal<py::bytes>(out);
+}
+
 void free_string_wrapper(char*) {
     // No-op for pybind11 - memory managed automatically
 }
@@ -225,7 +1437,12 @@ std::string string_identity_wrapper(const std::string& s) {
     return std::string(string_identity(s.c_str()));
 }
 
+// Free-threaded builds: the module keeps no Python-visible state behind the GIL
+#if PYBIND11_VERSION_HEX >= 0x020D0000
+PYBIND11_MODULE(benchlib_pybind11, m, py::mod_gil_not_used()) {
+#else
 PYBIND11_MODULE(benchlib_pybind11, m) {
+#endif
     m.doc() = "pybind11 bindings for FFI benchmark library";
     
     // Basic operations
@@ -247,6 +1464,31 @@ PYBIND11_MODULE(benchlib_pybind11, m) {
     m.def("add_double", &add_double, "Add two doubles");
     m.def("multiply_double", &multiply_double, "Multiply two doubles");
     
+    // Dispatch pattern functions
+    bind_dispatch_functions(m, std::make_index_sequence<dispatch_count>{});
+    m.def("dispatch_c_baseline", &dispatch_c_baseline,
+          "C-side table dispatch baseline", py::arg("func_id"), py::arg("a"), py::arg("b"));
+    m.def("dispatch_batch", &dispatch_batch_wrapper,
+          "Dispatch func_ids[i](a[i], b[i]) into out through the native table; "
+          "raises IndexError without touching out if any id is out of range",
+          py::arg("func_ids"), py::arg("a"), py::arg("b"), py::arg("out"));
+    
+    // Batch operations (a, b -> out, one call per array)
+    m.def("add_int32_batch", &binary_batch_wrapper<int, int, add_int32>,
+          "Element-wise add_int32 over arrays", py::arg("a"), py::arg("b"), py::arg("out"));
+    m.def("add_int64_batch", &binary_batch_wrapper<long long, long long, add_int64>,
+          "Element-wise add_int64 over arrays", py::arg("a"), py::arg("b"), py::arg("out"));
+    m.def("add_float_batch", &binary_batch_wrapper<float, float, add_float>,
+          "Element-wise add_float over arrays", py::arg("a"), py::arg("b"), py::arg("out"));
+    m.def("add_double_batch", &binary_batch_wrapper<double, double, add_double>,
+          "Element-wise add_double over arrays", py::arg("a"), py::arg("b"), py::arg("out"));
+    m.def("multiply_double_batch", &binary_batch_wrapper<double, double, multiply_double>,
+          "Element-wise multiply_double over arrays", py::arg("a"), py::arg("b"), py::arg("out"));
+    m.def("logical_and_batch", &binary_batch_wrapper<bool, bool, logical_and>,
+          "Element-wise logical_and over arrays", py::arg("a"), py::arg("b"), py::arg("out"));
+    m.def("logical_or_batch", &binary_batch_wrapper<bool, bool, logical_or>,
+          "Element-wise logical_or over arrays", py::arg("a"), py::arg("b"), py::arg("out"));
+    
     // Array operations
     m.def("sum_doubles_readonly", &sum_doubles_readonly_wrapper, 
           "Sum array of doubles (read-only)", py::arg("input"));
@@ -257,11 +1499,48 @@ PYBIND11_MODULE(benchlib_pybind11, m) {
     m.def("fill_int32_array", &fill_int32_array_wrapper,
           "Fill array with value", py::arg("input"), py::arg("value"));
     
+    // No-copy array operations (strided views go to sum_strided, copies are counted)
+    m.def("sum_doubles_strided", &sum_doubles_strided_wrapper,
+          "Sum array of doubles honouring strides (no implicit copy)", py::arg("input"));
+    m.def("scale_doubles_inplace_nocopy", &scale_doubles_inplace_nocopy_wrapper,
+          "Scale contiguous float64 buffer in-place (no implicit copy)",
+          py::arg("input"), py::arg("factor"));
+    m.def("dot_product_nocopy", &dot_product_nocopy_wrapper,
+          "Dot product (copies only non-contiguous/non-float64 input)", py::arg("a"), py::arg("b"));
+    m.def("vector_add_nocopy", &vector_add_nocopy_wrapper,
+          "Vector addition (copies only non-contiguous/non-float64 input)",
+          py::arg("a"), py::arg("b"), py::arg("c"));
+    m.def("vector_norm_nocopy", &vector_norm_nocopy_wrapper,
+          "Vector norm (copies only non-contiguous/non-float64 input)", py::arg("v"));
+    m.def("get_conversion_copy_count", &get_conversion_copy_count,
+          "Number of conversion copies made by the no-copy wrappers");
+    m.def("reset_conversion_copy_count", &reset_conversion_copy_count,
+          "Reset the conversion copy counter");
+    
     // String operations
     m.def("bytes_length", &bytes_length_wrapper, "Get byte length of string");
     m.def("utf8_length", &utf8_length_wrapper, "Get UTF-8 character count");
+    m.def("string_concat", &string_concat_wrapper, "Concatenate two strings");
     m.def("string_identity", &string_identity_wrapper, "String identity function");
     
+    // Zero-copy string operations (borrow bytes/buffer storage, no std::string)
+    m.def("bytes_length_view", &bytes_length_view_wrapper,
+          "Get byte length of string (zero-copy)", py::arg("data"), py::arg("len"));
+    m.def("utf8_length_view", &utf8_length_view_wrapper,
+          "Get UTF-8 character count (zero-copy)", py::arg("data"));
+    m.def("string_concat_view", &string_concat_view_wrapper,
+          "Concatenate two strings (zero-copy inputs)", py::arg("a"), py::arg("b"));
+    
+    // Pool allocator (blocks are buffer-protocol objects)
+    py::class_<PoolBlock>(m, "PoolBlock", py::buffer_protocol())
+        .def(py::init<size_t>(), py::arg("size"))
+        .def_property_readonly("size", &PoolBlock::size)
+        .def_property_readonly("capacity", &PoolBlock::capacity)
+        .def_buffer(&PoolBlock::buffer);
+    m.def("pool_allocate", &pool_allocate_wrapper,
+          "Allocate a pool block; memoryview(block) is zero-copy", py::arg("size"));
+    m.def("pool_stats", &pool_stats_wrapper, "Shared pool statistics");
+    
     // Structure operations
     py::class_<SimpleStruct>(m, "SimpleStruct")
         .def(py::init<>())
@@ -273,19 +1552,113 @@ PYBIND11_MODULE(benchlib_pybind11, m) {
     m.def("sum_simple", &sum_simple, "Sum SimpleStruct fields");
     m.def("modify_simple", &modify_simple, "Modify SimpleStruct value");
     
+    // Structured-array operations (no per-record Python objects)
+    PYBIND11_NUMPY_DTYPE(SimpleStruct, x, y, value);
+    m.attr("simple_struct_dtype") = py::dtype::of<SimpleStruct>();
+    m.def("create_simple_array", &create_simple_array,
+          "Zero-filled SimpleStruct structured array", py::arg("n"));
+    m.def("sum_simple_array", &sum_simple_array_wrapper,
+          "Sum SimpleStruct fields over a structured array", py::arg("arr"));
+    m.def("modify_simple_array", &modify_simple_array_wrapper,
+          "Set value on every SimpleStruct in place", py::arg("arr"), py::arg("new_value"));
+    
+    // ComplexStruct as an owning capsule
+    m.def("create_complex", &create_complex_wrapper,
+          "Create ComplexStruct capsule with a zeroed buffer", py::arg("name"), py::arg("count"));
+    m.def("sum_complex_buffer", &sum_complex_buffer_wrapper,
+          "Sum ComplexStruct buffer", py::arg("s"));
+    m.def("complex_name", &complex_name_wrapper, "ComplexStruct name", py::arg("s"));
+    m.def("complex_buffer", &complex_buffer_view,
+          "Zero-copy float64 view of the ComplexStruct buffer", py::arg("s"));
+    m.def("complex_points", &complex_points_view,
+          "Zero-copy SimpleStruct view of the ComplexStruct points", py::arg("s"));
+    
     // Callback operations
     m.def("apply_callback", &apply_callback_wrapper, 
-          "Apply callback function", py::arg("x"), py::arg("transform"));
+          "Apply callback function (native callables skip Python)", py::arg("x"), py::arg("transform"));
     m.def("c_transform", &c_transform, "C transform function");
+    m.def("sum_with_transform", &sum_with_transform_wrapper,
+          "Sum transform(x) over an int32 array", py::arg("arr"), py::arg("transform"));
+    m.def("iterate_with_callback", &iterate_with_callback_wrapper,
+          "Call process(index, value) per element until it returns non-zero",
+          py::arg("data"), py::arg("process"));
     
     // Matrix operations
     m.def("matrix_multiply_naive", &matrix_multiply_naive_wrapper,
           "Naive matrix multiplication", 
           py::arg("a"), py::arg("b"), py::arg("c"), py::arg("m"), py::arg("n"), py::arg("k"));
+    m.def("matrix_multiply_blocked", &matrix_multiply_blocked_wrapper,
+          "Cache/register-blocked SIMD matrix multiplication",
+          py::arg("a"), py::arg("b"), py::arg("c"), py::arg("m"), py::arg("n"), py::arg("k"));
+    m.def("matrix_multiply_blocked_kernel", &matrix_multiply_blocked_kernel,
+          "Name of the SIMD kernel selected for matrix_multiply_blocked");
     m.def("dot_product", &dot_product_wrapper,
           "Dot product of two vectors", py::arg("a"), py::arg("b"));
     m.def("vector_add", &vector_add_wrapper,
           "Vector addition", py::arg("a"), py::arg("b"), py::arg("c"));
     m.def("vector_norm", &vector_norm_wrapper,
           "Vector norm", py::arg("v"));
+    
+    // Parallel reductions (worker pool above the size threshold, GIL released)
+    m.def("sum_doubles_readonly_parallel", &sum_doubles_readonly_parallel_wrapper,
+          "Sum array of doubles on the reduction pool", py::arg("input"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("dot_product_parallel", &dot_product_parallel_wrapper,
+          "Dot product on the reduction pool", py::arg("a"), py::arg("b"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("vector_norm_parallel", &vector_norm_parallel_wrapper,
+          "Vector norm on the reduction pool", py::arg("v"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("set_parallel_threshold", &set_parallel_threshold,
+          "Minimum element count before reductions go parallel", py::arg("n"));
+    m.def("get_parallel_threshold", &get_parallel_threshold,
+          "Current parallel reduction threshold");
+    m.def("set_parallel_threads", &set_parallel_threads,
+          "Threads per reduction including the caller (0 = all)", py::arg("n"));
+    m.def("get_parallel_pool_size", &get_parallel_pool_size,
+          "Maximum threads a reduction can use");
+    
+    // Native timing harness (per-call distribution measured inside C++)
+    m.def("native_time", &native_time_wrapper,
+          "Time a scalar-argument benchlib function (see native_time_functions) in a native "
+          "loop; returns per-call samples and a histogram",
+          py::arg("name"), py::arg("samples") = 10000, py::arg("batch") = 64, py::arg("bins") = 50);
+    m.def("native_time_functions", &native_time_functions,
+          "Names accepted by native_time");
+    
+    // Hardware counters (perf_event_open; collection is off until enabled)
+    m.def("counters_available", &benchperf::available,
+          "Whether perf_event_open counters work on the calling thread");
+    m.def("counters_set_enabled", &benchperf::set_enabled,
+          "Turn per-region counter collection on or off", py::arg("enabled"));
+    m.def("counters_begin", &counters_begin_wrapper,
+          "Open a counter region on the calling thread", py::arg("region"));
+    m.def("counters_end", &counters_end_wrapper,
+          "Close a counter region on the calling thread", py::arg("region"));
+    m.def("counters_read", &counters_read_wrapper,
+          "Counter totals for a region across all threads", py::arg("region"));
+    m.def("counters_reset", &benchperf::reset, "Clear all counter regions");
+    py::dict counter_regions;
+    counter_regions["matrix_multiply_naive"] = static_cast<int>(REGION_MATMUL_NAIVE);
+    counter_regions["matrix_multiply_blocked"] = static_cast<int>(REGION_MATMUL_BLOCKED);
+    counter_regions["dot_product"] = static_cast<int>(REGION_DOT_PRODUCT);
+    counter_regions["vector_norm"] = static_cast<int>(REGION_VECTOR_NORM);
+    counter_regions["sum_doubles_readonly_parallel"] = static_cast<int>(REGION_PARALLEL_SUM);
+    counter_regions["dot_product_parallel"] = static_cast<int>(REGION_PARALLEL_DOT);
+    counter_regions["vector_norm_parallel"] = static_cast<int>(REGION_PARALLEL_NORM);
+    m.attr("counter_regions") = counter_regions;
+    
+    // GIL-releasing kernels (for multi-threaded / free-threaded benchmarks)
+    m.def("matrix_multiply_naive_nogil", &matrix_multiply_naive_nogil_wrapper,
+          "Naive matrix multiplication (releases the GIL)",
+          py::arg("a"), py::arg("b"), py::arg("c"), py::arg("m"), py::arg("n"), py::arg("k"));
+    m.def("dot_product_nogil", &dot_product_nogil_wrapper,
+          "Dot product of two vectors (releases the GIL)", py::arg("a"), py::arg("b"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("vector_norm_nogil", &vector_norm_nogil_wrapper,
+          "Vector norm (releases the GIL)", py::arg("v"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("scale_doubles_inplace_nogil", &scale_doubles_inplace_nogil_wrapper,
+          "Scale array of doubles in-place (releases the GIL)",
+          py::arg("input"), py::arg("factor"));
 }
\ No newline at end of file
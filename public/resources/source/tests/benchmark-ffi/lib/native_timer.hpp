@@ -0,0 +1,205 @@
+/*
+ * native_timer.hpp - Tight-loop native timing with loop-overhead subtraction
+ *
+ * Header-only like the other shared helpers. The Python timers cannot
+ * resolve the few-ns differences between FFI layers, so this times a
+ * callable `batch` times per sample entirely in native code and reports
+ * the per-call distribution.
+ *
+ * On x86-64 the clock is the TSC, read as lfence;rdtsc at the start and
+ * rdtscp;lfence at the end so the measured instructions cannot drift out
+ * of the window. Ticks are converted with a one-off calibration against
+ * CLOCK_MONOTONIC_RAW, which is also the fallback clock elsewhere. The cost
+ * of an empty iteration of the same loop is measured and subtracted.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHTIME_USE_TSC 1
+#else
+#define BENCHTIME_USE_TSC 0
+#endif
+
+namespace benchtime {
+
+// Keep a value (and everything it depends on) alive without emitting code.
+// GCC can report "+r,m" as an impossible constraint for values that already
+// live in memory, so it gets the alternatives in the other order.
+template <typename T>
+inline void do_not_optimize(T& value) {
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#else
+    asm volatile("" : "+m,r"(value) : : "memory");
+#endif
+}
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+// Call fn(args...) with every argument passed through do_not_optimize first,
+// so constant inputs can't be folded into the call or hoisted out of a timing
+// loop, and keep the result alive
+template <typename Fn, typename... Args>
+inline void call_opaque(Fn&& fn, Args&... args) {
+    (do_not_optimize(args), ...);
+    if constexpr (std::is_void_v<std::invoke_result_t<Fn&, Args&...>>) {
+        fn(args...);
+    } else {
+        auto result = fn(args...);
+        do_not_optimize(result);
+    }
+}
+
+inline std::uint64_t monotonic_raw_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+inline std::uint64_t read_start() {
+#if BENCHTIME_USE_TSC
+    _mm_lfence();
+    std::uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+#else
+    return monotonic_raw_ns();
+#endif
+}
+
+inline std::uint64_t read_end() {
+#if BENCHTIME_USE_TSC
+    unsigned aux;
+    std::uint64_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+#else
+    return monotonic_raw_ns();
+#endif
+}
+
+inline const char* clock_name() {
+    return BENCHTIME_USE_TSC ? "rdtsc" : "clock_monotonic_raw";
+}
+
+// Nanoseconds per tick, calibrated once over ~20 ms
+inline double ns_per_tick() {
+#if BENCHTIME_USE_TSC
+    static const double ratio = [] {
+        std::uint64_t ns0 = monotonic_raw_ns();
+        std::uint64_t t0 = read_start();
+        while (monotonic_raw_ns() - ns0 < 20000000ULL) {
+        }
+        std::uint64_t ns1 = monotonic_raw_ns();
+        std::uint64_t t1 = read_end();
+        return t1 > t0 ? static_cast<double>(ns1 - ns0) / static_cast<double>(t1 - t0) : 1.0;
+    }();
+    return ratio;
+#else
+    return 1.0;
+#endif
+}
+
+// Raw ticks for `samples` runs of `batch` back-to-back calls
+template <typename Fn>
+std::vector<std::uint64_t> sample_ticks(Fn&& fn, std::size_t samples, std::size_t batch) {
+    std::vector<std::uint64_t> ticks(samples);
+    for (std::size_t i = 0; i < batch; i++) fn();  // Warm caches and predictors
+    for (std::size_t s = 0; s < samples; s++) {
+        std::uint64_t start = read_start();
+        for (std::size_t i = 0; i < batch; i++) {
+            fn();
+            clobber_memory();
+        }
+        ticks[s] = read_end() - start;
+    }
+    return ticks;
+}
+
+struct Histogram {
+    double lo_ns;                       // Left edge of the first bin
+    double bin_width_ns;
+    std::vector<std::uint64_t> counts;  // counts.back() also holds everything above the range
+};
+
+struct Measurement {
+    std::vector<double> per_call_ns;    // One entry per sample, overhead subtracted
+    double overhead_ns;                 // Per-call cost of the empty loop
+    double min_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double max_ns;
+    double mean_ns;
+    Histogram histogram;
+};
+
+inline double sorted_quantile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    std::size_t idx = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+// Bins span [min, p99] so a few preemptions do not flatten the shape;
+// the tail lands in the last bin
+inline Histogram make_histogram(const std::vector<double>& sorted, std::size_t bins) {
+    Histogram hist{0.0, 0.0, std::vector<std::uint64_t>(std::max<std::size_t>(bins, 1), 0)};
+    if (sorted.empty()) return hist;
+    hist.lo_ns = sorted.front();
+    double hi = sorted_quantile(sorted, 0.99);
+    hist.bin_width_ns = hi > hist.lo_ns ? (hi - hist.lo_ns) / static_cast<double>(hist.counts.size()) : 1.0;
+    for (double v : sorted) {
+        auto bin = static_cast<std::size_t>((v - hist.lo_ns) / hist.bin_width_ns);
+        hist.counts[std::min(bin, hist.counts.size() - 1)]++;
+    }
+    return hist;
+}
+
+// Per-call distribution of fn(); overhead is the median empty-loop sample
+template <typename Fn>
+Measurement measure(Fn&& fn, std::size_t samples, std::size_t batch, std::size_t bins) {
+    samples = std::max<std::size_t>(samples, 1);
+    batch = std::max<std::size_t>(batch, 1);
+    const double scale = ns_per_tick() / static_cast<double>(batch);
+
+    std::vector<std::uint64_t> empty = sample_ticks([] {}, samples, batch);
+    std::nth_element(empty.begin(), empty.begin() + empty.size() / 2, empty.end());
+    double overhead_ns = static_cast<double>(empty[empty.size() / 2]) * scale;
+
+    std::vector<std::uint64_t> ticks = sample_ticks(fn, samples, batch);
+
+    Measurement out{};
+    out.overhead_ns = overhead_ns;
+    out.per_call_ns.reserve(samples);
+    double sum = 0.0;
+    for (std::uint64_t t : ticks) {
+        double ns = std::max(0.0, static_cast<double>(t) * scale - overhead_ns);
+        out.per_call_ns.push_back(ns);
+        sum += ns;
+    }
+    out.mean_ns = sum / static_cast<double>(samples);
+
+    std::vector<double> sorted = out.per_call_ns;
+    std::sort(sorted.begin(), sorted.end());
+    out.min_ns = sorted.front();
+    out.p50_ns = sorted_quantile(sorted, 0.50);
+    out.p90_ns = sorted_quantile(sorted, 0.90);
+    out.p99_ns = sorted_quantile(sorted, 0.99);
+    out.max_ns = sorted.back();
+    out.histogram = make_histogram(sorted, bins);
+    return out;
+}
+
+}  // namespace benchtime
@@ -0,0 +1,326 @@
+/*
+ * perf_counters.hpp - Per-region hardware counters around native kernels
+ *
+ * Header-only so both the pybind11 module and race/threadtest.cpp can
+ * attribute cycles/instructions/LLC misses/branch misses to the native code
+ * itself instead of wrapping the whole interpreter in `perf stat`.
+ *
+ * Each thread lazily opens one perf_event_open group (user space only) on
+ * first use. begin(region) snapshots the group, end(region) adds the delta
+ * to that thread's accumulator for the region; read(region) sums every live
+ * thread plus threads that have already exited. Multiplexed groups are
+ * scaled by time_enabled / time_running at read time.
+ *
+ * Collection is off by default, so instrumented kernels pay one relaxed
+ * load. Regions must not nest with themselves on the same thread. On
+ * non-Linux systems, or when perf_event_open is denied (see
+ * /proc/sys/kernel/perf_event_paranoid), everything degrades to no-ops and
+ * available() reports false.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace benchperf {
+
+inline constexpr int MAX_REGIONS = 64;
+
+enum Event : int {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    NUM_EVENTS
+};
+
+// Aggregated, multiplex-scaled view of one region
+struct RegionStats {
+    std::uint64_t calls;
+    std::uint64_t values[NUM_EVENTS];  // Indexed by Event; 0 if the event could not be opened
+    std::uint64_t time_enabled_ns;
+    std::uint64_t time_running_ns;
+    std::uint32_t threads;             // Threads that completed at least one call
+};
+
+struct RegionAccumulator {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> values[NUM_EVENTS]{};
+    std::atomic<std::uint64_t> time_enabled{0};
+    std::atomic<std::uint64_t> time_running{0};
+};
+
+inline std::atomic<bool>& enabled_flag() {
+    static std::atomic<bool> flag{false};
+    return flag;
+}
+
+inline bool enabled() {
+    return enabled_flag().load(std::memory_order_relaxed);
+}
+
+inline void set_enabled(bool on) {
+    enabled_flag().store(on, std::memory_order_relaxed);
+}
+
+class ThreadCounters;
+
+// Live thread list plus totals folded in from exited threads. Leaked on
+// purpose so thread_local destructors can still reach it at exit.
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadCounters*> live;
+    std::uint64_t retired[MAX_REGIONS][NUM_EVENTS + 3] = {};  // values, calls, enabled, running
+    std::uint32_t retired_threads[MAX_REGIONS] = {};
+};
+
+inline Registry& registry() {
+    static Registry* reg = new Registry();
+    return *reg;
+}
+
+class ThreadCounters {
+public:
+    ThreadCounters() {
+        Registry& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        reg.live.push_back(this);
+    }
+
+    ~ThreadCounters() {
+        Registry& reg = registry();
+        {
+            std::lock_guard lock(reg.mutex);
+            for (int r = 0; r < MAX_REGIONS; r++) {
+                std::uint64_t calls = regions_[r].calls.load(std::memory_order_relaxed);
+                if (calls == 0) continue;
+                for (int e = 0; e < NUM_EVENTS; e++) {
+                    reg.retired[r][e] += regions_[r].values[e].load(std::memory_order_relaxed);
+                }
+                reg.retired[r][NUM_EVENTS] += calls;
+                reg.retired[r][NUM_EVENTS + 1] += regions_[r].time_enabled.load(std::memory_order_relaxed);
+                reg.retired[r][NUM_EVENTS + 2] += regions_[r].time_running.load(std::memory_order_relaxed);
+                reg.retired_threads[r]++;
+            }
+            std::erase(reg.live, this);
+        }
+        close_group();
+    }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    bool open() {
+        if (state_ == State::Unopened) open_group();
+        return state_ == State::Open;
+    }
+
+    void begin(int region) {
+        if (!open()) return;
+        pending_[region].valid = read_group(pending_[region]);
+    }
+
+    void end(int region) {
+        Snapshot& start = pending_[region];
+        if (!start.valid) return;
+        start.valid = false;
+        Snapshot now;
+        if (!read_group(now)) return;
+
+        RegionAccumulator& acc = regions_[region];
+        for (int e = 0; e < NUM_EVENTS; e++) {
+            acc.values[e].fetch_add(now.values[e] - start.values[e], std::memory_order_relaxed);
+        }
+        acc.time_enabled.fetch_add(now.time_enabled - start.time_enabled, std::memory_order_relaxed);
+        acc.time_running.fetch_add(now.time_running - start.time_running, std::memory_order_relaxed);
+        acc.calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const RegionAccumulator& region(int r) const { return regions_[r]; }
+
+    void reset() {
+        for (RegionAccumulator& acc : regions_) {
+            acc.calls.store(0, std::memory_order_relaxed);
+            for (auto& value : acc.values) value.store(0, std::memory_order_relaxed);
+            acc.time_enabled.store(0, std::memory_order_relaxed);
+            acc.time_running.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    enum class State { Unopened, Open, Unavailable };
+
+    struct Snapshot {
+        std::uint64_t values[NUM_EVENTS] = {};
+        std::uint64_t time_enabled = 0;
+        std::uint64_t time_running = 0;
+        bool valid = false;
+    };
+
+#ifdef __linux__
+    void open_group() {
+        static constexpr std::uint64_t configs[NUM_EVENTS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,  // Last-level cache misses
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        int next_slot = 0;
+        for (int e = 0; e < NUM_EVENTS; e++) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[e];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1,
+                                              leader_fd_, PERF_FLAG_FD_CLOEXEC));
+            if (fd < 0) {
+                if (e == CYCLES) {
+                    state_ = State::Unavailable;  // No leader, no group
+                    return;
+                }
+                slot_[e] = -1;  // Member unsupported on this PMU; reported as 0
+                continue;
+            }
+            if (e == CYCLES) leader_fd_ = fd;
+            fds_[e] = fd;
+            slot_[e] = next_slot++;
+        }
+        members_ = next_slot;
+        state_ = State::Open;
+    }
+
+    bool read_group(Snapshot& out) {
+        // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, values[nr]
+        std::uint64_t buffer[3 + NUM_EVENTS];
+        auto want = static_cast<ssize_t>((3 + members_) * sizeof(std::uint64_t));
+        if (::read(leader_fd_, buffer, sizeof(buffer)) < want) return false;
+        out.time_enabled = buffer[1];
+        out.time_running = buffer[2];
+        for (int e = 0; e < NUM_EVENTS; e++) {
+            out.values[e] = slot_[e] >= 0 ? buffer[3 + slot_[e]] : 0;
+        }
+        return true;
+    }
+
+    void close_group() {
+        for (int& fd : fds_) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    }
+#else
+    void open_group() { state_ = State::Unavailable; }
+    bool read_group(Snapshot&) { return false; }
+    void close_group() {}
+#endif
+
+    State state_ = State::Unopened;
+    int leader_fd_ = -1;
+    int members_ = 0;
+    int fds_[NUM_EVENTS] = {-1, -1, -1, -1};
+    int slot_[NUM_EVENTS] = {-1, -1, -1, -1};
+    Snapshot pending_[MAX_REGIONS];
+    RegionAccumulator regions_[MAX_REGIONS];
+};
+
+inline ThreadCounters& thread_counters() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+inline bool valid_region(int region) {
+    return region >= 0 && region < MAX_REGIONS;
+}
+
+// Whether counters can be opened on the calling thread
+inline bool available() {
+    return thread_counters().open();
+}
+
+inline void begin(int region) {
+    if (enabled() && valid_region(region)) thread_counters().begin(region);
+}
+
+inline void end(int region) {
+    if (enabled() && valid_region(region)) thread_counters().end(region);
+}
+
+inline RegionStats read(int region) {
+    RegionStats out{};
+    if (!valid_region(region)) return out;
+
+    Registry& reg = registry();
+    std::lock_guard lock(reg.mutex);
+    for (int e = 0; e < NUM_EVENTS; e++) out.values[e] = reg.retired[region][e];
+    out.calls = reg.retired[region][NUM_EVENTS];
+    out.time_enabled_ns = reg.retired[region][NUM_EVENTS + 1];
+    out.time_running_ns = reg.retired[region][NUM_EVENTS + 2];
+    out.threads = reg.retired_threads[region];
+
+    for (ThreadCounters* thread : reg.live) {
+        const RegionAccumulator& acc = thread->region(region);
+        std::uint64_t calls = acc.calls.load(std::memory_order_relaxed);
+        if (calls == 0) continue;
+        for (int e = 0; e < NUM_EVENTS; e++) {
+            out.values[e] += acc.values[e].load(std::memory_order_relaxed);
+        }
+        out.calls += calls;
+        out.time_enabled_ns += acc.time_enabled.load(std::memory_order_relaxed);
+        out.time_running_ns += acc.time_running.load(std::memory_order_relaxed);
+        out.threads++;
+    }
+
+    // Extrapolate if the group was multiplexed off the PMU part of the time
+    if (out.time_running_ns > 0 && out.time_running_ns < out.time_enabled_ns) {
+        double scale = static_cast<double>(out.time_enabled_ns) / static_cast<double>(out.time_running_ns);
+        for (auto& value : out.values) {
+            value = static_cast<std::uint64_t>(static_cast<double>(value) * scale);
+        }
+    }
+    return out;
+}
+
+// Clears live threads' accumulators and retired totals; call while no
+// region is in flight
+inline void reset() {
+    Registry& reg = registry();
+    std::lock_guard lock(reg.mutex);
+    for (ThreadCounters* thread : reg.live) thread->reset();
+    for (auto& row : reg.retired) {
+        for (auto& value : row) value = 0;
+    }
+    for (auto& threads : reg.retired_threads) threads = 0;
+}
+
+// RAII region for instrumenting a native kernel
+class ScopedRegion {
+public:
+    explicit ScopedRegion(int region) : region_(region), active_(enabled()) {
+        if (active_) begin(region_);
+    }
+    ~ScopedRegion() {
+        if (active_) end(region_);
+    }
+    ScopedRegion(const ScopedRegion&) = delete;
+    ScopedRegion& operator=(const ScopedRegion&) = delete;
+
+private:
+    int region_;
+    bool active_;
+};
+
+}  // namespace benchperf
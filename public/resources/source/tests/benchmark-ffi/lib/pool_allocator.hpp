@@ -0,0 +1,233 @@
+/*
+ * pool_allocator.hpp - Size-class pool allocator shared by the native layers
+ *
+ * Header-only so both the pybind11 module (built with benchlib.c) and the
+ * race/threadtest.cpp library can expose it without another shared object.
+ *
+ * Layout: memory comes from SLAB_SIZE slabs aligned to SLAB_SIZE, each
+ * carved into blocks of one size class. The slab header is found by masking
+ * a block address, so blocks carry no per-allocation header. Each thread
+ * keeps a free list per class; it refills from / spills to a shared list in
+ * batches, so the shared mutex is touched once per BATCH operations.
+ * Fresh blocks are bumped off the current slab on demand.
+ * Slabs are never returned to the OS - the point is to cap RSS growth at the
+ * high-water mark instead of letting per-thread malloc arenas fragment.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+namespace benchpool {
+
+inline constexpr std::size_t SLAB_SIZE = 256 * 1024;
+inline constexpr std::size_t SLAB_HEADER = 64;  // Keeps blocks 64-byte aligned where the class allows
+inline constexpr std::size_t BATCH = 32;        // Blocks moved per refill/spill
+inline constexpr std::array<std::size_t, 10> SIZE_CLASSES = {
+    16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192
+};
+inline constexpr std::size_t MAX_BLOCK_SIZE = SIZE_CLASSES.back();
+inline constexpr std::size_t NUM_CLASSES = SIZE_CLASSES.size();
+
+struct Slab {
+    std::size_t size_class;
+    std::size_t block_size;
+};
+static_assert(sizeof(Slab) <= SLAB_HEADER);
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct Stats {
+    std::size_t slab_bytes;        // Total bytes obtained from the system
+    std::size_t slabs;
+    std::size_t shared_free_blocks;
+};
+
+inline std::size_t size_class_for(std::size_t size) {
+    for (std::size_t c = 0; c < NUM_CLASSES; c++) {
+        if (size <= SIZE_CLASSES[c]) return c;
+    }
+    return NUM_CLASSES;
+}
+
+inline Slab* slab_of(const void* ptr) {
+    return reinterpret_cast<Slab*>(reinterpret_cast<std::uintptr_t>(ptr) & ~(SLAB_SIZE - 1));
+}
+
+class SharedPool {
+public:
+    // Move up to `max` blocks of `size_class` into the caller's list: recycled
+    // blocks first, then fresh ones bumped off the class's current slab
+    std::size_t take(std::size_t size_class, FreeBlock*& head, std::size_t max) {
+        Central& central = centrals_[size_class];
+        std::lock_guard lock(central.mutex);
+        std::size_t moved = 0;
+        while (moved < max && central.head != nullptr) {
+            FreeBlock* block = central.head;
+            central.head = block->next;
+            block->next = head;
+            head = block;
+            moved++;
+        }
+        central.count -= moved;
+
+        const std::size_t block_size = SIZE_CLASSES[size_class];
+        while (moved < max) {
+            if (static_cast<std::size_t>(central.bump_end - central.bump) < block_size &&
+                !new_slab(size_class, central)) {
+                break;
+            }
+            auto* block = reinterpret_cast<FreeBlock*>(central.bump);
+            central.bump += block_size;
+            block->next = head;
+            head = block;
+            moved++;
+        }
+        return moved;
+    }
+
+    // Return `count` blocks starting at `head` (linked through `next`)
+    void give(std::size_t size_class, FreeBlock* head, FreeBlock* tail, std::size_t count) {
+        Central& central = centrals_[size_class];
+        std::lock_guard lock(central.mutex);
+        tail->next = central.head;
+        central.head = head;
+        central.count += count;
+    }
+
+    Stats stats() {
+        Stats out{slab_bytes_.load(std::memory_order_relaxed),
+                  slabs_.load(std::memory_order_relaxed), 0};
+        for (Central& central : centrals_) {
+            std::lock_guard lock(central.mutex);
+            out.shared_free_blocks += central.count;
+        }
+        return out;
+    }
+
+private:
+    struct alignas(64) Central {
+        std::mutex mutex;
+        FreeBlock* head = nullptr;
+        std::size_t count = 0;
+        char* bump = nullptr;
+        char* bump_end = nullptr;
+    };
+
+    // Fresh slabs are handed out lazily so untouched pages never count toward RSS
+    bool new_slab(std::size_t size_class, Central& central) {
+        void* memory = std::aligned_alloc(SLAB_SIZE, SLAB_SIZE);
+        if (memory == nullptr) return false;
+
+        auto* slab = static_cast<Slab*>(memory);
+        slab->size_class = size_class;
+        slab->block_size = SIZE_CLASSES[size_class];
+        central.bump = static_cast<char*>(memory) + SLAB_HEADER;
+        central.bump_end = static_cast<char*>(memory) + SLAB_SIZE;
+        slab_bytes_.fetch_add(SLAB_SIZE, std::memory_order_relaxed);
+        slabs_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::array<Central, NUM_CLASSES> centrals_;
+    std::atomic<std::size_t> slab_bytes_{0};
+    std::atomic<std::size_t> slabs_{0};
+};
+
+// Leaked on purpose: thread caches flush into it from thread_local
+// destructors, which may run after static destruction at exit
+inline SharedPool& shared_pool() {
+    static SharedPool* pool = new SharedPool();
+    return *pool;
+}
+
+class ThreadCache {
+public:
+    ~ThreadCache() {
+        for (std::size_t c = 0; c < NUM_CLASSES; c++) {
+            spill(c, lists_[c].count);
+        }
+    }
+
+    void* allocate(std::size_t size) {
+        std::size_t c = size_class_for(size);
+        if (c == NUM_CLASSES) return nullptr;
+
+        List& list = lists_[c];
+        if (list.head == nullptr) {
+            list.count += shared_pool().take(c, list.head, BATCH);
+            if (list.head == nullptr) return nullptr;
+        }
+        FreeBlock* block = list.head;
+        list.head = block->next;
+        list.count--;
+        return block;
+    }
+
+    void deallocate(void* ptr) {
+        std::size_t c = slab_of(ptr)->size_class;
+        List& list = lists_[c];
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = list.head;
+        list.head = block;
+        if (++list.count > 2 * BATCH) {
+            spill(c, BATCH);
+        }
+    }
+
+private:
+    struct List {
+        FreeBlock* head = nullptr;
+        std::size_t count = 0;
+    };
+
+    void spill(std::size_t c, std::size_t n) {
+        List& list = lists_[c];
+        if (n == 0 || list.head == nullptr) return;
+        FreeBlock* head = list.head;
+        FreeBlock* tail = head;
+        std::size_t moved = 1;
+        while (moved < n && tail->next != nullptr) {
+            tail = tail->next;
+            moved++;
+        }
+        list.head = tail->next;
+        list.count -= moved;
+        shared_pool().give(c, head, tail, moved);
+    }
+
+    std::array<List, NUM_CLASSES> lists_{};
+};
+
+inline ThreadCache& thread_cache() {
+    thread_local ThreadCache cache;
+    return cache;
+}
+
+// Returns nullptr for size 0, sizes above MAX_BLOCK_SIZE, or out of memory
+inline void* allocate(std::size_t size) {
+    if (size == 0) return nullptr;
+    return thread_cache().allocate(size);
+}
+
+// Any thread may free any block; it lands in the caller's cache
+inline void deallocate(void* ptr) {
+    if (ptr != nullptr) thread_cache().deallocate(ptr);
+}
+
+inline std::size_t block_size(const void* ptr) {
+    return ptr != nullptr ? slab_of(ptr)->block_size : 0;
+}
+
+inline Stats stats() {
+    return shared_pool().stats();
+}
+
+}  // namespace benchpool
@@ -39,6 +39,13 @@ for potential_path in [
 if not _lib_path:
     raise RuntimeError("Could not find benchlib shared library")
 
+try:
+    import benchlib_pybind11 as pybind11_lib
+    _HAS_PYBIND11 = True
+except ImportError:
+    _HAS_PYBIND11 = False
+    pybind11_lib = None
+
 
 class DispatchPatterns:
     """Comprehensive dispatch pattern implementations for benchmarking."""
@@ -58,6 +65,7 @@ class DispatchPatterns:
         self._setup_class_getattr()
         self._setup_class_precached()
         self._setup_enum_table()
+        self._setup_pybind11_table()
         
         # Generate access patterns for testing
         self.access_patterns = self._generate_access_patterns()
@@ -271,6 +279,22 @@ class DispatchPatterns:
         """C-side dispatch baseline for comparison."""
         return self.lib.dispatch_c_baseline(func_id, a, b)
     
+    def _setup_pybind11_table(self):
+        """Setup table dispatch over the pybind11-bound dispatch_test_N functions."""
+        self.pybind11_dispatch_table = []
+        if not _HAS_PYBIND11:
+            return
+        for i in range(self.num_functions):
+            self.pybind11_dispatch_table.append(getattr(pybind11_lib, f"dispatch_test_{i}"))
+    
+    def dispatch_pybind11_table(self, func_id: int, a: int = 1, b: int = 2) -> int:
+        """Table dispatch through pybind11 bindings."""
+        return self.pybind11_dispatch_table[func_id](a, b)
+    
+    def dispatch_pybind11_c_baseline(self, func_id: int, a: int = 1, b: int = 2) -> int:
+        """C-side dispatch baseline called through pybind11."""
+        return pybind11_lib.dispatch_c_baseline(func_id, a, b)
+    
     def _generate_access_patterns(self) -> Dict[str, List[int]]:
         """Generate realistic access patterns for testing."""
         random.seed(42)  # Reproducible patterns
@@ -317,7 +341,7 @@ class DispatchPatterns:
             'dict_get',
             'class_getattr',
             'global_if_elif'
-        ]
+        ] + (['pybind11_c_baseline', 'pybind11_table'] if _HAS_PYBIND11 else [])
     
     def get_dispatch_function(self, pattern_name: str) -> Callable:
         """Get dispatch function by pattern name."""
@@ -329,6 +353,8 @@ class DispatchPatterns:
             'dict_get': self.dispatch_dict_get,
             'class_getattr': self.dispatch_class_getattr,
             'global_if_elif': self.dispatch_global_if_elif,
+            'pybind11_c_baseline': self.dispatch_pybind11_c_baseline,
+            'pybind11_table': self.dispatch_pybind11_table,
         }
         
         if pattern_name not in dispatch_map:
@@ -381,6 +407,40 @@ class DispatchBenchmark:
             'calls_per_second': 1e9 / ns_per_call if ns_per_call > 0 else 0
         }
     
+    def benchmark_batch_dispatch(self, access_pattern: List[int],
+                                 iterations: int = 1000) -> Dict[str, Any]:
+        """Benchmark pybind11 dispatch_batch: one boundary crossing per access pattern."""
+        if not _HAS_PYBIND11:
+            return {'pattern': 'pybind11_batch', 'error': 'benchlib_pybind11 not available'}
+        
+        from array import array
+        n = len(access_pattern)
+        func_ids = array('i', access_pattern)
+        a = array('i', [1]) * n
+        b = array('i', [2]) * n
+        out = array('i', bytes(4 * n))
+        
+        pybind11_lib.dispatch_batch(func_ids, a, b, out)  # Warmup
+        assert out.tolist() == [3 + func_id for func_id in access_pattern]
+        
+        start_time = time.perf_counter_ns()
+        for _ in range(iterations):
+            pybind11_lib.dispatch_batch(func_ids, a, b, out)
+        end_time = time.perf_counter_ns()
+        
+        total_calls = n * iterations
+        total_time_ns = end_time - start_time
+        ns_per_call = total_time_ns / total_calls
+        
+        return {
+            'pattern': 'pybind11_batch',
+            'access_pattern': f"{n} calls",
+            'total_calls': total_calls,
+            'total_time_ns': total_time_ns,
+            'ns_per_call': ns_per_call,
+            'calls_per_second': 1e9 / ns_per_call if ns_per_call > 0 else 0
+        }
+    
     def benchmark_all_patterns(self, access_pattern_name: str = 'random', 
                               iterations: int = 100) -> Dict[str, Dict[str, Any]]:
         """Benchmark all dispatch patterns with specified access pattern."""
@@ -400,6 +460,10 @@ class DispatchBenchmark:
                 print(f"Error benchmarking {pattern_name}: {e}")
                 results[pattern_name] = {'error': str(e)}
         
+        if _HAS_PYBIND11:
+            print(f"Benchmarking pybind11_batch with {access_pattern_name} access...")
+            results['pybind11_batch'] = self.benchmark_batch_dispatch(access_pattern, iterations)
+        
         return results
     
     def compare_patterns(self, results: Dict[str, Dict[str, Any]], 
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Test that pybind11 output buffers are borrowed, never silently converted.
+
+Results written into a converted copy would be lost, so the batch, dispatch
+and GIL-releasing wrappers must reject any `out` that is not a writable,
+contiguous buffer of exactly the result type.
+"""
+
+import sys
+from array import array
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).parent.parent / "implementations" / "pybind11_impl"))
+
+try:
+    import benchlib_pybind11
+    _HAS_PYBIND11_LIB = True
+except ImportError as e:
+    _HAS_PYBIND11_LIB = False
+    print(f"❌ Failed to import pybind11 module: {e}")
+    sys.exit(1)
+
+
+def expect_rejected(func, *args, what):
+    """Call func(*args) and fail unless it raises."""
+    try:
+        func(*args)
+    except (RuntimeError, TypeError, ValueError):
+        return
+    raise AssertionError(f"{func.__name__} accepted {what}")
+
+
+def test_dispatch_batch_out():
+    """dispatch_batch writes into a matching out and rejects mismatched ones."""
+    print("Testing dispatch_batch output buffers...")
+    
+    n = 8
+    func_ids = array('i', [i % 4 for i in range(n)])
+    a = array('i', [1]) * n
+    b = array('i', [2]) * n
+    
+    out = array('i', bytes(4 * n))
+    benchlib_pybind11.dispatch_batch(func_ids, a, b, out)
+    assert out.tolist() == [3 + func_id for func_id in func_ids]
+    
+    mismatched = {
+        "a float64 out": array('d', bytes(8 * n)),
+        "an int64 out": array('q', bytes(8 * n)),
+        "a read-only out": bytes(4 * n),
+        "a list out": [0] * n,
+        "a short out": array('i', bytes(4 * (n - 1))),
+        "a strided out": memoryview(array('i', bytes(8 * n)))[::2],
+    }
+    for what, bad_out in mismatched.items():
+        expect_rejected(benchlib_pybind11.dispatch_batch, func_ids, a, b, bad_out, what=what)
+    
+    print("✅ dispatch_batch rejects mismatched out buffers")
+
+
+def test_dispatch_batch_bad_id():
+    """An out-of-range id raises IndexError before anything is written."""
+    print("Testing dispatch_batch id validation...")
+    
+    func_ids = array('i', [0, 1, 10_000, 2])
+    a = array('i', [1]) * 4
+    b = array('i', [2]) * 4
+    out = array('i', [7]) * 4
+    try:
+        benchlib_pybind11.dispatch_batch(func_ids, a, b, out)
+    except IndexError:
+        pass
+    else:
+        raise AssertionError("dispatch_batch accepted an out-of-range id")
+    assert out.tolist() == [7] * 4, "out was partly overwritten"
+    
+    print("✅ dispatch_batch leaves out untouched on a bad id")
+
+
+def test_binary_batch_out():
+    """The element-wise batch wrappers apply the same output check."""
+    print("Testing batch wrapper output buffers...")
+    
+    a = array('d', [1.0, 2.0, 3.0])
+    b = array('d', [4.0, 5.0, 6.0])
+    out = array('d', bytes(8 * 3))
+    benchlib_pybind11.add_double_batch(a, b, out)
+    assert out.tolist() == [5.0, 7.0, 9.0]
+    
+    # Inputs may convert; outputs may not
+    benchlib_pybind11.add_double_batch([1, 2, 3], [4, 5, 6], out)
+    assert out.tolist() == [5.0, 7.0, 9.0]
+    expect_rejected(benchlib_pybind11.add_double_batch, a, b, array('f', bytes(4 * 3)),
+                    what="a float32 out")
+    expect_rejected(benchlib_pybind11.add_double_batch, a, b, [0.0] * 3, what="a list out")
+    expect_rejected(benchlib_pybind11.add_int32_batch, array('i', [1]), array('i', [2, 3]),
+                    array('i', bytes(8)), what="mismatched input lengths")
+    
+    print("✅ Batch wrappers reject mismatched out buffers")
+
+
+def test_nogil_out():
+    """GIL-releasing in-place kernels refuse buffers they would have to copy."""
+    print("Testing GIL-releasing output buffers...")
+    
+    data = array('d', [1.0, 2.0])
+    benchlib_pybind11.scale_doubles_inplace_nogil(data, 2.0)
+    assert data.tolist() == [2.0, 4.0]
+    expect_rejected(benchlib_pybind11.scale_doubles_inplace_nogil, [1.0, 2.0], 2.0,
+                    what="a list")
+    expect_rejected(benchlib_pybind11.scale_doubles_inplace_nogil, array('f', [1.0]), 2.0,
+                    what="a float32 buffer")
+    
+    print("✅ GIL-releasing kernels reject mismatched buffers")
+
+
+if __name__ == "__main__":
+    print("🧪 Testing pybind11 output buffer validation...")
+    
+    try:
+        test_dispatch_batch_out()
+        test_dispatch_batch_bad_id()
+        test_binary_batch_out()
+        test_nogil_out()
+        
+        print("\n🎉 All tests passed!")
+        
+    except Exception as e:
+        print(f"❌ Test failed: {e}")
+        import traceback
+        traceback.print_exc()
+        sys.exit(1)
@@ -28,6 +28,7 @@ def test_matrix_multiplication_crossover():
         'ctypes': analyzer.create_ctypes_matmul_benchmark(),
         'cffi': analyzer.create_cffi_matmul_benchmark(),
         'pybind11': analyzer.create_pybind11_matmul_benchmark(),
+        'pybind11_blocked': analyzer.create_pybind11_blocked_matmul_benchmark(),
     }
     
     # Test with smaller sizes for demonstration
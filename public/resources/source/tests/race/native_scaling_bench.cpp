@@ -0,0 +1,577 @@
+/*
+ * native_scaling_bench.cpp - Thread-count scaling of benchlib kernels and
+ * threadtest primitives with no Python in the process
+ *
+ * Every scaling number from run_matrix_benchmarks.py, test_true_parallelism.py
+ * or dispatch_bench.py includes Python thread start-up, the GIL (or its
+ * absence) and the FFI call. This driver runs the same native code from
+ * pinned std::threads instead, so it is the upper bound each FFI result can
+ * be compared against:
+ *
+ *   reductions  sum_doubles_readonly / dot_product from benchlib.c
+ *   gemm        matrix_multiply_blocked from benchlib.c
+ *   counters    atomic / sharded / mutex / adaptive / combining from threadtest
+ *   queues      the threadtest MPMC channel
+ *
+ * Scaling is weak: each thread does the same work at every thread count, so
+ * ideal throughput grows linearly. Thread i is pinned to the i-th CPU of the
+ * process's affinity mask (wrapping when oversubscribed) and allocates and
+ * first-touches its own buffers after pinning, so under the default Linux
+ * policy its pages sit on its own NUMA node without a libnuma dependency.
+ *
+ * Usage:
+ *   native_scaling_bench [--threads 1,2,4] [--max-threads N] [--samples S]
+ *                        [--kernels name,...] [--scale X] [--no-pin] [--out FILE]
+ *
+ * JSON in the framework's results layout ("sample_data" holds ns per op for
+ * every kernel@threads, so viz_bench_from_json.py can plot it) goes to
+ * stdout or FILE; a summary table goes to stderr.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "native_timer.hpp"
+
+extern "C" {
+// benchlib.c: the kernels the pybind11 module wraps
+double sum_doubles_readonly(const double* arr, std::size_t n);
+double dot_product(const double* a, const double* b, std::size_t n);
+void matrix_multiply_blocked(const double* a, const double* b, double* c,
+                             std::size_t m, std::size_t n, std::size_t k);
+const char* matrix_multiply_blocked_kernel();
+
+// threadtest.cpp
+long atomic_increment(int iterations);
+long get_atomic_counter();
+long sharded_increment(int iterations);
+long get_sharded_counter();
+long safe_increment(int iterations);
+long get_safe_counter();
+long adaptive_increment(int iterations);
+long get_adaptive_counter();
+long combining_increment(int iterations);
+long get_combining_counter();
+void reset_counters();
+void* channel_create(long capacity);
+void channel_destroy(void* handle);
+int channel_try_push(void* handle, long value);
+int channel_try_pop(void* handle, long* out);
+}
+
+namespace {
+
+// ============================================================================
+// TOPOLOGY - Affinity mask, pinning and NUMA node lookup
+// ============================================================================
+
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned cpu = 0; cpu < n; cpu++) cpus.push_back(static_cast<int>(cpu));
+    }
+    return cpus;
+}
+
+// Returns false where pinning is unsupported (macOS has no hard affinity)
+bool pin_to_cpu(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Node count from sysfs; 1 when the machine (or OS) does not expose NUMA
+int numa_node_count() {
+    int nodes = 0;
+    char path[64];
+    for (;;) {
+        std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", nodes);
+        if (access(path, F_OK) != 0) break;
+        nodes++;
+    }
+    return std::max(nodes, 1);
+}
+
+int cpu_numa_node(int cpu, int nodes) {
+    char path[96];
+    for (int node = 0; node < nodes; node++) {
+        std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpu%d", node, cpu);
+        if (access(path, F_OK) == 0) return node;
+    }
+    return 0;
+}
+
+// ============================================================================
+// KERNELS - One timed run() per sample on every worker
+// ============================================================================
+
+// prepare() runs on the pinned worker before the first sample, so anything
+// it allocates is first-touched on that worker's node. run() returns the
+// ops it performed; verify() checks the shared result after the last sample.
+class Kernel {
+public:
+    virtual ~Kernel() = default;
+    virtual const char* name() const = 0;
+    virtual const char* unit() const = 0;
+    virtual void setup(int threads) { (void)threads; }
+    virtual void prepare(int thread) { (void)thread; }
+    virtual long run(int thread) = 0;
+    virtual bool verify(long runs_per_thread) const { (void)runs_per_thread; return true; }
+    virtual void teardown() {}
+};
+
+// Keeps reductions from being discarded
+std::atomic<double> result_sink{0.0};
+
+// Per-thread buffers, indexed by worker; each worker fills only its own
+struct Buffers {
+    std::vector<double> a, b, c;
+};
+
+class BufferKernel : public Kernel {
+public:
+    void setup(int threads) override { buffers_.assign(static_cast<std::size_t>(threads), {}); }
+    void teardown() override { buffers_.clear(); }
+
+protected:
+    std::vector<Buffers> buffers_;
+};
+
+class SumKernel : public BufferKernel {
+public:
+    explicit SumKernel(std::size_t n) : n_(n) {}
+    const char* name() const override { return "sum_doubles"; }
+    const char* unit() const override { return "element"; }
+    void prepare(int thread) override { buffers_[thread].a.assign(n_, 1.0); }
+    long run(int thread) override {
+        result_sink.store(sum_doubles_readonly(buffers_[thread].a.data(), n_), std::memory_order_relaxed);
+        return static_cast<long>(n_);
+    }
+
+private:
+    std::size_t n_;
+};
+
+class DotKernel : public BufferKernel {
+public:
+    explicit DotKernel(std::size_t n) : n_(n) {}
+    const char* name() const override { return "dot_product"; }
+    const char* unit() const override { return "element"; }
+    void prepare(int thread) override {
+        buffers_[thread].a.assign(n_, 1.0);
+        buffers_[thread].b.assign(n_, 2.0);
+    }
+    long run(int thread) override {
+        const Buffers& buf = buffers_[thread];
+        result_sink.store(dot_product(buf.a.data(), buf.b.data(), n_), std::memory_order_relaxed);
+        return static_cast<long>(n_);
+    }
+
+private:
+    std::size_t n_;
+};
+
+// Each thread multiplies its own square matrices (B included), so no
+// operand is read across nodes
+class GemmKernel : public BufferKernel {
+public:
+    explicit GemmKernel(std::size_t dim) : dim_(dim) {}
+    const char* name() const override { return "gemm"; }
+    const char* unit() const override { return "flop"; }
+    void prepare(int thread) override {
+        Buffers& buf = buffers_[thread];
+        buf.a.assign(dim_ * dim_, 1.0);
+        buf.b.assign(dim_ * dim_, 0.5);
+        buf.c.assign(dim_ * dim_, 0.0);
+    }
+    long run(int thread) override {
+        Buffers& buf = buffers_[thread];
+        matrix_multiply_blocked(buf.a.data(), buf.b.data(), buf.c.data(), dim_, dim_, dim_);
+        return static_cast<long>(2 * dim_ * dim_ * dim_);
+    }
+    bool verify(long) const override {
+        // Every entry of (1.0) x (0.5) is 0.5 * dim
+        const double expected = 0.5 * static_cast<double>(dim_);
+        for (const Buffers& buf : buffers_) {
+            if (buf.c.size() != dim_ * dim_) return false;
+            if (!std::ranges::all_of(buf.c, [expected](double v) { return v == expected; })) return false;
+        }
+        return true;
+    }
+
+private:
+    std::size_t dim_;
+};
+
+// Threadtest counter families; the count must come out exact
+struct CounterOps {
+    const char* name;
+    long (*increment)(int);
+    long (*total)();
+    int batch;  // Increments per call: one call per op for the locked families
+};
+
+class CounterKernel : public Kernel {
+public:
+    CounterKernel(CounterOps ops, long iterations) : ops_(ops), iterations_(iterations) {}
+    const char* name() const override { return ops_.name; }
+    const char* unit() const override { return "increment"; }
+    void setup(int threads) override {
+        threads_ = threads;
+        reset_counters();
+    }
+    long run(int) override {
+        for (long done = 0; done < iterations_; done += ops_.batch) {
+            ops_.increment(static_cast<int>(std::min<long>(ops_.batch, iterations_ - done)));
+        }
+        return iterations_;
+    }
+    bool verify(long runs_per_thread) const override {
+        return ops_.total() == threads_ * iterations_ * runs_per_thread;
+    }
+
+private:
+    CounterOps ops_;
+    long iterations_;
+    long threads_ = 0;
+};
+
+// Push then pop one value per op on one shared channel; at most `threads`
+// values are ever queued, so neither side waits long
+class ChannelKernel : public Kernel {
+public:
+    explicit ChannelKernel(long iterations) : iterations_(iterations) {}
+    const char* name() const override { return "channel"; }
+    const char* unit() const override { return "push+pop"; }
+    void setup(int threads) override {
+        threads_ = threads;
+        channel_ = channel_create(1024);
+        pushed_.store(0);
+        popped_.store(0);
+        pushes_.store(0);
+        pops_.store(0);
+    }
+    long run(int thread) override {
+        long pushed = 0, popped = 0, pushes = 0, pops = 0;
+        for (long i = 0; i < iterations_; i++) {
+            long value = thread * iterations_ + i;
+            while (channel_try_push(channel_, value) != 1) std::this_thread::yield();
+            pushed += value;
+            pushes++;
+            while (channel_try_pop(channel_, &value) != 1) std::this_thread::yield();
+            popped += value;
+            pops++;
+        }
+        pushed_.fetch_add(pushed, std::memory_order_relaxed);
+        popped_.fetch_add(popped, std::memory_order_relaxed);
+        pushes_.fetch_add(pushes, std::memory_order_relaxed);
+        pops_.fetch_add(pops, std::memory_order_relaxed);
+        return iterations_;
+    }
+    // Equal sums alone would pass a lost value offset by a duplicated one
+    bool verify(long runs_per_thread) const override {
+        long expected_ops = threads_ * iterations_ * runs_per_thread;
+        return pushes_.load() == expected_ops && pops_.load() == expected_ops &&
+               pushed_.load() == popped_.load();
+    }
+    void teardown() override {
+        channel_destroy(channel_);
+        channel_ = nullptr;
+    }
+
+private:
+    long iterations_;
+    long threads_ = 0;
+    void* channel_ = nullptr;
+    std::atomic<long> pushed_{0};  // Sums of the values, per side
+    std::atomic<long> popped_{0};
+    std::atomic<long> pushes_{0};  // Successful calls, per side
+    std::atomic<long> pops_{0};
+};
+
+std::vector<std::unique_ptr<Kernel>> make_kernels(double scale) {
+    auto scaled = [scale](double base) { return std::max<long>(1, static_cast<long>(base * scale)); };
+    std::vector<std::unique_ptr<Kernel>> kernels;
+    kernels.push_back(std::make_unique<SumKernel>(scaled(1 << 20)));
+    kernels.push_back(std::make_unique<DotKernel>(scaled(1 << 20)));
+    kernels.push_back(std::make_unique<GemmKernel>(std::max<long>(8, scaled(192))));
+    kernels.push_back(std::make_unique<CounterKernel>(
+        CounterOps{"atomic_counter", atomic_increment, get_atomic_counter, 1000}, scaled(200000)));
+    kernels.push_back(std::make_unique<CounterKernel>(
+        CounterOps{"sharded_counter", sharded_increment, get_sharded_counter, 1000}, scaled(200000)));
+    kernels.push_back(std::make_unique<CounterKernel>(
+        CounterOps{"mutex_counter", safe_increment, get_safe_counter, 1}, scaled(50000)));
+    kernels.push_back(std::make_unique<CounterKernel>(
+        CounterOps{"adaptive_counter", adaptive_increment, get_adaptive_counter, 1}, scaled(50000)));
+    kernels.push_back(std::make_unique<CounterKernel>(
+        CounterOps{"combining_counter", combining_increment, get_combining_counter, 1}, scaled(50000)));
+    kernels.push_back(std::make_unique<ChannelKernel>(scaled(50000)));
+    return kernels;
+}
+
+// ============================================================================
+// DRIVER - Pinned workers, barrier-delimited samples
+// ============================================================================
+
+struct ScalingResult {
+    std::string kernel;
+    std::string unit;
+    int threads = 0;
+    std::vector<int> cpus;
+    std::vector<int> nodes;
+    bool pinned = false;
+    long ops_per_sample = 0;
+    std::vector<double> ns_per_op;  // One entry per sample: wall time / total ops
+    double median_ns_per_op = 0.0;
+    double ops_per_sec = 0.0;
+    double speedup = 1.0;     // Throughput over the first thread count's per-thread rate
+    double efficiency = 1.0;  // speedup / threads
+    bool verified = false;
+};
+
+// One warm-up run, then `samples` timed runs. A sample is the wall time from
+// the start barrier opening to the last worker reaching the end barrier.
+ScalingResult run_scaling(Kernel& kernel, int threads, int samples, bool pin,
+                          const std::vector<int>& cpus, int nodes) {
+    ScalingResult result;
+    result.kernel = kernel.name();
+    result.unit = kernel.unit();
+    result.threads = threads;
+    result.cpus.resize(static_cast<std::size_t>(threads));
+    result.nodes.resize(static_cast<std::size_t>(threads));
+
+    kernel.setup(threads);
+    std::vector<std::uint64_t> wall_ns;
+    std::uint64_t started_at = 0;
+    auto on_start = [&]() noexcept { started_at = benchtime::monotonic_raw_ns(); };
+    auto on_end = [&]() noexcept { wall_ns.push_back(benchtime::monotonic_raw_ns() - started_at); };
+    std::barrier start(threads, on_start);
+    std::barrier end(threads, on_end);
+    std::atomic<long> ops{0};
+    std::atomic<int> pinned{0};
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        int cpu = cpus[static_cast<std::size_t>(t) % cpus.size()];
+        result.cpus[t] = cpu;
+        result.nodes[t] = cpu_numa_node(cpu, nodes);
+        workers.emplace_back([&, t, cpu] {
+            if (pin && pin_to_cpu(cpu)) pinned.fetch_add(1, std::memory_order_relaxed);
+            kernel.prepare(t);
+            for (int s = -1; s < samples; s++) {
+                start.arrive_and_wait();
+                long done = kernel.run(t);
+                if (s == 0) ops.fetch_add(done, std::memory_order_relaxed);
+                end.arrive_and_wait();
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    result.pinned = pinned.load() == threads;
+    result.verified = kernel.verify(samples + 1);
+    kernel.teardown();
+
+    result.ops_per_sample = ops.load();
+    wall_ns.erase(wall_ns.begin());  // Warm-up
+    for (std::uint64_t ns : wall_ns) {
+        result.ns_per_op.push_back(static_cast<double>(ns) / static_cast<double>(result.ops_per_sample));
+    }
+    std::vector<double> sorted = result.ns_per_op;
+    std::sort(sorted.begin(), sorted.end());
+    result.median_ns_per_op = benchtime::sorted_quantile(sorted, 0.50);
+    result.ops_per_sec = result.median_ns_per_op > 0 ? 1e9 / result.median_ns_per_op : 0.0;
+    return result;
+}
+
+// ============================================================================
+// OUTPUT - JSON results and a stderr summary
+// ============================================================================
+
+void write_json(std::FILE* out, const std::vector<ScalingResult>& results, int cpu_count,
+                int nodes, int samples, double scale, bool pin) {
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::fprintf(out, "{\n  \"timestamp\": \"%s\",\n", timestamp);
+    std::fprintf(out, "  \"methodology\": \"native_thread_scaling\",\n");
+    std::fprintf(out, "  \"environment\": {\"cpus\": %d, \"numa_nodes\": %d, \"clock\": \"clock_monotonic_raw\", "
+                      "\"gemm_kernel\": \"%s\", \"samples\": %d, \"scale\": %g, \"pin\": %s},\n",
+                 cpu_count, nodes, matrix_multiply_blocked_kernel(), samples, scale, pin ? "true" : "false");
+
+    std::fprintf(out, "  \"sample_data\": {");
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const ScalingResult& r = results[i];
+        std::fprintf(out, "%s\n    \"%s@%dt\": [", i ? "," : "", r.kernel.c_str(), r.threads);
+        for (std::size_t s = 0; s < r.ns_per_op.size(); s++) {
+            std::fprintf(out, "%s%.6g", s ? ", " : "", r.ns_per_op[s]);
+        }
+        std::fprintf(out, "]");
+    }
+    std::fprintf(out, "\n  },\n  \"scaling\": [");
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const ScalingResult& r = results[i];
+        std::fprintf(out, "%s\n    {\"kernel\": \"%s\", \"unit\": \"%s\", \"threads\": %d, \"pinned\": %s, "
+                          "\"ops_per_sample\": %ld, \"median_ns_per_op\": %.6g, \"ops_per_sec\": %.6g, "
+                          "\"speedup\": %.4f, \"efficiency\": %.4f, \"verified\": %s, \"cpus\": [",
+                     i ? "," : "", r.kernel.c_str(), r.unit.c_str(), r.threads, r.pinned ? "true" : "false",
+                     r.ops_per_sample, r.median_ns_per_op, r.ops_per_sec, r.speedup, r.efficiency,
+                     r.verified ? "true" : "false");
+        for (std::size_t t = 0; t < r.cpus.size(); t++) std::fprintf(out, "%s%d", t ? ", " : "", r.cpus[t]);
+        std::fprintf(out, "], \"numa_nodes\": [");
+        for (std::size_t t = 0; t < r.nodes.size(); t++) std::fprintf(out, "%s%d", t ? ", " : "", r.nodes[t]);
+        std::fprintf(out, "]}");
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+}
+
+void print_summary(const std::vector<ScalingResult>& results) {
+    std::fprintf(stderr, "  %-18s %7s %14s %14s %8s %6s %s\n",
+                 "kernel", "threads", "ns/op", "ops/s", "speedup", "eff", "ok");
+    for (const ScalingResult& r : results) {
+        std::fprintf(stderr, "  %-18s %7d %14.3f %14.4g %8.2f %6.2f %s\n", r.kernel.c_str(), r.threads,
+                     r.median_ns_per_op, r.ops_per_sec, r.speedup, r.efficiency, r.verified ? "yes" : "NO");
+    }
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--threads 1,2,4] [--max-threads N] [--samples S]\n"
+                 "          [--kernels name,...] [--scale X] [--no-pin] [--out FILE]\n",
+                 argv0);
+}
+
+std::vector<std::string> split_list(const char* text) {
+    std::vector<std::string> items;
+    std::string current;
+    for (const char* p = text; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            if (!current.empty()) items.push_back(current);
+            current.clear();
+            if (*p == '\0') break;
+        } else {
+            current += *p;
+        }
+    }
+    return items;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> cpus = allowed_cpus();
+    int max_threads = static_cast<int>(cpus.size());
+    std::vector<int> thread_counts;
+    std::vector<std::string> kernel_names;
+    int samples = 15;
+    double scale = 1.0;
+    bool pin = true;
+    const char* out_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) {
+            for (const std::string& item : split_list(argv[++i])) thread_counts.push_back(std::atoi(item.c_str()));
+        } else if (arg == "--max-threads" && has_value) {
+            max_threads = std::atoi(argv[++i]);
+        } else if (arg == "--samples" && has_value) {
+            samples = std::atoi(argv[++i]);
+        } else if (arg == "--kernels" && has_value) {
+            kernel_names = split_list(argv[++i]);
+        } else if (arg == "--scale" && has_value) {
+            scale = std::atof(argv[++i]);
+        } else if (arg == "--no-pin") {
+            pin = false;
+        } else if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Default sweep: powers of two up to max_threads, plus max_threads itself
+    if (thread_counts.empty()) {
+        for (int t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+        thread_counts.push_back(max_threads);
+    }
+    bool bad_threads = std::ranges::any_of(thread_counts, [](int t) { return t <= 0; });
+    if (bad_threads || samples <= 0 || scale <= 0.0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::unique_ptr<Kernel>> kernels = make_kernels(scale);
+    for (const std::string& name : kernel_names) {
+        bool known = std::ranges::any_of(kernels, [&](const auto& k) { return name == k->name(); });
+        if (!known) {
+            std::fprintf(stderr, "unknown kernel '%s'; available:", name.c_str());
+            for (const auto& k : kernels) std::fprintf(stderr, " %s", k->name());
+            std::fprintf(stderr, "\n");
+            return 2;
+        }
+    }
+
+    const int nodes = numa_node_count();
+    std::vector<ScalingResult> results;
+    for (const auto& kernel : kernels) {
+        if (!kernel_names.empty() && std::ranges::find(kernel_names, kernel->name()) == kernel_names.end()) {
+            continue;
+        }
+        double base_ops_per_sec = 0.0;
+        for (int threads : thread_counts) {
+            ScalingResult r = run_scaling(*kernel, threads, samples, pin, cpus, nodes);
+            if (base_ops_per_sec == 0.0) base_ops_per_sec = r.ops_per_sec / threads;
+            r.speedup = base_ops_per_sec > 0 ? r.ops_per_sec / base_ops_per_sec : 0.0;
+            r.efficiency = r.speedup / threads;
+            results.push_back(std::move(r));
+        }
+    }
+
+    std::FILE* out = stdout;
+    if (out_path != nullptr) {
+        out = std::fopen(out_path, "w");
+        if (out == nullptr) {
+            std::perror(out_path);
+            return 1;
+        }
+    }
+    write_json(out, results, static_cast<int>(cpus.size()), nodes, samples, scale, pin);
+    if (out != stdout) std::fclose(out);
+    print_summary(results);
+
+    bool all_verified = std::ranges::all_of(results, [](const ScalingResult& r) { return r.verified; });
+    return all_verified ? 0 : 1;
+}
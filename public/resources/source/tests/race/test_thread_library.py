@@ -5,14 +5,368 @@ Tests the threadtest.so library with both racing and non-racing functions.
 """
 
 import unittest
+import asyncio
 import ctypes
+import json
 import threading
 import time
 import os
+import random
 import subprocess
+import sys
+import tempfile
 from pathlib import Path
 from concurrent.futures import ThreadPoolExecutor
 
+import threadtest_loader
+
+
+class ThreadtestStats(ctypes.Structure):
+    """Mirror of the ThreadtestStats snapshot filled by get_all_stats."""
+    _fields_ = [(name, ctypes.c_long) for name in (
+        "timestamp_ns", "reset_epoch", "global_counter", "safe_counter", "atomic_counter",
+        "sharded_counter", "adaptive_counter", "combining_counter", "jthread_counter",
+        "shared_data", "balance", "unsafe_balance", "fast_bank_balance",
+    )]
+
+
+class SyncBenchStats(ctypes.Structure):
+    """Mirror of the SyncBenchStats struct filled by run_sync_benchmark."""
+    _fields_ = [
+        ("primitive_id", ctypes.c_int),
+        ("threads", ctypes.c_int),
+        ("total_ops", ctypes.c_long),
+        ("elapsed_seconds", ctypes.c_double),
+        ("ops_per_sec", ctypes.c_double),
+        ("p50_acquire_ns", ctypes.c_double),
+        ("p99_acquire_ns", ctypes.c_double),
+        ("max_acquire_ns", ctypes.c_double),
+    ]
+
+
+class PoolStats(ctypes.Structure):
+    """Mirror of the PoolStats struct filled by pool_get_stats."""
+    _fields_ = [
+        ("slab_bytes", ctypes.c_size_t),
+        ("slabs", ctypes.c_size_t),
+        ("shared_free_blocks", ctypes.c_size_t),
+        ("max_block_size", ctypes.c_size_t),
+    ]
+
+
+class AllocBenchStats(ctypes.Structure):
+    """Mirror of the AllocBenchStats struct filled by run_alloc_benchmark."""
+    _fields_ = [
+        ("allocator", ctypes.c_int),
+        ("threads", ctypes.c_int),
+        ("total_ops", ctypes.c_long),
+        ("elapsed_seconds", ctypes.c_double),
+        ("ops_per_sec", ctypes.c_double),
+        ("p50_alloc_ns", ctypes.c_double),
+        ("p99_alloc_ns", ctypes.c_double),
+        ("p50_free_ns", ctypes.c_double),
+        ("p99_free_ns", ctypes.c_double),
+        ("rss_before_bytes", ctypes.c_long),
+        ("rss_after_bytes", ctypes.c_long),
+    ]
+
+
+class CounterStats(ctypes.Structure):
+    """Mirror of the CounterStats struct filled by counters_read."""
+    _fields_ = [
+        ("calls", ctypes.c_uint64),
+        ("cycles", ctypes.c_uint64),
+        ("instructions", ctypes.c_uint64),
+        ("llc_misses", ctypes.c_uint64),
+        ("branch_misses", ctypes.c_uint64),
+        ("time_enabled_ns", ctypes.c_uint64),
+        ("time_running_ns", ctypes.c_uint64),
+        ("threads", ctypes.c_uint32),
+        ("ipc", ctypes.c_double),
+        ("llc_misses_per_kinstr", ctypes.c_double),
+        ("branch_misses_per_kinstr", ctypes.c_double),
+    ]
+
+
+# Counter regions reserved by the built-in benchmarks; user ids start at 8
+COUNTER_REGIONS = {"sync_bench": 0, "alloc_bench": 1}
+COUNTER_REGION_USER = 8
+
+
+# Allocator ids accepted by run_alloc_benchmark
+BENCH_ALLOCATORS = {"malloc": 0, "pool": 1}
+
+
+class RwBenchStats(ctypes.Structure):
+    """Mirror of the RwBenchStats struct filled by run_rw_benchmark."""
+    _fields_ = [
+        ("primitive_id", ctypes.c_int),
+        ("threads", ctypes.c_int),
+        ("write_permille", ctypes.c_int),
+        ("total_reads", ctypes.c_long),
+        ("total_writes", ctypes.c_long),
+        ("elapsed_seconds", ctypes.c_double),
+        ("ops_per_sec", ctypes.c_double),
+        ("p50_read_ns", ctypes.c_double),
+        ("p99_read_ns", ctypes.c_double),
+        ("p50_write_ns", ctypes.c_double),
+        ("p99_write_ns", ctypes.c_double),
+        ("torn_reads", ctypes.c_long),
+        ("read_retries", ctypes.c_long),
+    ]
+
+
+# Primitive ids accepted by run_rw_benchmark
+RW_PRIMITIVES = {"shared_mutex": 0, "seqlock": 1, "rcu": 2}
+
+
+# Primitive ids accepted by run_sync_benchmark
+SYNC_PRIMITIVES = {
+    "mutex": 0,
+    "shared_read": 1,
+    "shared_write": 2,
+    "atomic": 3,
+    "semaphore": 4,
+    "barrier": 5,
+    "sharded": 6,
+    "buffer_mutex": 7,
+    "buffer_arena": 8,
+    "adaptive": 9,
+    "combining": 10,
+}
+
+
+class CombiningStats(ctypes.Structure):
+    """Mirror of the CombiningStats struct filled by combining_get_stats."""
+    _fields_ = [
+        ("operations", ctypes.c_long),
+        ("passes", ctypes.c_long),
+        ("max_batch", ctypes.c_long),
+    ]
+
+
+class ObjectHandle(ctypes.Structure):
+    """Mirror of the ObjectHandle filled by object_pool_acquire."""
+    _fields_ = [
+        ("slot", ctypes.c_long),
+        ("payload", ctypes.c_void_p),
+    ]
+
+
+class ObjectPoolStats(ctypes.Structure):
+    """Mirror of the ObjectPoolStats struct filled by object_pool_get_stats."""
+    _fields_ = [(name, ctypes.c_long) for name in (
+        "capacity", "payload_bytes", "in_use", "parked", "shared_acquires", "steals",
+        "waits", "timeouts",
+    )]
+
+
+class ObjectPoolBenchStats(ctypes.Structure):
+    """Mirror of the ObjectPoolBenchStats struct filled by run_object_pool_benchmark."""
+    _fields_ = [
+        ("mode", ctypes.c_int),
+        ("threads", ctypes.c_int),
+        ("capacity", ctypes.c_long),
+        ("total_ops", ctypes.c_long),
+        ("elapsed_seconds", ctypes.c_double),
+        ("ops_per_sec", ctypes.c_double),
+        ("p50_acquire_ns", ctypes.c_double),
+        ("p99_acquire_ns", ctypes.c_double),
+        ("p50_release_ns", ctypes.c_double),
+        ("p99_release_ns", ctypes.c_double),
+        ("cache_hit_rate", ctypes.c_double),
+        ("steals", ctypes.c_long),
+        ("waits", ctypes.c_long),
+        ("overlaps", ctypes.c_long),
+    ]
+
+
+# Modes accepted by run_object_pool_benchmark
+OBJECT_POOL_BENCH_MODES = {"semaphore": 0, "shared": 1, "cached": 2}
+
+
+class LockSiteStats(ctypes.Structure):
+    """Mirror of the LockSiteStats struct filled by lock_profiler_get_site."""
+    _fields_ = [
+        ("name", ctypes.c_char * 32),
+        ("acquisitions", ctypes.c_long),
+        ("contended", ctypes.c_long),
+        ("wait_mean_ns", ctypes.c_double),
+        ("wait_p50_ns", ctypes.c_double),
+        ("wait_p99_ns", ctypes.c_double),
+        ("wait_max_ns", ctypes.c_double),
+        ("hold_mean_ns", ctypes.c_double),
+        ("hold_p50_ns", ctypes.c_double),
+        ("hold_p99_ns", ctypes.c_double),
+        ("hold_max_ns", ctypes.c_double),
+    ]
+
+
+class ShmStats(ctypes.Structure):
+    """Mirror of the ShmStats struct filled by shm_get_stats."""
+    _fields_ = [(name, ctypes.c_long) for name in (
+        "attached_processes", "atomic_counter", "safe_counter", "sharded_counter",
+        "bank_balance", "channel_size", "ledger_accounts", "ledger_total",
+    )]
+
+
+class ShmBenchStats(ctypes.Structure):
+    """Mirror of the ShmBenchStats struct filled by run_shm_benchmark."""
+    _fields_ = [
+        ("op", ctypes.c_int),
+        ("workers", ctypes.c_int),
+        ("processes", ctypes.c_int),
+        ("total_ops", ctypes.c_long),
+        ("elapsed_seconds", ctypes.c_double),
+        ("ops_per_sec", ctypes.c_double),
+        ("expected", ctypes.c_long),
+        ("observed", ctypes.c_long),
+    ]
+
+
+# Operations accepted by run_shm_benchmark
+SHM_BENCH_OPS = {"atomic": 0, "mutex": 1, "sharded": 2, "ledger": 3, "channel": 4}
+
+# Run by the child processes of test_shared_memory_across_processes
+SHM_CHILD_SCRIPT = """
+import ctypes, sys
+sys.path.insert(0, sys.argv[1])
+import threadtest_loader
+lib = threadtest_loader.load()
+lib.shm_attach.argtypes = [ctypes.c_char_p, ctypes.c_int]
+lib.shm_ledger_transfer.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_long]
+lib.shm_channel_try_push.argtypes = [ctypes.c_long]
+if lib.shm_attach(sys.argv[2].encode(), 0) != 0:
+    sys.exit(1)
+worker = int(sys.argv[3])
+lib.shm_atomic_increment(1000)
+lib.shm_safe_increment(1000)
+lib.shm_sharded_increment(1000)
+lib.shm_withdraw(10)
+for i in range(100):
+    lib.shm_ledger_transfer(i % 16, (i + worker + 1) % 16, 5)
+ok = lib.shm_channel_try_push(worker) == 1
+sys.exit(0 if lib.shm_detach() == 0 and ok else 1)
+"""
+
+
+class CompletionEntry(ctypes.Structure):
+    """Mirror of the CompletionEntry records returned by completion_queue_poll."""
+    _fields_ = [
+        ("tag", ctypes.c_long),
+        ("result", ctypes.c_long),
+    ]
+
+
+class BarrierStats(ctypes.Structure):
+    """Mirror of the BarrierStats struct filled by barrier_get_stats."""
+    _fields_ = [
+        ("threads", ctypes.c_int),
+        ("fan_in", ctypes.c_int),
+        ("depth", ctypes.c_int),
+        ("phases", ctypes.c_long),
+        ("waits", ctypes.c_long),
+        ("mean_wait_ns", ctypes.c_double),
+        ("max_wait_ns", ctypes.c_long),
+        ("mean_wake_ns", ctypes.c_double),
+        ("max_wake_ns", ctypes.c_long),
+    ]
+
+
+class BarrierBenchStats(ctypes.Structure):
+    """Mirror of the BarrierBenchStats struct filled by run_barrier_benchmark."""
+    _fields_ = [
+        ("threads", ctypes.c_int),
+        ("fan_in", ctypes.c_int),
+        ("depth", ctypes.c_int),
+        ("work_iterations", ctypes.c_int),
+        ("phases", ctypes.c_long),
+        ("elapsed_seconds", ctypes.c_double),
+        ("ns_per_phase", ctypes.c_double),
+        ("mean_wait_ns", ctypes.c_double),
+        ("p50_wake_ns", ctypes.c_double),
+        ("p99_wake_ns", ctypes.c_double),
+        ("completions", ctypes.c_long),
+    ]
+
+
+# void completion(void* context, long phase), run by the last thread to arrive
+BARRIER_COMPLETION = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_long)
+
+
+class TaskPoolStats(ctypes.Structure):
+    """Mirror of the TaskPoolStats struct filled by pool_get_task_stats."""
+    _fields_ = [
+        ("submitted", ctypes.c_long),
+        ("executed", ctypes.c_long),
+        ("local_pushes", ctypes.c_long),
+        ("injected", ctypes.c_long),
+        ("steals", ctypes.c_long),
+        ("workers", ctypes.c_int),
+    ]
+
+
+class MultiLockBenchStats(ctypes.Structure):
+    """Mirror of the MultiLockBenchStats struct filled by run_multi_lock_benchmark."""
+    _fields_ = [
+        ("strategy", ctypes.c_int),
+        ("threads", ctypes.c_int),
+        ("locks_per_op", ctypes.c_int),
+        ("resources", ctypes.c_int),
+        ("total_ops", ctypes.c_long),
+        ("elapsed_seconds", ctypes.c_double),
+        ("ops_per_sec", ctypes.c_double),
+        ("p50_acquire_ns", ctypes.c_double),
+        ("p99_acquire_ns", ctypes.c_double),
+        ("backoffs", ctypes.c_long),
+        ("lost_updates", ctypes.c_long),
+    ]
+
+
+# Strategies accepted by run_multi_lock_benchmark
+MULTI_LOCK_STRATEGIES = {"ordered": 0, "backoff": 1}
+
+
+class LedgerOp(ctypes.Structure):
+    """Mirror of the LedgerOp record consumed by ledger_batch_apply."""
+    _fields_ = [
+        ("from_account", ctypes.c_long),
+        ("to_account", ctypes.c_long),
+        ("amount", ctypes.c_long),
+    ]
+
+
+class LedgerBenchStats(ctypes.Structure):
+    """Mirror of the LedgerBenchStats struct filled by run_ledger_benchmark."""
+    _fields_ = [
+        ("threads", ctypes.c_int),
+        ("batch", ctypes.c_int),
+        ("accounts", ctypes.c_long),
+        ("zipf_s", ctypes.c_double),
+        ("total_ops", ctypes.c_long),
+        ("moved", ctypes.c_long),
+        ("insufficient", ctypes.c_long),
+        ("elapsed_seconds", ctypes.c_double),
+        ("ops_per_sec", ctypes.c_double),
+        ("p50_op_ns", ctypes.c_double),
+        ("p99_op_ns", ctypes.c_double),
+        ("hottest_share", ctypes.c_double),
+        ("imbalance", ctypes.c_long),
+        ("min_balance", ctypes.c_long),
+    ]
+
+
+class AdaptiveLockStats(ctypes.Structure):
+    """Mirror of the AdaptiveLockStats struct filled by adaptive_get_stats."""
+    _fields_ = [
+        ("acquisitions", ctypes.c_long),
+        ("uncontended", ctypes.c_long),
+        ("spin_acquisitions", ctypes.c_long),
+        ("spin_iterations", ctypes.c_long),
+        ("parks", ctypes.c_long),
+        ("handoffs", ctypes.c_long),
+    ]
+
 
 class TestThreadLibrary(unittest.TestCase):
     """Test suite for the multi-threaded test library."""
@@ -21,22 +375,18 @@ class TestThreadLibrary(unittest.TestCase):
     def setUpClass(cls):
         """Build and load the thread test library."""
         cls.test_dir = Path(__file__).parent
-        cls.lib_path = cls.test_dir / "libthreadtest.so"
-        cls.lib_tsan_path = cls.test_dir / "libthreadtest_tsan.so"
-        
-        # Build the library
-        result = subprocess.run(
-            ["make", "all"],
-            cwd=cls.test_dir,
-            capture_output=True,
-            text=True
-        )
+        cls.variant = threadtest_loader.variant_name()
+        cls.lib_path = threadtest_loader.library_path(cls.variant)
+        cls.lib_tsan_path = threadtest_loader.library_path("tsan")
+        
+        # Build the library (plus the optimised variant if THREADTEST_VARIANT asks for one)
+        result = threadtest_loader.build(cls.variant)
         
         if result.returncode != 0:
             raise RuntimeError(f"Failed to build library: {result.stderr}")
         
-        # Load the regular library for testing
-        cls.lib = ctypes.CDLL(str(cls.lib_path))
+        # Load the selected variant for testing
+        cls.lib = threadtest_loader.load(cls.variant)
         
         # Define function signatures
         cls._setup_function_signatures()
@@ -76,6 +426,16 @@ class TestThreadLibrary(unittest.TestCase):
         cls.lib.safe_write_buffer.argtypes = [ctypes.c_char_p]
         cls.lib.safe_write_buffer.restype = ctypes.c_char_p
         
+        # Per-thread arena functions
+        cls.lib.arena_write_buffer.argtypes = [ctypes.c_char_p]
+        cls.lib.arena_write_buffer.restype = ctypes.c_char_p
+        
+        cls.lib.arena_reset_thread.argtypes = []
+        cls.lib.arena_reset_thread.restype = None
+        
+        cls.lib.arena_thread_bytes_used.argtypes = []
+        cls.lib.arena_thread_bytes_used.restype = ctypes.c_long
+        
         cls.lib.safe_complex_operation.argtypes = [ctypes.c_int]
         cls.lib.safe_complex_operation.restype = ctypes.c_long
         
@@ -92,6 +452,16 @@ class TestThreadLibrary(unittest.TestCase):
         cls.lib.atomic_cas.argtypes = [ctypes.c_long, ctypes.c_long]
         cls.lib.atomic_cas.restype = ctypes.c_int
         
+        # Sharded counter functions
+        cls.lib.sharded_increment.argtypes = [ctypes.c_int]
+        cls.lib.sharded_increment.restype = ctypes.c_long
+        
+        cls.lib.sharded_decrement.argtypes = [ctypes.c_int]
+        cls.lib.sharded_decrement.restype = ctypes.c_long
+        
+        cls.lib.get_sharded_counter.argtypes = []
+        cls.lib.get_sharded_counter.restype = ctypes.c_long
+        
         # Utility functions
         cls.lib.reset_counters.argtypes = []
         cls.lib.reset_counters.restype = None
@@ -111,6 +481,9 @@ class TestThreadLibrary(unittest.TestCase):
         cls.lib.get_unsafe_balance.argtypes = []
         cls.lib.get_unsafe_balance.restype = ctypes.c_long
         
+        cls.lib.get_all_stats.argtypes = [ctypes.POINTER(ThreadtestStats)]
+        cls.lib.get_all_stats.restype = ctypes.c_int
+        
         # Deadlock functions
         cls.lib.deadlock_function1.argtypes = []
         cls.lib.deadlock_function1.restype = None
@@ -120,6 +493,375 @@ class TestThreadLibrary(unittest.TestCase):
         
         cls.lib.safe_dual_lock_operation.argtypes = []
         cls.lib.safe_dual_lock_operation.restype = ctypes.c_int
+        
+        # Native sync benchmark
+        cls.lib.run_sync_benchmark.argtypes = [
+            ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(SyncBenchStats)
+        ]
+        cls.lib.run_sync_benchmark.restype = ctypes.c_int
+        
+        # Pool allocator
+        cls.lib.pool_allocate.argtypes = [ctypes.c_size_t]
+        cls.lib.pool_allocate.restype = ctypes.c_void_p
+        
+        cls.lib.pool_deallocate.argtypes = [ctypes.c_void_p]
+        cls.lib.pool_deallocate.restype = None
+        
+        cls.lib.pool_block_size.argtypes = [ctypes.c_void_p]
+        cls.lib.pool_block_size.restype = ctypes.c_size_t
+        
+        cls.lib.pool_get_stats.argtypes = [ctypes.POINTER(PoolStats)]
+        cls.lib.pool_get_stats.restype = None
+        
+        cls.lib.run_alloc_benchmark.argtypes = [
+            ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(AllocBenchStats)
+        ]
+        cls.lib.run_alloc_benchmark.restype = ctypes.c_int
+        
+        # Adaptive spin-then-park mutex
+        for name in ("adaptive_increment", "adaptive_decrement", "adaptive_multiply",
+                     "adaptive_complex_operation"):
+            getattr(cls.lib, name).argtypes = [ctypes.c_int]
+            getattr(cls.lib, name).restype = ctypes.c_long
+        
+        cls.lib.get_adaptive_counter.argtypes = []
+        cls.lib.get_adaptive_counter.restype = ctypes.c_long
+        
+        cls.lib.adaptive_set_spin_limit.argtypes = [ctypes.c_int]
+        cls.lib.adaptive_set_spin_limit.restype = ctypes.c_int
+        
+        cls.lib.adaptive_get_stats.argtypes = [ctypes.POINTER(AdaptiveLockStats)]
+        cls.lib.adaptive_get_stats.restype = None
+        
+        cls.lib.adaptive_reset_stats.argtypes = []
+        cls.lib.adaptive_reset_stats.restype = None
+        
+        # Lock table
+        long_array = ctypes.POINTER(ctypes.c_long)
+        for name in ("multi_lock", "multi_unlock"):
+            getattr(cls.lib, name).argtypes = [long_array, ctypes.c_int]
+            getattr(cls.lib, name).restype = ctypes.c_int
+        
+        cls.lib.multi_lock_transaction.argtypes = [long_array, ctypes.c_int, ctypes.c_long]
+        cls.lib.multi_lock_transaction.restype = ctypes.c_long
+        
+        cls.lib.lock_table_stripe.argtypes = [ctypes.c_long]
+        cls.lib.lock_table_stripe.restype = ctypes.c_int
+        
+        cls.lib.lock_table_total.argtypes = []
+        cls.lib.lock_table_total.restype = ctypes.c_long
+        
+        cls.lib.lock_table_reset.argtypes = []
+        cls.lib.lock_table_reset.restype = None
+        
+        cls.lib.run_multi_lock_benchmark.argtypes = [
+            ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+            ctypes.POINTER(MultiLockBenchStats)
+        ]
+        cls.lib.run_multi_lock_benchmark.restype = ctypes.c_int
+        
+        # Ledger
+        cls.lib.ledger_init.argtypes = [ctypes.c_long, ctypes.c_long]
+        cls.lib.ledger_init.restype = ctypes.c_int
+        
+        cls.lib.ledger_account_count.argtypes = []
+        cls.lib.ledger_account_count.restype = ctypes.c_long
+        
+        cls.lib.ledger_balance.argtypes = [ctypes.c_long]
+        cls.lib.ledger_balance.restype = ctypes.c_long
+        
+        cls.lib.ledger_total.argtypes = []
+        cls.lib.ledger_total.restype = ctypes.c_long
+        
+        cls.lib.ledger_transfer.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_long]
+        cls.lib.ledger_transfer.restype = ctypes.c_int
+        
+        cls.lib.ledger_batch_apply.argtypes = [
+            ctypes.POINTER(LedgerOp), ctypes.c_long, ctypes.POINTER(ctypes.c_int)
+        ]
+        cls.lib.ledger_batch_apply.restype = ctypes.c_long
+        
+        cls.lib.run_ledger_benchmark.argtypes = [
+            ctypes.c_int, ctypes.c_int, ctypes.c_long, ctypes.c_double, ctypes.c_int,
+            ctypes.POINTER(LedgerBenchStats)
+        ]
+        cls.lib.run_ledger_benchmark.restype = ctypes.c_int
+        
+        # Phase barriers and reusable latch
+        cls.lib.barrier_create.argtypes = [ctypes.c_int, BARRIER_COMPLETION, ctypes.c_void_p]
+        cls.lib.barrier_create.restype = ctypes.c_void_p
+        
+        cls.lib.barrier_create_tree.argtypes = [
+            ctypes.c_int, ctypes.c_int, BARRIER_COMPLETION, ctypes.c_void_p
+        ]
+        cls.lib.barrier_create_tree.restype = ctypes.c_void_p
+        
+        cls.lib.barrier_destroy.argtypes = [ctypes.c_void_p]
+        cls.lib.barrier_destroy.restype = None
+        
+        cls.lib.barrier_arrive_and_wait.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        cls.lib.barrier_arrive_and_wait.restype = ctypes.c_long
+        
+        cls.lib.barrier_phase.argtypes = [ctypes.c_void_p]
+        cls.lib.barrier_phase.restype = ctypes.c_long
+        
+        cls.lib.barrier_get_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(BarrierStats)]
+        cls.lib.barrier_get_stats.restype = None
+        
+        cls.lib.barrier_reset_stats.argtypes = [ctypes.c_void_p]
+        cls.lib.barrier_reset_stats.restype = None
+        
+        cls.lib.latch_create.argtypes = [ctypes.c_long]
+        cls.lib.latch_create.restype = ctypes.c_void_p
+        
+        cls.lib.latch_destroy.argtypes = [ctypes.c_void_p]
+        cls.lib.latch_destroy.restype = None
+        
+        cls.lib.latch_count_down.argtypes = [ctypes.c_void_p, ctypes.c_long]
+        cls.lib.latch_count_down.restype = ctypes.c_int
+        
+        for name in ("latch_wait", "latch_generation"):
+            getattr(cls.lib, name).argtypes = [ctypes.c_void_p]
+            getattr(cls.lib, name).restype = ctypes.c_long
+        
+        cls.lib.latch_try_wait.argtypes = [ctypes.c_void_p]
+        cls.lib.latch_try_wait.restype = ctypes.c_int
+        
+        cls.lib.latch_reset.argtypes = [ctypes.c_void_p, ctypes.c_long]
+        cls.lib.latch_reset.restype = ctypes.c_long
+        
+        cls.lib.run_barrier_benchmark.argtypes = [
+            ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+            ctypes.POINTER(BarrierBenchStats)
+        ]
+        cls.lib.run_barrier_benchmark.restype = ctypes.c_int
+        
+        # Async completion queue
+        cls.lib.completion_queue_create.argtypes = [ctypes.c_long]
+        cls.lib.completion_queue_create.restype = ctypes.c_void_p
+        
+        for name in ("completion_queue_destroy", "completion_queue_fd"):
+            getattr(cls.lib, name).argtypes = [ctypes.c_void_p]
+            getattr(cls.lib, name).restype = ctypes.c_int
+        
+        cls.lib.completion_queue_outstanding.argtypes = [ctypes.c_void_p]
+        cls.lib.completion_queue_outstanding.restype = ctypes.c_long
+        
+        cls.lib.async_submit.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_long, ctypes.c_long]
+        cls.lib.async_submit.restype = ctypes.c_int
+        
+        cls.lib.completion_queue_poll.argtypes = [
+            ctypes.c_void_p, ctypes.POINTER(CompletionEntry), ctypes.c_long
+        ]
+        cls.lib.completion_queue_poll.restype = ctypes.c_long
+        
+        for name in ("async_wait_for_data", "async_acquire_resource", "async_cancel"):
+            getattr(cls.lib, name).argtypes = [ctypes.c_void_p, ctypes.c_long]
+            getattr(cls.lib, name).restype = ctypes.c_int
+        
+        cls.lib.async_wait_for_value.argtypes = [ctypes.c_void_p, ctypes.c_long, ctypes.c_long]
+        cls.lib.async_wait_for_value.restype = ctypes.c_int
+        
+        cls.lib.async_op_spin.argtypes = [ctypes.c_long]
+        cls.lib.async_op_spin.restype = ctypes.c_long
+        
+        for name in ("signal_data_ready", "release_resource", "atomic_notify_all"):
+            getattr(cls.lib, name).argtypes = []
+            getattr(cls.lib, name).restype = None
+        
+        cls.lib.acquire_resource.argtypes = []
+        cls.lib.acquire_resource.restype = ctypes.c_int
+        
+        # Object pool
+        cls.lib.object_pool_create.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_int]
+        cls.lib.object_pool_create.restype = ctypes.c_void_p
+        
+        cls.lib.object_pool_destroy.argtypes = [ctypes.c_void_p]
+        cls.lib.object_pool_destroy.restype = ctypes.c_int
+        
+        cls.lib.object_pool_acquire.argtypes = [ctypes.c_void_p, ctypes.c_long, ctypes.POINTER(ObjectHandle)]
+        cls.lib.object_pool_acquire.restype = ctypes.c_int
+        
+        cls.lib.object_pool_release.argtypes = [ctypes.c_void_p, ctypes.c_long]
+        cls.lib.object_pool_release.restype = ctypes.c_int
+        
+        cls.lib.object_pool_get_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(ObjectPoolStats)]
+        cls.lib.object_pool_get_stats.restype = None
+        
+        cls.lib.run_object_pool_benchmark.argtypes = [
+            ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_long, ctypes.c_int,
+            ctypes.POINTER(ObjectPoolBenchStats)
+        ]
+        cls.lib.run_object_pool_benchmark.restype = ctypes.c_int
+        
+        # Shared-memory segment
+        cls.lib.shm_attach.argtypes = [ctypes.c_char_p, ctypes.c_int]
+        cls.lib.shm_attach.restype = ctypes.c_int
+        
+        cls.lib.shm_unlink_segment.argtypes = [ctypes.c_char_p]
+        cls.lib.shm_unlink_segment.restype = ctypes.c_int
+        
+        for name in ("shm_detach", "shm_is_attached", "shm_reset"):
+            getattr(cls.lib, name).argtypes = []
+            getattr(cls.lib, name).restype = ctypes.c_int
+        
+        for name in ("shm_atomic_increment", "shm_safe_increment", "shm_sharded_increment"):
+            getattr(cls.lib, name).argtypes = [ctypes.c_int]
+            getattr(cls.lib, name).restype = ctypes.c_long
+        
+        cls.lib.shm_withdraw.argtypes = [ctypes.c_long]
+        cls.lib.shm_withdraw.restype = ctypes.c_int
+        
+        cls.lib.shm_channel_try_push.argtypes = [ctypes.c_long]
+        cls.lib.shm_channel_try_push.restype = ctypes.c_int
+        
+        cls.lib.shm_channel_try_pop.argtypes = [ctypes.POINTER(ctypes.c_long)]
+        cls.lib.shm_channel_try_pop.restype = ctypes.c_int
+        
+        cls.lib.shm_ledger_init.argtypes = [ctypes.c_long, ctypes.c_long]
+        cls.lib.shm_ledger_init.restype = ctypes.c_int
+        
+        cls.lib.shm_ledger_transfer.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_long]
+        cls.lib.shm_ledger_transfer.restype = ctypes.c_int
+        
+        cls.lib.shm_ledger_balance.argtypes = [ctypes.c_long]
+        cls.lib.shm_ledger_balance.restype = ctypes.c_long
+        
+        cls.lib.shm_get_stats.argtypes = [ctypes.POINTER(ShmStats)]
+        cls.lib.shm_get_stats.restype = ctypes.c_int
+        
+        cls.lib.run_shm_benchmark.argtypes = [
+            ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(ShmBenchStats)
+        ]
+        cls.lib.run_shm_benchmark.restype = ctypes.c_int
+        
+        # Lock profiler
+        cls.lib.lock_profiler_enable.argtypes = [ctypes.c_int]
+        cls.lib.lock_profiler_enable.restype = ctypes.c_int
+        
+        cls.lib.lock_profiler_reset.argtypes = []
+        cls.lib.lock_profiler_reset.restype = None
+        
+        cls.lib.lock_profiler_site_count.argtypes = []
+        cls.lib.lock_profiler_site_count.restype = ctypes.c_int
+        
+        cls.lib.lock_profiler_get_site.argtypes = [ctypes.c_int, ctypes.POINTER(LockSiteStats)]
+        cls.lib.lock_profiler_get_site.restype = ctypes.c_int
+        
+        cls.lib.lock_profiler_dump_json.argtypes = [ctypes.c_char_p, ctypes.c_long]
+        cls.lib.lock_profiler_dump_json.restype = ctypes.c_long
+        
+        # Work-stealing task pool
+        cls.lib.pool_set_workers.argtypes = [ctypes.c_int]
+        cls.lib.pool_set_workers.restype = ctypes.c_int
+        
+        cls.lib.pool_worker_count.argtypes = []
+        cls.lib.pool_worker_count.restype = ctypes.c_int
+        
+        cls.lib.pool_submit.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        cls.lib.pool_submit.restype = ctypes.c_int
+        
+        cls.lib.pool_submit_n.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_long]
+        cls.lib.pool_submit_n.restype = ctypes.c_int
+        
+        cls.lib.pool_wait_all.argtypes = []
+        cls.lib.pool_wait_all.restype = ctypes.c_int
+        
+        cls.lib.pool_shutdown.argtypes = []
+        cls.lib.pool_shutdown.restype = None
+        
+        cls.lib.pool_get_task_stats.argtypes = [ctypes.POINTER(TaskPoolStats)]
+        cls.lib.pool_get_task_stats.restype = None
+        
+        cls.lib.pool_reset_task_stats.argtypes = []
+        cls.lib.pool_reset_task_stats.restype = None
+        
+        cls.lib.pool_run_tree.argtypes = [ctypes.c_int]
+        cls.lib.pool_run_tree.restype = ctypes.c_long
+        
+        cls.lib.start_jthread_worker.argtypes = []
+        cls.lib.start_jthread_worker.restype = ctypes.c_long
+        
+        cls.lib.stop_jthread_worker.argtypes = []
+        cls.lib.stop_jthread_worker.restype = None
+        
+        # Flat combining
+        for name in ("combining_increment", "combining_decrement", "combining_multiply",
+                     "combining_complex_operation"):
+            getattr(cls.lib, name).argtypes = [ctypes.c_int]
+            getattr(cls.lib, name).restype = ctypes.c_long
+        
+        cls.lib.get_combining_counter.argtypes = []
+        cls.lib.get_combining_counter.restype = ctypes.c_long
+        
+        cls.lib.combining_get_stats.argtypes = [ctypes.POINTER(CombiningStats)]
+        cls.lib.combining_get_stats.restype = None
+        
+        cls.lib.combining_reset_stats.argtypes = []
+        cls.lib.combining_reset_stats.restype = None
+        
+        # Read-mostly patterns
+        for name in ("seqlock_read", "rcu_read"):
+            getattr(cls.lib, name).argtypes = []
+            getattr(cls.lib, name).restype = ctypes.c_long
+        for name in ("seqlock_write", "rcu_publish"):
+            getattr(cls.lib, name).argtypes = [ctypes.c_long]
+            getattr(cls.lib, name).restype = None
+        
+        cls.lib.run_rw_benchmark.argtypes = [
+            ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(RwBenchStats)
+        ]
+        cls.lib.run_rw_benchmark.restype = ctypes.c_int
+        
+        # Hardware counters
+        cls.lib.counters_available.argtypes = []
+        cls.lib.counters_available.restype = ctypes.c_int
+        
+        cls.lib.counters_set_enabled.argtypes = [ctypes.c_int]
+        cls.lib.counters_set_enabled.restype = None
+        
+        cls.lib.counters_begin.argtypes = [ctypes.c_int]
+        cls.lib.counters_begin.restype = None
+        
+        cls.lib.counters_end.argtypes = [ctypes.c_int]
+        cls.lib.counters_end.restype = None
+        
+        cls.lib.counters_read.argtypes = [ctypes.c_int, ctypes.POINTER(CounterStats)]
+        cls.lib.counters_read.restype = None
+        
+        cls.lib.counters_reset.argtypes = []
+        cls.lib.counters_reset.restype = None
+        
+        # MPMC channel
+        cls.lib.channel_create.argtypes = [ctypes.c_long]
+        cls.lib.channel_create.restype = ctypes.c_void_p
+        
+        cls.lib.channel_destroy.argtypes = [ctypes.c_void_p]
+        cls.lib.channel_destroy.restype = None
+        
+        cls.lib.channel_try_push.argtypes = [ctypes.c_void_p, ctypes.c_long]
+        cls.lib.channel_try_push.restype = ctypes.c_int
+        
+        cls.lib.channel_try_pop.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_long)]
+        cls.lib.channel_try_pop.restype = ctypes.c_int
+        
+        cls.lib.channel_push_batch.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_long), ctypes.c_long]
+        cls.lib.channel_push_batch.restype = ctypes.c_long
+        
+        cls.lib.channel_pop_batch.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_long), ctypes.c_long]
+        cls.lib.channel_pop_batch.restype = ctypes.c_long
+        
+        cls.lib.channel_push.argtypes = [ctypes.c_void_p, ctypes.c_long]
+        cls.lib.channel_push.restype = ctypes.c_int
+        
+        cls.lib.channel_pop.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_long)]
+        cls.lib.channel_pop.restype = ctypes.c_int
+        
+        cls.lib.channel_close.argtypes = [ctypes.c_void_p]
+        cls.lib.channel_close.restype = None
+        
+        cls.lib.channel_size.argtypes = [ctypes.c_void_p]
+        cls.lib.channel_size.restype = ctypes.c_long
     
     def setUp(self):
         """Reset counters before each test."""
@@ -216,6 +958,35 @@ class TestThreadLibrary(unittest.TestCase):
             f"Atomic increment failed: got {final_value}, expected {expected_value}"
         )
     
+    def test_sharded_increment_no_race(self):
+        """Test that sharded_increment loses no updates across threads."""
+        iterations = 10000
+        num_threads = 8
+        
+        def sharded_worker():
+            self.lib.sharded_increment(iterations)
+            self.lib.sharded_decrement(iterations // 2)
+        
+        threads = []
+        for _ in range(num_threads):
+            t = threading.Thread(target=sharded_worker)
+            threads.append(t)
+            t.start()
+        
+        for t in threads:
+            t.join()
+        
+        final_value = self.lib.get_sharded_counter()
+        expected_value = (iterations - iterations // 2) * num_threads
+        
+        self.assertEqual(
+            final_value, expected_value,
+            f"Sharded increment failed: got {final_value}, expected {expected_value}"
+        )
+        
+        self.lib.reset_counters()
+        self.assertEqual(self.lib.get_sharded_counter(), 0, "reset_counters should clear shards")
+    
     def test_unsafe_bank_withdrawal_race(self):
         """Test TOCTOU race condition in unsafe withdrawal."""
         # Try multiple runs to increase chance of detecting race condition
@@ -337,6 +1108,51 @@ class TestThreadLibrary(unittest.TestCase):
             if result:
                 self.assertIn(" - processed", result, "Safe buffer missing suffix")
     
+    def test_arena_write_buffer(self):
+        """Test per-thread arena results are uncorrupted and survive until reset."""
+        num_threads = 10
+        
+        # Separate function object returning raw pointers, so earlier results
+        # can be re-read after later writes on the same thread
+        arena_write_raw = self.lib["arena_write_buffer"]
+        arena_write_raw.argtypes = [ctypes.c_char_p]
+        arena_write_raw.restype = ctypes.c_void_p
+        
+        def arena_worker(thread_id):
+            ptrs = [arena_write_raw(f"Thread-{thread_id}-{i}".encode()) for i in range(100)]
+            results = [ctypes.string_at(ptr).decode() for ptr in ptrs]
+            used = self.lib.arena_thread_bytes_used()
+            self.lib.arena_reset_thread()
+            return results, used, self.lib.arena_thread_bytes_used()
+        
+        with ThreadPoolExecutor(max_workers=num_threads) as executor:
+            outcomes = list(executor.map(arena_worker, range(num_threads)))
+        
+        for thread_id, (results, used, after_reset) in enumerate(outcomes):
+            expected = [f"Thread-{thread_id}-{i} - processed" for i in range(100)]
+            self.assertEqual(results, expected, "Arena result corrupted or overwritten")
+            self.assertGreater(used, 0)
+            self.assertEqual(after_reset, 0, "arena_reset_thread should rewind the arena")
+        
+        # Inputs longer than the old 1024-byte shared_buffer are fine
+        long_text = b"x" * 5000
+        self.assertEqual(self.lib.arena_write_buffer(long_text), long_text + b" - processed")
+        self.lib.arena_reset_thread()
+    
+    def test_arena_vs_mutex_buffer_scaling(self):
+        """Compare safe_write_buffer against arena_write_buffer at 1-64 native threads."""
+        iterations = 2000
+        print("\n  threads  mutex ops/s   arena ops/s")
+        for threads in (1, 2, 4, 8, 16, 32, 64):
+            row = []
+            for name in ("buffer_mutex", "buffer_arena"):
+                stats = SyncBenchStats()
+                rc = self.lib.run_sync_benchmark(SYNC_PRIMITIVES[name], threads, iterations, ctypes.byref(stats))
+                self.assertEqual(rc, 0)
+                self.assertEqual(stats.total_ops, threads * iterations)
+                row.append(stats.ops_per_sec)
+            print(f"  {threads:7d}  {row[0]:11,.0f}  {row[1]:12,.0f}")
+    
     def test_deadlock_potential(self):
         """Test that deadlock functions can potentially deadlock."""
         # This test demonstrates the deadlock scenario without actually deadlocking
@@ -371,6 +1187,1077 @@ class TestThreadLibrary(unittest.TestCase):
         self.assertFalse(success, "CAS should fail with wrong expected value")
         self.assertEqual(self.lib.get_atomic_counter(), 100)
     
+    def test_run_sync_benchmark(self):
+        """Test the native per-primitive benchmark reports sane stats."""
+        threads = 4
+        iterations = 2000
+        
+        for name, primitive_id in SYNC_PRIMITIVES.items():
+            with self.subTest(primitive=name):
+                stats = SyncBenchStats()
+                rc = self.lib.run_sync_benchmark(primitive_id, threads, iterations, ctypes.byref(stats))
+                self.assertEqual(rc, 0)
+                self.assertEqual(stats.primitive_id, primitive_id)
+                self.assertEqual(stats.threads, threads)
+                self.assertEqual(stats.total_ops, threads * iterations)
+                self.assertGreater(stats.ops_per_sec, 0)
+                self.assertLessEqual(stats.p50_acquire_ns, stats.p99_acquire_ns)
+                self.assertLessEqual(stats.p99_acquire_ns, stats.max_acquire_ns)
+                print(f"\n  {name}: {stats.ops_per_sec:,.0f} ops/s, "
+                      f"p50 {stats.p50_acquire_ns:.0f}ns, p99 {stats.p99_acquire_ns:.0f}ns")
+        
+        # The mutex run goes through safe_counter, so it must not lose updates
+        self.lib.reset_counters()
+        stats = SyncBenchStats()
+        self.lib.run_sync_benchmark(SYNC_PRIMITIVES["mutex"], threads, iterations, ctypes.byref(stats))
+        self.assertEqual(self.lib.get_safe_counter(), threads * iterations)
+        
+        # Invalid arguments are rejected
+        self.assertEqual(self.lib.run_sync_benchmark(99, threads, iterations, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_sync_benchmark(0, 0, iterations, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_sync_benchmark(0, threads, iterations, None), -1)
+    
+    def test_pool_allocator(self):
+        """Test pool blocks round-trip across threads and respect size classes."""
+        stats = PoolStats()
+        self.lib.pool_get_stats(ctypes.byref(stats))
+        max_block = stats.max_block_size
+        
+        self.assertIsNone(self.lib.pool_allocate(0))
+        self.assertIsNone(self.lib.pool_allocate(max_block + 1))
+        
+        for size in (1, 16, 17, 100, 1000, max_block):
+            ptr = self.lib.pool_allocate(size)
+            self.assertIsNotNone(ptr)
+            self.assertGreaterEqual(self.lib.pool_block_size(ptr), size)
+            ctypes.memset(ptr, 0xAB, size)
+            self.lib.pool_deallocate(ptr)
+        
+        # Allocate on worker threads, free on the main thread
+        def alloc_worker(thread_id):
+            ptrs = []
+            for i in range(1000):
+                ptr = self.lib.pool_allocate(32 + (i % 200))
+                ctypes.memset(ptr, thread_id, 32)
+                ptrs.append(ptr)
+            return ptrs
+        
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            all_ptrs = [p for ptrs in executor.map(alloc_worker, range(4)) for p in ptrs]
+        
+        self.assertEqual(len(set(all_ptrs)), len(all_ptrs), "Pool handed out a block twice")
+        for ptr in all_ptrs:
+            self.lib.pool_deallocate(ptr)
+        
+        self.lib.pool_get_stats(ctypes.byref(stats))
+        self.assertGreater(stats.slabs, 0)
+        self.assertEqual(stats.slab_bytes % stats.slabs, 0)
+    
+    def test_alloc_benchmark_pool_vs_malloc(self):
+        """Compare malloc and the pool allocator on RSS growth and latency."""
+        iterations = 20000
+        print("\n  alloc   threads      ops/s   alloc p50/p99 ns   free p50/p99 ns   RSS growth")
+        for threads in (1, 4, 16):
+            for name, allocator in BENCH_ALLOCATORS.items():
+                stats = AllocBenchStats()
+                rc = self.lib.run_alloc_benchmark(allocator, threads, iterations, ctypes.byref(stats))
+                self.assertEqual(rc, 0)
+                self.assertEqual(stats.total_ops, threads * iterations)
+                self.assertLessEqual(stats.p50_alloc_ns, stats.p99_alloc_ns)
+                growth_kb = (stats.rss_after_bytes - stats.rss_before_bytes) / 1024
+                print(f"  {name:6s}  {threads:7d}  {stats.ops_per_sec:9,.0f}  "
+                      f"{stats.p50_alloc_ns:7.0f}/{stats.p99_alloc_ns:<7.0f}  "
+                      f"{stats.p50_free_ns:7.0f}/{stats.p99_free_ns:<7.0f}  {growth_kb:9.0f} KiB")
+        
+        stats = AllocBenchStats()
+        self.assertEqual(self.lib.run_alloc_benchmark(7, 1, iterations, ctypes.byref(stats)), -1)
+    
+    def test_adaptive_mutex(self):
+        """Test adaptive_* matches safe_* semantics and reports contention stats."""
+        self.lib.reset_counters()
+        self.lib.adaptive_reset_stats()
+        
+        self.assertEqual(self.lib.adaptive_increment(5), 5)
+        self.assertEqual(self.lib.adaptive_multiply(3), 15)
+        self.assertEqual(self.lib.adaptive_decrement(5), 10)
+        self.assertEqual(self.lib.adaptive_complex_operation(1), 11 + 22)
+        self.assertEqual(self.lib.get_adaptive_counter(), 21)
+        
+        self.lib.reset_counters()
+        num_threads = 8
+        calls = 200
+        
+        def worker():
+            for _ in range(calls):
+                self.lib.adaptive_increment(100)
+        
+        threads = [threading.Thread(target=worker) for _ in range(num_threads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(self.lib.get_adaptive_counter(), num_threads * calls * 100)
+        
+        stats = AdaptiveLockStats()
+        self.lib.adaptive_get_stats(ctypes.byref(stats))
+        self.assertGreaterEqual(stats.acquisitions, num_threads * calls)
+        self.assertLessEqual(stats.uncontended + stats.spin_acquisitions, stats.acquisitions)
+        
+        # Spin limit 0 parks straight away: no spin acquisitions at all
+        print("\n  spin limit  threads      ops/s   p50/p99 ns   uncontended  spun  parks  handoffs")
+        previous = self.lib.adaptive_set_spin_limit(0)
+        try:
+            for limit in (0, 16, previous, 1024):
+                self.lib.adaptive_set_spin_limit(limit)
+                for threads in (1, 4, 16):
+                    self.lib.adaptive_reset_stats()
+                    bench = SyncBenchStats()
+                    rc = self.lib.run_sync_benchmark(SYNC_PRIMITIVES["adaptive"], threads, 5000,
+                                                     ctypes.byref(bench))
+                    self.assertEqual(rc, 0)
+                    self.lib.adaptive_get_stats(ctypes.byref(stats))
+                    if limit == 0:
+                        self.assertEqual(stats.spin_acquisitions, 0)
+                    print(f"  {limit:10d}  {threads:7d}  {bench.ops_per_sec:10,.0f}  "
+                          f"{bench.p50_acquire_ns:5.0f}/{bench.p99_acquire_ns:<6.0f}  "
+                          f"{stats.uncontended:11d}  {stats.spin_acquisitions:4d}  "
+                          f"{stats.parks:5d}  {stats.handoffs:8d}")
+        finally:
+            self.lib.adaptive_set_spin_limit(previous)
+        self.assertEqual(self.lib.adaptive_set_spin_limit(-1), -1)
+    
+    def test_multi_lock_overlapping_sets(self):
+        """Test multi_lock never deadlocks or loses updates on overlapping id sets."""
+        self.lib.lock_table_reset()
+        num_threads = 8
+        transactions = 500
+        applied = [0] * num_threads
+        
+        def worker(tid):
+            rng = random.Random(tid)
+            for _ in range(transactions):
+                picked = rng.sample(range(32), 6)
+                ids = (ctypes.c_long * len(picked))(*picked)
+                if rng.random() < 0.5:
+                    self.lib.multi_lock_transaction(ids, len(picked), 1)
+                    applied[tid] += len({self.lib.lock_table_stripe(i) for i in picked})
+                else:
+                    self.assertEqual(self.lib.multi_lock(ids, len(picked)), 0)
+                    self.assertEqual(self.lib.multi_unlock(ids, len(picked)), 0)
+        
+        threads = [threading.Thread(target=worker, args=(t,)) for t in range(num_threads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join(timeout=60)
+            self.assertFalse(t.is_alive(), "multi_lock deadlocked")
+        self.assertEqual(self.lib.lock_table_total(), sum(applied))
+        
+        # Duplicate ids and ids sharing a stripe are locked once
+        same = (ctypes.c_long * 3)(5, 5, 5)
+        self.assertEqual(self.lib.multi_lock(same, 3), 0)
+        self.assertEqual(self.lib.multi_unlock(same, 3), 0)
+        self.assertTrue(0 <= self.lib.lock_table_stripe(12345) < 256)
+        self.assertEqual(self.lib.multi_lock(same, 0), -1)
+        self.assertEqual(self.lib.multi_lock(None, 1), -1)
+    
+    def test_multi_lock_benchmark(self):
+        """Compare ordered multi_lock against std::lock-style back-off under overlap."""
+        iterations = 3000
+        print("\n  strategy  threads  locks  resources       ops/s   p50/p99 ns   backoffs")
+        for locks, resources in ((2, 1024), (4, 64), (8, 16)):
+            for threads in (1, 4, 16):
+                for name, strategy in MULTI_LOCK_STRATEGIES.items():
+                    stats = MultiLockBenchStats()
+                    rc = self.lib.run_multi_lock_benchmark(strategy, threads, iterations, locks,
+                                                           resources, ctypes.byref(stats))
+                    self.assertEqual(rc, 0)
+                    self.assertEqual(stats.total_ops, threads * iterations)
+                    self.assertEqual(stats.lost_updates, 0)
+                    if strategy == MULTI_LOCK_STRATEGIES["ordered"]:
+                        self.assertEqual(stats.backoffs, 0)
+                    print(f"  {name:8s}  {threads:7d}  {locks:5d}  {resources:9d}  "
+                          f"{stats.ops_per_sec:10,.0f}  {stats.p50_acquire_ns:5.0f}/{stats.p99_acquire_ns:<6.0f}  "
+                          f"{stats.backoffs:8d}")
+        
+        stats = MultiLockBenchStats()
+        self.assertEqual(self.lib.run_multi_lock_benchmark(2, 1, 10, 2, 16, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_multi_lock_benchmark(0, 1, 10, 33, 16, ctypes.byref(stats)), -1)
+    
+    def test_get_all_stats_snapshot(self):
+        """Test get_all_stats matches the individual getters and can be polled under load."""
+        before = ThreadtestStats()
+        self.assertEqual(self.lib.get_all_stats(ctypes.byref(before)), 0)
+        self.lib.reset_counters()
+        self.lib.safe_increment(7)
+        self.lib.atomic_increment(5)
+        self.lib.sharded_increment(3)
+        self.lib.adaptive_increment(4)
+        self.lib.combining_increment(6)
+        self.lib.withdraw_safe(100)
+        
+        stats = ThreadtestStats()
+        self.assertEqual(self.lib.get_all_stats(ctypes.byref(stats)), 0)
+        self.assertNotEqual(stats.reset_epoch, before.reset_epoch)
+        self.assertGreaterEqual(stats.timestamp_ns, before.timestamp_ns)
+        self.assertEqual(stats.safe_counter, self.lib.get_safe_counter())
+        self.assertEqual(stats.atomic_counter, self.lib.get_atomic_counter())
+        self.assertEqual(stats.sharded_counter, self.lib.get_sharded_counter())
+        self.assertEqual(stats.adaptive_counter, self.lib.get_adaptive_counter())
+        self.assertEqual(stats.combining_counter, self.lib.get_combining_counter())
+        self.assertEqual(stats.balance, self.lib.get_balance())
+        self.assertEqual((stats.safe_counter, stats.adaptive_counter, stats.combining_counter),
+                         (7, 4, 6))
+        
+        # A poller sees monotonic counters while writers hold the locks
+        self.lib.reset_counters()
+        stop = threading.Event()
+        polls = []
+        
+        def poller():
+            snapshot = ThreadtestStats()
+            while not stop.is_set():
+                self.lib.get_all_stats(ctypes.byref(snapshot))
+                polls.append((snapshot.safe_counter, snapshot.adaptive_counter,
+                              snapshot.combining_counter))
+        
+        def writer():
+            for _ in range(500):
+                self.lib.safe_increment(10)
+                self.lib.adaptive_increment(10)
+                self.lib.combining_increment(10)
+        
+        watcher = threading.Thread(target=poller)
+        watcher.start()
+        writers = [threading.Thread(target=writer) for _ in range(4)]
+        for t in writers:
+            t.start()
+        for t in writers:
+            t.join()
+        stop.set()
+        watcher.join()
+        
+        self.assertGreater(len(polls), 0)
+        for column in range(3):
+            series = [poll[column] for poll in polls]
+            self.assertEqual(series, sorted(series))
+        self.assertEqual(self.lib.get_all_stats(ctypes.byref(stats)), 0)
+        self.assertEqual((stats.safe_counter, stats.adaptive_counter, stats.combining_counter),
+                         (20000, 20000, 20000))
+        self.assertEqual(self.lib.get_all_stats(None), -1)
+    
+    def test_phase_barriers(self):
+        """Test central and tree barriers keep phases in lockstep and run the completion once."""
+        num_threads = 6
+        phases = 40
+        for fan_in in (0, 2, 4):
+            written = [[0] * num_threads for _ in range(phases)]
+            completed = []
+            
+            @BARRIER_COMPLETION
+            def on_complete(context, phase):
+                # Runs before anyone is released, so every slot of this phase is in
+                completed.append((phase, sum(written[phase])))
+            
+            if fan_in == 0:
+                barrier = self.lib.barrier_create(num_threads, on_complete, None)
+            else:
+                barrier = self.lib.barrier_create_tree(num_threads, fan_in, on_complete, None)
+            self.assertTrue(barrier)
+            try:
+                def worker(tid):
+                    for phase in range(phases):
+                        written[phase][tid] = 1
+                        self.assertEqual(self.lib.barrier_arrive_and_wait(barrier, tid), phase)
+                
+                threads = [threading.Thread(target=worker, args=(t,)) for t in range(num_threads)]
+                for t in threads:
+                    t.start()
+                for t in threads:
+                    t.join(timeout=60)
+                    self.assertFalse(t.is_alive(), "barrier phase never completed")
+                
+                self.assertEqual(completed, [(p, num_threads) for p in range(phases)])
+                stats = BarrierStats()
+                self.lib.barrier_get_stats(barrier, ctypes.byref(stats))
+                self.assertEqual(stats.phases, phases)
+                self.assertEqual(stats.waits, phases * num_threads)
+                self.assertEqual(stats.depth, {0: 1, 2: 3, 4: 2}[fan_in])
+                self.assertEqual(self.lib.barrier_arrive_and_wait(barrier, num_threads), -1)
+                self.lib.barrier_reset_stats(barrier)
+                self.lib.barrier_get_stats(barrier, ctypes.byref(stats))
+                self.assertEqual(stats.waits, 0)
+            finally:
+                self.lib.barrier_destroy(barrier)
+        
+        null_completion = ctypes.cast(None, BARRIER_COMPLETION)
+        self.assertFalse(self.lib.barrier_create(0, null_completion, None))
+        self.assertFalse(self.lib.barrier_create_tree(4, 1, null_completion, None))
+    
+    def test_reusable_latch(self):
+        """Test the generation latch opens, re-arms and never catches late waiters."""
+        latch = self.lib.latch_create(3)
+        self.assertTrue(latch)
+        try:
+            for generation in range(3):
+                self.assertEqual(self.lib.latch_generation(latch), generation)
+                self.assertEqual(self.lib.latch_try_wait(latch), 0)
+                self.assertEqual(self.lib.latch_reset(latch, 3), -1)  # Still closed
+                
+                released = []
+                waiters = [threading.Thread(target=lambda: released.append(self.lib.latch_wait(latch)))
+                           for _ in range(4)]
+                for t in waiters:
+                    t.start()
+                self.assertEqual(self.lib.latch_count_down(latch, 2), 0)
+                self.assertEqual(self.lib.latch_count_down(latch, 2), -1)  # Only 1 left
+                self.assertEqual(self.lib.latch_count_down(latch, 1), 1)
+                for t in waiters:
+                    t.join(timeout=10)
+                    self.assertFalse(t.is_alive(), "latch waiter never released")
+                self.assertEqual(released, [generation] * 4)
+                self.assertEqual(self.lib.latch_try_wait(latch), 1)
+                self.assertEqual(self.lib.latch_wait(latch), generation)
+                self.assertEqual(self.lib.latch_reset(latch, 3), generation + 1)
+        finally:
+            self.lib.latch_destroy(latch)
+        self.assertFalse(self.lib.latch_create(0))
+    
+    def test_barrier_benchmark(self):
+        """Measure per-phase barrier overhead for central vs tree as threads grow."""
+        phases = 300
+        print("\n  barrier  threads  depth   ns/phase   mean wait   p50/p99 wake ns")
+        for threads in (2, 4, 8, 16):
+            for name, fan_in in (("central", 0), ("tree/4", 4)):
+                stats = BarrierBenchStats()
+                rc = self.lib.run_barrier_benchmark(threads, fan_in, phases, 200, ctypes.byref(stats))
+                self.assertEqual(rc, 0)
+                self.assertEqual(stats.phases, phases)
+                self.assertEqual(stats.completions, phases)
+                print(f"  {name:7s}  {threads:7d}  {stats.depth:5d}  {stats.ns_per_phase:9.0f}  "
+                      f"{stats.mean_wait_ns:10.0f}  {stats.p50_wake_ns:7.0f}/{stats.p99_wake_ns:<7.0f}")
+        
+        stats = BarrierBenchStats()
+        self.assertEqual(self.lib.run_barrier_benchmark(4, 1, 10, 0, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_barrier_benchmark(0, 0, 10, 0, ctypes.byref(stats)), -1)
+    
+    def test_object_pool_handles(self):
+        """Test the object pool hands out exclusive payload slots with caching and timeouts."""
+        capacity = 4
+        pool = self.lib.object_pool_create(capacity, 100, 8)
+        self.assertTrue(pool)
+        handles = []
+        try:
+            for _ in range(capacity):
+                h = ObjectHandle()
+                self.assertEqual(self.lib.object_pool_acquire(pool, 0, ctypes.byref(h)), 1)
+                handles.append(h)
+            self.assertEqual(sorted(h.slot for h in handles), list(range(capacity)))
+            payloads = [h.payload for h in handles]
+            self.assertEqual(len(set(payloads)), capacity)
+            self.assertTrue(all(p % 64 == 0 for p in payloads))
+            ctypes.memset(handles[0].payload, 0xAB, 100)  # Payload is real, writable memory
+            
+            spare = ObjectHandle()
+            started = time.time()
+            self.assertEqual(self.lib.object_pool_acquire(pool, 20, ctypes.byref(spare)), 0)
+            self.assertGreaterEqual(time.time() - started, 0.015)
+            self.assertEqual(self.lib.object_pool_destroy(pool), -1)
+            
+            # Released slots park in this thread's cache and come straight back
+            self.assertEqual(self.lib.object_pool_release(pool, handles[2].slot), 0)
+            self.assertEqual(self.lib.object_pool_release(pool, handles[2].slot), -1)
+            stats = ObjectPoolStats()
+            self.lib.object_pool_get_stats(pool, ctypes.byref(stats))
+            self.assertEqual((stats.in_use, stats.parked), (capacity - 1, 1))
+            shared_before = stats.shared_acquires
+            self.assertEqual(self.lib.object_pool_acquire(pool, 0, ctypes.byref(spare)), 1)
+            self.assertEqual((spare.slot, spare.payload), (handles[2].slot, handles[2].payload))
+            self.lib.object_pool_get_stats(pool, ctypes.byref(stats))
+            self.assertEqual(stats.shared_acquires, shared_before)
+            
+            # Another thread can take slots parked in this thread's cache
+            for h in handles:
+                self.assertEqual(self.lib.object_pool_release(pool, h.slot), 0)
+            stolen = []
+            
+            def taker():
+                for _ in range(capacity):
+                    h = ObjectHandle()
+                    if self.lib.object_pool_acquire(pool, 1000, ctypes.byref(h)) == 1:
+                        stolen.append(h.slot)
+                for slot in stolen:
+                    self.lib.object_pool_release(pool, slot)
+            
+            t = threading.Thread(target=taker)
+            t.start()
+            t.join(timeout=10)
+            self.assertEqual(sorted(stolen), list(range(capacity)))
+            self.lib.object_pool_get_stats(pool, ctypes.byref(stats))
+            self.assertEqual(stats.steals, capacity)
+            self.assertEqual(stats.in_use, 0)
+            
+            # Many threads, few slots: every acquire eventually succeeds, exclusively
+            owners = {}
+            lock = threading.Lock()
+            overlaps = []
+            
+            def worker(tid):
+                for _ in range(300):
+                    h = ObjectHandle()
+                    self.assertEqual(self.lib.object_pool_acquire(pool, -1, ctypes.byref(h)), 1)
+                    with lock:
+                        if h.slot in owners:
+                            overlaps.append(h.slot)
+                        owners[h.slot] = tid
+                    with lock:
+                        del owners[h.slot]
+                    self.assertEqual(self.lib.object_pool_release(pool, h.slot), 0)
+            
+            threads = [threading.Thread(target=worker, args=(i,)) for i in range(8)]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join(timeout=60)
+                self.assertFalse(t.is_alive(), "object pool acquire never returned")
+            self.assertEqual(overlaps, [])
+            self.lib.object_pool_get_stats(pool, ctypes.byref(stats))
+            self.assertEqual(stats.in_use, 0)
+        finally:
+            self.assertEqual(self.lib.object_pool_destroy(pool), 0)
+        
+        self.assertFalse(self.lib.object_pool_create(0, 8, 0))
+        self.assertFalse(self.lib.object_pool_create(4, 8, 9))
+        self.assertEqual(self.lib.object_pool_acquire(None, 0, None), -1)
+    
+    def test_object_pool_benchmark(self):
+        """Compare acquire/release latency for the bare semaphore, shared pool and cached pool."""
+        iterations = 5000
+        capacity = 8
+        print("\n  mode       threads  capacity       ops/s   acq p50/p99   rel p50/p99   hit rate")
+        for threads in (1, 4, 8, 16):
+            for name, mode in OBJECT_POOL_BENCH_MODES.items():
+                stats = ObjectPoolBenchStats()
+                rc = self.lib.run_object_pool_benchmark(mode, threads, iterations, capacity, 20,
+                                                        ctypes.byref(stats))
+                self.assertEqual(rc, 0)
+                self.assertEqual(stats.total_ops, threads * iterations)
+                self.assertEqual(stats.overlaps, 0)
+                print(f"  {name:9s}  {threads:7d}  {capacity:8d}  {stats.ops_per_sec:10,.0f}  "
+                      f"{stats.p50_acquire_ns:5.0f}/{stats.p99_acquire_ns:<6.0f}  "
+                      f"{stats.p50_release_ns:5.0f}/{stats.p99_release_ns:<6.0f}  {stats.cache_hit_rate:8.3f}")
+        
+        stats = ObjectPoolBenchStats()
+        self.assertEqual(self.lib.run_object_pool_benchmark(3, 1, 10, 4, 0, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_object_pool_benchmark(0, 1, 10, 0, 0, ctypes.byref(stats)), -1)
+    
+    def test_async_completion_queue(self):
+        """Test asyncio can await thousands of native operations through one fd."""
+        queue = self.lib.completion_queue_create(4096)
+        self.assertTrue(queue)
+        spin = ctypes.cast(self.lib.async_op_spin, ctypes.c_void_p)
+        operations = 2000
+        
+        async def drive():
+            loop = asyncio.get_running_loop()
+            futures = {}
+            entries = (CompletionEntry * 128)()
+            wakeups = 0
+            
+            def on_readable():
+                nonlocal wakeups
+                wakeups += 1
+                n = self.lib.completion_queue_poll(queue, entries, len(entries))
+                for entry in entries[:n]:
+                    futures.pop(entry.tag).set_result(entry.result)
+            
+            def expect(tag, rc):
+                self.assertEqual(rc, 1)
+                futures[tag] = loop.create_future()
+                return futures[tag]
+            
+            fd = self.lib.completion_queue_fd(queue)
+            loop.add_reader(fd, on_readable)
+            try:
+                # Waits are registrations, so they hold no pool worker or loop thread
+                self.lib.reset_counters()
+                data = expect(-1, self.lib.async_wait_for_data(queue, -1))
+                changed = expect(-2, self.lib.async_wait_for_value(queue, 0, -2))
+                pending = [expect(tag, self.lib.async_submit(queue, spin, tag * 10, tag))
+                           for tag in range(operations)]
+                results = await asyncio.wait_for(asyncio.gather(*pending), timeout=60)
+                self.assertFalse(data.done() or changed.done())
+                
+                self.lib.signal_data_ready()
+                self.assertEqual(await asyncio.wait_for(data, timeout=10), 1)
+                self.lib.atomic_notify_all()  # Counter still 0: not a change
+                self.lib.atomic_increment(3)
+                self.lib.atomic_notify_all()
+                self.assertEqual(await asyncio.wait_for(changed, timeout=10), 3)
+                
+                # A released resource goes straight to the registered waiter
+                held = 0
+                while self.lib.acquire_resource():
+                    held += 1
+                granted = expect(-3, self.lib.async_acquire_resource(queue, -3))
+                self.assertEqual(self.lib.async_acquire_resource(queue, -4), 1)
+                self.assertEqual(self.lib.async_cancel(queue, -4), 1)
+                self.assertEqual(self.lib.async_cancel(queue, -4), 0)
+                self.lib.release_resource()
+                self.assertEqual(await asyncio.wait_for(granted, timeout=10), 1)
+                for _ in range(held):  # held - 1 still ours, plus the one granted
+                    self.lib.release_resource()
+            finally:
+                loop.remove_reader(fd)
+            return results, wakeups
+        
+        try:
+            results, wakeups = asyncio.run(drive())
+            self.assertEqual(results, [self.lib.async_op_spin(tag * 10) for tag in range(operations)])
+            self.assertLess(wakeups, operations)  # Signals coalesce while entries wait
+            self.assertEqual(self.lib.completion_queue_outstanding(queue), 0)
+        finally:
+            self.assertEqual(self.lib.completion_queue_destroy(queue), 0)
+        
+        # Capacity bounds outstanding operations; destroy refuses while a wait is registered
+        small = self.lib.completion_queue_create(1)
+        self.assertEqual(self.lib.async_wait_for_data(small, 7), 1)
+        self.assertEqual(self.lib.async_submit(small, spin, 1, 8), 0)
+        self.assertEqual(self.lib.completion_queue_destroy(small), -1)
+        self.lib.signal_data_ready()
+        entry = (CompletionEntry * 1)()
+        self.assertEqual(self.lib.completion_queue_poll(small, entry, 1), 1)
+        self.assertEqual((entry[0].tag, entry[0].result), (7, 1))
+        self.assertEqual(self.lib.completion_queue_destroy(small), 0)
+        self.assertFalse(self.lib.completion_queue_create(0))
+        self.assertEqual(self.lib.async_submit(None, spin, 1, 1), -1)
+    
+    def attach_test_segment(self):
+        """Create a segment unique to this test process, detached and unlinked on cleanup."""
+        name = f"/threadtest-{os.getpid()}".encode()
+        self.lib.shm_unlink_segment(name)
+        self.assertEqual(self.lib.shm_attach(name, 1), 1)
+        self.addCleanup(self.lib.shm_unlink_segment, name)
+        self.addCleanup(self.lib.shm_detach)
+        self.assertEqual(self.lib.shm_reset(), 0)
+        return name
+    
+    def test_shared_memory_across_processes(self):
+        """Separate Python processes update one segment's counters, bank, ledger and channel."""
+        self.assertEqual(self.lib.shm_atomic_increment(1), -1)
+        name = self.attach_test_segment()
+        self.assertEqual(self.lib.shm_attach(name, 1), -1)  # Already attached
+        self.assertEqual(self.lib.shm_ledger_init(16, 100), 0)
+        self.assertEqual(self.lib.shm_ledger_init(5000, 100), -1)
+        
+        processes = 4
+        children = [
+            subprocess.Popen([sys.executable, "-c", SHM_CHILD_SCRIPT,
+                              str(Path(__file__).parent), name.decode(), str(worker)])
+            for worker in range(processes)
+        ]
+        self.lib.shm_atomic_increment(1000)
+        self.assertEqual([child.wait(timeout=60) for child in children], [0] * processes)
+        
+        stats = ShmStats()
+        self.assertEqual(self.lib.shm_get_stats(ctypes.byref(stats)), 0)
+        self.assertEqual(stats.attached_processes, 1)
+        self.assertEqual(stats.atomic_counter, (processes + 1) * 1000)
+        self.assertEqual(stats.safe_counter, processes * 1000)
+        self.assertEqual(stats.sharded_counter, processes * 1000)
+        self.assertEqual(stats.bank_balance, 1000 - processes * 10)
+        self.assertEqual(stats.ledger_total, 16 * 100)
+        self.assertEqual(stats.channel_size, processes)
+        
+        value = ctypes.c_long()
+        popped = []
+        while self.lib.shm_channel_try_pop(ctypes.byref(value)) == 1:
+            popped.append(value.value)
+        self.assertEqual(sorted(popped), list(range(processes)))
+        
+        self.assertEqual(self.lib.shm_ledger_transfer(0, 16, 1), -1)
+        self.assertEqual(self.lib.shm_ledger_balance(16), -1)
+        self.assertEqual(self.lib.shm_withdraw(10**6), 0)
+        self.assertEqual(self.lib.shm_attach(b"/threadtest-missing", 0), -1)
+    
+    def test_shm_benchmark(self):
+        """Compare contention on the segment between forked processes and threads."""
+        self.attach_test_segment()
+        iterations = 20000
+        print("\n  op        workers  mode            ops/s")
+        for name, op in SHM_BENCH_OPS.items():
+            for workers in (1, 4):
+                for processes in (0, 1):
+                    stats = ShmBenchStats()
+                    rc = self.lib.run_shm_benchmark(op, workers, iterations, processes,
+                                                    ctypes.byref(stats))
+                    self.assertEqual(rc, 0)
+                    self.assertEqual(stats.total_ops, workers * iterations)
+                    self.assertEqual(stats.observed, stats.expected)
+                    mode = "processes" if processes else "threads"
+                    print(f"  {name:8s}  {workers:7d}  {mode:9s}  {stats.ops_per_sec:12,.0f}")
+        
+        stats = ShmBenchStats()
+        self.assertEqual(self.lib.run_shm_benchmark(5, 1, 10, 0, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_shm_benchmark(0, 0, 10, 0, ctypes.byref(stats)), -1)
+    
+    def lock_profile(self):
+        """Per-site LockSiteStats keyed by mutex name."""
+        sites = {}
+        for site in range(self.lib.lock_profiler_site_count()):
+            stats = LockSiteStats()
+            self.assertEqual(self.lib.lock_profiler_get_site(site, ctypes.byref(stats)), 0)
+            sites[stats.name.decode()] = stats
+        return sites
+    
+    def test_lock_profiler(self):
+        """Wait/hold histograms per named mutex, and the JSON export for viz_bench_from_json.py."""
+        self.lib.reset_counters()
+        self.lib.lock_profiler_reset()
+        self.assertEqual(self.lib.lock_profiler_enable(1), 0)
+        self.addCleanup(self.lib.lock_profiler_enable, 0)
+        
+        threads, calls = 4, 200
+        def worker():
+            for i in range(calls):
+                self.lib.safe_increment(10)
+                self.lib.safe_write_buffer(b"profiled")
+                self.lib.safe_read()
+                if i % 4 == 0:
+                    self.lib.safe_write(i)
+        with ThreadPoolExecutor(max_workers=threads) as executor:
+            for future in [executor.submit(worker) for _ in range(threads)]:
+                future.result()
+        self.assertEqual(self.lib.lock_profiler_enable(0), 1)
+        self.lib.safe_increment(1)  # Not counted while disabled
+        
+        sites = self.lock_profile()
+        self.assertEqual(set(sites), {"global_mutex", "buffer_mutex", "shared_mutex",
+                                      "shared_mutex:shared", "singleton_mutex"})
+        expected = {"global_mutex": threads * calls, "buffer_mutex": threads * calls,
+                    "shared_mutex": threads * calls // 4, "shared_mutex:shared": threads * calls,
+                    "singleton_mutex": 0}
+        print("\n  site                   acquired  contended  wait p50/p99/max ns    hold p50/p99/max ns")
+        for name, stats in sites.items():
+            self.assertEqual(stats.acquisitions, expected[name], name)
+            self.assertLessEqual(stats.contended, stats.acquisitions)
+            if stats.acquisitions:
+                self.assertLessEqual(stats.wait_p50_ns, stats.wait_p99_ns)
+                self.assertLessEqual(stats.wait_p99_ns, stats.wait_max_ns)
+                self.assertGreater(stats.hold_max_ns, 0)
+            print(f"  {name:20s}  {stats.acquisitions:9d}  {stats.contended:9d}  "
+                  f"{stats.wait_p50_ns:6.0f}/{stats.wait_p99_ns:6.0f}/{stats.wait_max_ns:<8.0f}  "
+                  f"{stats.hold_p50_ns:6.0f}/{stats.hold_p99_ns:6.0f}/{stats.hold_max_ns:<8.0f}")
+        
+        size = self.lib.lock_profiler_dump_json(None, 0)
+        buffer = ctypes.create_string_buffer(size + 1)
+        self.assertEqual(self.lib.lock_profiler_dump_json(buffer, size + 1), size)
+        profile = json.loads(buffer.value.decode())
+        self.assertEqual(set(profile["sample_data"]), set(profile["method_stats"]))
+        self.assertIn("global_mutex wait", profile["sample_data"])
+        self.assertNotIn("singleton_mutex wait", profile["sample_data"])
+        self.assertTrue(all(len(v) == 200 for v in profile["sample_data"].values()))
+        for name, site in profile["lock_profile"]["sites"].items():
+            self.assertEqual(sum(site["wait_buckets"]), expected[name])
+            self.assertEqual(len(site["wait_buckets"]), len(profile["lock_profile"]["bucket_lower_ns"]))
+        
+        self.lib.lock_profiler_reset()
+        self.assertEqual(self.lock_profile()["global_mutex"].acquisitions, 0)
+        self.assertEqual(self.lib.lock_profiler_get_site(5, ctypes.byref(LockSiteStats())), -1)
+    
+    def test_native_scaling_bench(self):
+        """The native driver scales kernels over pinned threads and emits framework-style JSON."""
+        bench = Path(__file__).parent / "native_scaling_bench"
+        self.assertTrue(bench.exists(), "make all builds native_scaling_bench")
+        kernels = ["sum_doubles", "gemm", "atomic_counter", "mutex_counter", "channel"]
+        with tempfile.TemporaryDirectory() as tmp:
+            out = Path(tmp) / "scaling.json"
+            proc = subprocess.run([str(bench), "--threads", "1,2", "--samples", "3", "--scale", "0.05",
+                                   "--kernels", ",".join(kernels), "--out", str(out)],
+                                  capture_output=True, text=True, timeout=120)
+            self.assertEqual(proc.returncode, 0, proc.stderr)
+            results = json.loads(out.read_text())
+        print("\n" + proc.stderr.rstrip())
+        
+        self.assertEqual(results["methodology"], "native_thread_scaling")
+        self.assertEqual(set(results["sample_data"]), {f"{k}@{t}t" for k in kernels for t in (1, 2)})
+        self.assertTrue(all(len(v) == 3 for v in results["sample_data"].values()))
+        for row in results["scaling"]:
+            self.assertTrue(row["verified"], row["kernel"])
+            self.assertEqual(len(row["cpus"]), row["threads"])
+            self.assertGreater(row["ops_per_sec"], 0)
+        self.assertEqual([r["speedup"] for r in results["scaling"] if r["threads"] == 1], [1.0] * len(kernels))
+        
+        bad = subprocess.run([str(bench), "--kernels", "no_such_kernel"], capture_output=True, text=True)
+        self.assertEqual(bad.returncode, 2)
+    
+    def test_ledger_transfers(self):
+        """Test ledger transfers conserve money and never overdraw an account."""
+        accounts = 64
+        self.assertEqual(self.lib.ledger_init(accounts, 100), 0)
+        self.assertEqual(self.lib.ledger_account_count(), accounts)
+        self.assertEqual(self.lib.ledger_transfer(0, 1, 60), 1)
+        self.assertEqual(self.lib.ledger_transfer(0, 1, 60), 0)
+        self.assertEqual(self.lib.ledger_balance(0), 40)
+        self.assertEqual(self.lib.ledger_balance(1), 160)
+        self.assertEqual(self.lib.ledger_transfer(0, accounts, 1), -1)
+        self.assertEqual(self.lib.ledger_transfer(0, 1, -1), -1)
+        self.assertEqual(self.lib.ledger_balance(-1), -1)
+        
+        # Accounts 0 and 1024 share a lock stripe
+        self.assertEqual(self.lib.ledger_init(2048, 10), 0)
+        self.assertEqual(self.lib.ledger_transfer(0, 1024, 10), 1)
+        self.assertEqual(self.lib.ledger_balance(1024), 20)
+        
+        self.assertEqual(self.lib.ledger_init(accounts, 100), 0)
+        ops = (LedgerOp * 4)((0, 1, 50), (0, 2, 60), (3, 3, 5), (0, 99, 1))
+        results = (ctypes.c_int * 4)()
+        self.assertEqual(self.lib.ledger_batch_apply(ops, 4, results), 2)
+        self.assertEqual(list(results), [1, 0, 1, -1])
+        self.assertEqual(self.lib.ledger_batch_apply(ops, 4, None), 2)
+        self.assertEqual(self.lib.ledger_balance(0), 0)
+        self.assertEqual(self.lib.ledger_batch_apply(None, 1, None), -1)
+        
+        num_threads = 8
+        def worker(tid):
+            rng = random.Random(tid)
+            batch = (LedgerOp * 16)()
+            for _ in range(200):
+                for op in batch:
+                    op.from_account = rng.randrange(accounts)
+                    op.to_account = rng.randrange(accounts)
+                    op.amount = rng.randint(1, 40)
+                self.lib.ledger_batch_apply(batch, len(batch), None)
+                self.lib.ledger_transfer(rng.randrange(accounts), rng.randrange(accounts), 25)
+        
+        threads = [threading.Thread(target=worker, args=(t,)) for t in range(num_threads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join(timeout=60)
+            self.assertFalse(t.is_alive(), "ledger transfer deadlocked")
+        self.assertEqual(self.lib.ledger_total(), accounts * 100)
+        self.assertTrue(all(self.lib.ledger_balance(i) >= 0 for i in range(accounts)))
+    
+    def test_ledger_benchmark(self):
+        """Measure transfer throughput across thread counts and Zipf account skew."""
+        iterations = 4000
+        print("\n  zipf_s  batch  threads       ops/s   p50/p99 ns   hot share   refused")
+        for zipf_s in (0.0, 0.99, 1.5):
+            for batch in (1, 32):
+                for threads in (1, 4, 16):
+                    stats = LedgerBenchStats()
+                    rc = self.lib.run_ledger_benchmark(threads, iterations, 10000, zipf_s, batch,
+                                                       ctypes.byref(stats))
+                    self.assertEqual(rc, 0)
+                    self.assertEqual(stats.total_ops, threads * (iterations // batch) * batch)
+                    self.assertEqual(stats.moved + stats.insufficient, stats.total_ops)
+                    self.assertEqual(stats.imbalance, 0)
+                    self.assertGreaterEqual(stats.min_balance, 0)
+                    print(f"  {zipf_s:6.2f}  {batch:5d}  {threads:7d}  {stats.ops_per_sec:10,.0f}  "
+                          f"{stats.p50_op_ns:5.0f}/{stats.p99_op_ns:<6.0f}  {stats.hottest_share:9.4f}  "
+                          f"{stats.insufficient:8d}")
+        
+        stats = LedgerBenchStats()
+        self.assertEqual(self.lib.run_ledger_benchmark(1, 10, 1, 0.0, 1, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_ledger_benchmark(1, 10, 16, -1.0, 1, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_ledger_benchmark(1, 10, 16, 0.0, 11, ctypes.byref(stats)), -1)
+    
+    def test_jthread_worker_stops(self):
+        """Test stop_jthread_worker stops the thread start_jthread_worker started."""
+        self.lib.reset_counters()
+        self.lib.start_jthread_worker()
+        time.sleep(0.02)
+        self.lib.stop_jthread_worker()
+        stopped_at = self.lib.start_jthread_worker()  # Restarts; returns the current count
+        self.lib.stop_jthread_worker()
+        self.assertGreater(stopped_at, 0)
+        time.sleep(0.02)
+        final = self.lib.start_jthread_worker()
+        self.lib.stop_jthread_worker()
+        self.assertLessEqual(final - stopped_at, 2, "Worker kept running after stop")
+    
+    def test_task_pool(self):
+        """Test the work-stealing pool runs native tasks from many Python threads."""
+        add_task = ctypes.cast(self.lib.pool_task_add, ctypes.c_void_p)
+        spin_task = ctypes.cast(self.lib.pool_task_spin, ctypes.c_void_p)
+        
+        self.assertEqual(self.lib.pool_set_workers(4), 4)
+        self.assertEqual(self.lib.pool_worker_count(), 4)
+        self.lib.pool_reset_task_stats()
+        
+        counter = ctypes.c_long(0)
+        submitters = 4
+        per_thread = 5000
+        
+        def submit():
+            self.assertEqual(self.lib.pool_submit_n(add_task, ctypes.addressof(counter), per_thread), 0)
+        
+        threads = [threading.Thread(target=submit) for _ in range(submitters)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(self.lib.pool_wait_all(), 0)
+        self.assertEqual(counter.value, submitters * per_thread)
+        
+        # Tasks spawned by tasks go on worker deques and can be stolen
+        self.assertEqual(self.lib.pool_run_tree(12), 1 << 12)
+        stats = TaskPoolStats()
+        self.lib.pool_get_task_stats(ctypes.byref(stats))
+        self.assertEqual(stats.submitted, stats.executed)
+        self.assertEqual(stats.injected + stats.local_pushes, stats.submitted)
+        self.assertGreater(stats.local_pushes, 0)
+        
+        print("\n  workers   spin tasks   elapsed ms   steals")
+        for workers in (1, 2, 4, 8):
+            self.lib.pool_set_workers(workers)
+            self.lib.pool_reset_task_stats()
+            start = time.perf_counter()
+            self.lib.pool_submit_n(spin_task, 20000, 256)
+            self.lib.pool_wait_all()
+            elapsed = time.perf_counter() - start
+            self.lib.pool_get_task_stats(ctypes.byref(stats))
+            self.assertEqual(stats.executed, 256)
+            print(f"  {workers:7d}  {256:11d}  {elapsed * 1000:11.2f}  {stats.steals:7d}")
+        
+        self.assertEqual(self.lib.pool_submit(None, None), -1)
+        self.assertEqual(self.lib.pool_set_workers(-1), -1)
+        self.assertEqual(self.lib.pool_run_tree(-1), -1)
+        self.lib.pool_shutdown()
+        self.assertEqual(self.lib.pool_worker_count(), 0)
+    
+    def test_flat_combining(self):
+        """Test combining_* matches safe_* semantics and batches under contention."""
+        self.lib.reset_counters()
+        self.lib.combining_reset_stats()
+        
+        self.assertEqual(self.lib.combining_increment(5), 5)
+        self.assertEqual(self.lib.combining_multiply(3), 15)
+        self.assertEqual(self.lib.combining_decrement(5), 10)
+        self.assertEqual(self.lib.combining_complex_operation(1), 11 + 22)
+        self.assertEqual(self.lib.get_combining_counter(), 21)
+        
+        self.lib.reset_counters()
+        self.lib.combining_reset_stats()
+        num_threads = 8
+        calls = 500
+        
+        def worker():
+            for _ in range(calls):
+                self.lib.combining_increment(3)
+        
+        threads = [threading.Thread(target=worker) for _ in range(num_threads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(self.lib.get_combining_counter(), num_threads * calls * 3)
+        
+        stats = CombiningStats()
+        self.lib.combining_get_stats(ctypes.byref(stats))
+        self.assertEqual(stats.operations, num_threads * calls)
+        self.assertLessEqual(stats.passes, num_threads * calls, "At most one combining pass per call")
+        self.assertGreaterEqual(stats.max_batch, 1)
+        
+        # Native comparison against the mutex and atomic paths
+        print("\n  primitive   threads       ops/s   p50/p99 ns   ops/pass")
+        for threads in (1, 4, 16):
+            for name in ("mutex", "adaptive", "atomic", "combining"):
+                self.lib.combining_reset_stats()
+                bench = SyncBenchStats()
+                rc = self.lib.run_sync_benchmark(SYNC_PRIMITIVES[name], threads, 5000, ctypes.byref(bench))
+                self.assertEqual(rc, 0)
+                self.lib.combining_get_stats(ctypes.byref(stats))
+                per_pass = stats.operations / stats.passes if stats.passes else float('nan')
+                print(f"  {name:10s}  {threads:7d}  {bench.ops_per_sec:10,.0f}  "
+                      f"{bench.p50_acquire_ns:5.0f}/{bench.p99_acquire_ns:<6.0f}  {per_pass:8.2f}")
+    
+    def test_seqlock_and_rcu_consistency(self):
+        """Test seqlock and RCU readers never observe a half-written value."""
+        for read, write in (("seqlock_read", "seqlock_write"), ("rcu_read", "rcu_publish")):
+            read_fn = getattr(self.lib, read)
+            write_fn = getattr(self.lib, write)
+            write_fn(7)
+            self.assertEqual(read_fn(), 7)
+            
+            stop = threading.Event()
+            seen = []
+            
+            def reader():
+                while not stop.is_set():
+                    seen.append(read_fn())
+            
+            readers = [threading.Thread(target=reader) for _ in range(4)]
+            for t in readers:
+                t.start()
+            for value in range(1, 2001):
+                write_fn(value)
+            stop.set()
+            for t in readers:
+                t.join()
+            
+            self.assertEqual(read_fn(), 2000, f"{read} should see the last {write}")
+            self.assertTrue(all(0 <= v <= 2000 or v == 7 for v in seen))
+        
+        self.lib.reset_counters()
+        self.assertEqual(self.lib.seqlock_read(), 0)
+        self.assertEqual(self.lib.rcu_read(), 0)
+    
+    def test_rw_benchmark_table(self):
+        """Compare shared_mutex, seqlock and RCU reads across read/write ratios."""
+        iterations = 5000
+        print("\n  primitive     threads  writes/1000       ops/s   read p50/p99 ns   write p50/p99 ns   retries")
+        for write_permille in (0, 10, 100):
+            for threads in (1, 4, 16):
+                for name, primitive in RW_PRIMITIVES.items():
+                    stats = RwBenchStats()
+                    rc = self.lib.run_rw_benchmark(primitive, threads, iterations, write_permille,
+                                                   ctypes.byref(stats))
+                    self.assertEqual(rc, 0)
+                    self.assertEqual(stats.total_reads + stats.total_writes, threads * iterations)
+                    self.assertEqual(stats.torn_reads, 0, f"{name} returned a torn record")
+                    if write_permille == 0:
+                        self.assertEqual(stats.total_writes, 0)
+                    print(f"  {name:12s}  {threads:7d}  {write_permille:11d}  {stats.ops_per_sec:10,.0f}  "
+                          f"{stats.p50_read_ns:7.0f}/{stats.p99_read_ns:<7.0f}  "
+                          f"{stats.p50_write_ns:8.0f}/{stats.p99_write_ns:<8.0f}  {stats.read_retries:7d}")
+        
+        stats = RwBenchStats()
+        self.assertEqual(self.lib.run_rw_benchmark(5, 1, iterations, 10, ctypes.byref(stats)), -1)
+        self.assertEqual(self.lib.run_rw_benchmark(0, 1, iterations, 1001, ctypes.byref(stats)), -1)
+    
+    def test_hardware_counters(self):
+        """Test per-region counters around the native benchmarks."""
+        available = bool(self.lib.counters_available())
+        self.lib.counters_reset()
+        self.lib.counters_set_enabled(1)
+        try:
+            region = COUNTER_REGION_USER
+            self.lib.counters_begin(region)
+            self.lib.atomic_increment(10000)
+            self.lib.counters_end(region)
+            
+            sync_stats = SyncBenchStats()
+            self.lib.run_sync_benchmark(SYNC_PRIMITIVES["mutex"], 4, 2000, ctypes.byref(sync_stats))
+            alloc_stats = AllocBenchStats()
+            self.lib.run_alloc_benchmark(BENCH_ALLOCATORS["pool"], 4, 2000, ctypes.byref(alloc_stats))
+        finally:
+            self.lib.counters_set_enabled(0)
+        
+        regions = {"user": region, **COUNTER_REGIONS}
+        expected_threads = {"user": 1, "sync_bench": 4, "alloc_bench": 4}
+        print("\n  region        calls        cycles  instructions    IPC  LLC/kinstr  br-miss/kinstr")
+        for name, region_id in regions.items():
+            stats = CounterStats()
+            self.lib.counters_read(region_id, ctypes.byref(stats))
+            if not available:
+                self.assertEqual(stats.calls, 0, "Unavailable counters should record nothing")
+                continue
+            self.assertEqual(stats.threads, expected_threads[name])
+            self.assertEqual(stats.calls, expected_threads[name])
+            self.assertGreater(stats.instructions, 0)
+            print(f"  {name:12s}  {stats.calls:5d}  {stats.cycles:12d}  {stats.instructions:12d}  "
+                  f"{stats.ipc:5.2f}  {stats.llc_misses_per_kinstr:10.3f}  "
+                  f"{stats.branch_misses_per_kinstr:14.3f}")
+        if not available:
+            print("  perf_event_open unavailable (see /proc/sys/kernel/perf_event_paranoid)")
+        
+        self.lib.counters_reset()
+        stats = CounterStats()
+        self.lib.counters_read(COUNTER_REGION_USER, ctypes.byref(stats))
+        self.assertEqual(stats.calls, 0)
+        self.lib.counters_read(-1, ctypes.byref(stats))
+        self.assertEqual(stats.calls, 0)
+    
+    def test_channel_try_push_pop(self):
+        """Test non-blocking and batch channel operations on a single thread."""
+        channel = self.lib.channel_create(3)  # Rounded up to 4
+        self.assertTrue(channel)
+        try:
+            out = ctypes.c_long()
+            self.assertEqual(self.lib.channel_try_pop(channel, ctypes.byref(out)), 0)
+            
+            for value in range(4):
+                self.assertEqual(self.lib.channel_try_push(channel, value), 1)
+            self.assertEqual(self.lib.channel_try_push(channel, 99), 0, "Full channel should reject")
+            self.assertEqual(self.lib.channel_size(channel), 4)
+            
+            popped = (ctypes.c_long * 8)()
+            self.assertEqual(self.lib.channel_pop_batch(channel, popped, 8), 4)
+            self.assertEqual(list(popped[:4]), [0, 1, 2, 3], "Channel should be FIFO")
+            
+            values = (ctypes.c_long * 6)(*range(10, 16))
+            self.assertEqual(self.lib.channel_push_batch(channel, values, 6), 4)
+            self.assertEqual(self.lib.channel_try_pop(channel, ctypes.byref(out)), 1)
+            self.assertEqual(out.value, 10)
+        finally:
+            self.lib.channel_destroy(channel)
+        
+        self.assertFalse(self.lib.channel_create(0))
+    
+    def test_channel_capacity_one(self):
+        """Test a capacity-1 channel (rounded up to 2) stays FIFO across wraps."""
+        channel = self.lib.channel_create(1)
+        self.assertTrue(channel)
+        try:
+            out = ctypes.c_long()
+            for round_ in range(4):
+                self.assertEqual(self.lib.channel_try_push(channel, round_ * 2), 1)
+                self.assertEqual(self.lib.channel_try_push(channel, round_ * 2 + 1), 1)
+                self.assertEqual(self.lib.channel_try_push(channel, 99), 0, "Full channel should reject")
+                self.assertEqual(self.lib.channel_size(channel), 2)
+                for expected in (round_ * 2, round_ * 2 + 1):
+                    self.assertEqual(self.lib.channel_try_pop(channel, ctypes.byref(out)), 1)
+                    self.assertEqual(out.value, expected)
+                self.assertEqual(self.lib.channel_try_pop(channel, ctypes.byref(out)), 0)
+        finally:
+            self.lib.channel_destroy(channel)
+    
+    def test_channel_blocking_mpmc(self):
+        """Test blocking push/pop delivers every item exactly once across threads."""
+        num_producers = 4
+        num_consumers = 4
+        items_per_producer = 20000
+        channel = self.lib.channel_create(64)
+        received = [[] for _ in range(num_consumers)]
+        
+        def producer(pid):
+            base = pid * items_per_producer
+            for i in range(items_per_producer):
+                self.lib.channel_push(channel, base + i)
+        
+        def consumer(cid):
+            out = ctypes.c_long()
+            while self.lib.channel_pop(channel, ctypes.byref(out)):
+                received[cid].append(out.value)
+        
+        try:
+            consumers = [threading.Thread(target=consumer, args=(c,)) for c in range(num_consumers)]
+            producers = [threading.Thread(target=producer, args=(p,)) for p in range(num_producers)]
+            start = time.perf_counter()
+            for t in consumers + producers:
+                t.start()
+            for t in producers:
+                t.join()
+            self.lib.channel_close(channel)
+            for t in consumers:
+                t.join()
+            elapsed = time.perf_counter() - start
+            
+            # A closed channel rejects pushes, blocking or not
+            self.assertEqual(self.lib.channel_push(channel, -1), 0)
+            self.assertEqual(self.lib.channel_try_push(channel, -1), 0)
+            values = (ctypes.c_long * 2)(-1, -2)
+            self.assertEqual(self.lib.channel_push_batch(channel, values, 2), 0)
+        finally:
+            self.lib.channel_destroy(channel)
+        
+        total = num_producers * items_per_producer
+        all_items = sorted(v for items in received for v in items)
+        self.assertEqual(all_items, list(range(total)), "Items lost or duplicated")
+        print(f"\n  channel: {total / elapsed:,.0f} items/s through {num_producers}x{num_consumers} Python threads")
+    
     @classmethod
     def tearDownClass(cls):
         """Clean up built libraries."""
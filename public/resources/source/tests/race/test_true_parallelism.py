@@ -14,8 +14,10 @@ import json
 import statistics
 from pathlib import Path
 from concurrent.futures import ThreadPoolExecutor, ProcessPoolExecutor
-from dataclasses import dataclass
-from typing import List, Dict, Tuple
+from dataclasses import dataclass, field
+from typing import List, Dict, Tuple, Optional
+
+import threadtest_loader
 
 
 @dataclass
@@ -26,6 +28,7 @@ class ScalingResult:
     throughput: float
     speedup: float
     efficiency: float
+    stats: Dict = field(default_factory=dict)  # Native state read back after the run
     
     def to_dict(self):
         return {
@@ -33,7 +36,8 @@ class ScalingResult:
             "execution_time": self.execution_time,
             "throughput": self.throughput,
             "speedup": self.speedup,
-            "efficiency": self.efficiency
+            "efficiency": self.efficiency,
+            "stats": self.stats
         }
 
 
@@ -55,7 +59,7 @@ class TestTrueParallelism(unittest.TestCase):
         }
         
         # Load the thread test library
-        cls.lib_path = cls.test_dir / "libthreadtest.so"
+        cls.lib_path = threadtest_loader.library_path()
         if cls.lib_path.exists():
             cls.lib = ctypes.CDLL(str(cls.lib_path))
             cls._setup_library_functions()
@@ -174,8 +178,148 @@ print(f"TIME: {{elapsed}}")
         if not self.lib:
             self.skipTest("Thread test library not available")
         
-        results = {}
+        results = self._run_ffi_scaling("atomic_increment")
+        self._verify_ffi_scaling(results)
+    
+    def test_sharded_counter_scaling(self):
+        """Compare contended atomic_increment against per-thread sharded_increment."""
+        if not self.lib:
+            self.skipTest("Thread test library not available")
+        
         iterations = 100000
+        runs = self._compare_ffi_scaling("Contended vs sharded counter", {
+            "atomic_increment": {"counter": "get_atomic_counter"},
+            "sharded_increment": {"counter": "get_sharded_counter"},
+        }, iterations=iterations)
+        
+        for results in runs.values():
+            self._assert_exact_counts(results, iterations)
+        for build_name, build_results in runs["sharded_increment"].items():
+            for result in build_results:
+                # Each thread returns only its own slot, so nothing was shared
+                self.assertEqual(result.stats["returns"], [iterations] * result.thread_count,
+                                 f"{build_name}: threads shared a shard at {result.thread_count} threads")
+    
+    def test_adaptive_mutex_scaling(self):
+        """Compare safe_increment on std::mutex against the spin-then-park adaptive_increment."""
+        if not self.lib:
+            self.skipTest("Thread test library not available")
+        
+        iterations = 100000
+        fields = ["acquisitions", "uncontended", "spin_acquisitions", "spin_iterations",
+                  "parks", "handoffs"]
+        runs = self._compare_ffi_scaling("std::mutex vs adaptive mutex", {
+            "safe_increment": {"counter": "get_safe_counter"},
+            "adaptive_increment": {"counter": "get_adaptive_counter",
+                                   "lock_stats": ("adaptive_get_stats", "adaptive_reset_stats", fields)},
+        }, iterations=iterations)
+        
+        for results in runs.values():
+            self._assert_exact_counts(results, iterations)
+        for build_name, build_results in runs["adaptive_increment"].items():
+            for result in build_results:
+                lock = result.stats["lock"]
+                label = f"{build_name} at {result.thread_count} threads"
+                # One lock per call, every thread got it, and each unlock wakes at most one sleeper
+                self.assertEqual(lock["acquisitions"], result.thread_count, label)
+                self.assertLessEqual(lock["uncontended"] + lock["spin_acquisitions"],
+                                     lock["acquisitions"], label)
+                self.assertLessEqual(lock["handoffs"], lock["acquisitions"], label)
+                if result.thread_count == 1:
+                    self.assertEqual(lock["uncontended"], lock["acquisitions"], label)
+                    self.assertEqual(lock["parks"], 0, label)
+    
+    def test_flat_combining_scaling(self):
+        """Compare many short safe/atomic/combining calls, where lock hand-offs dominate."""
+        if not self.lib:
+            self.skipTest("Thread test library not available")
+        
+        calls = 20000
+        runs = self._compare_ffi_scaling("Mutex vs atomic vs flat combining", {
+            "safe_increment": {"counter": "get_safe_counter"},
+            "atomic_increment": {"counter": "get_atomic_counter"},
+            "combining_increment": {"counter": "get_combining_counter",
+                                    "lock_stats": ("combining_get_stats", "combining_reset_stats",
+                                                   ["operations", "passes", "max_batch"])},
+        }, iterations=1, calls=calls)
+        
+        for results in runs.values():
+            self._assert_exact_counts(results, 1, calls)
+        for build_name, build_results in runs["combining_increment"].items():
+            for result in build_results:
+                passes = result.stats["lock"]
+                label = f"{build_name} at {result.thread_count} threads"
+                # Every posted op applied exactly once, at most one per thread per pass
+                self.assertEqual(passes["operations"], result.thread_count * calls, label)
+                self.assertLessEqual(passes["passes"], passes["operations"], label)
+                self.assertLessEqual(passes["max_batch"], result.thread_count, label)
+                if result.thread_count == 1:
+                    self.assertEqual(passes["passes"], passes["operations"], label)
+    
+    def _compare_ffi_scaling(self, title: str, variants: Dict[str, Dict],
+                             **kwargs) -> Dict[str, Dict[str, List[ScalingResult]]]:
+        """Run every variant across 1..N threads and print its time against the last one.
+        
+        `variants` maps function name to extra _run_ffi_scaling arguments; the last
+        entry is the candidate the others are compared to. Returns results by name.
+        """
+        runs = {name: self._run_ffi_scaling(name, **kwargs, **extra)
+                for name, extra in variants.items()}
+        names = list(variants)
+        candidate = names[-1]
+        
+        for build_name, build_results in runs[candidate].items():
+            if not build_results:
+                continue
+            
+            print(f"\n{title} for {build_name}:")
+            by_threads = {name: {r.thread_count: r for r in runs[name].get(build_name, [])}
+                          for name in names}
+            for result in build_results:
+                cells = []
+                for name in names:
+                    run = by_threads[name].get(result.thread_count)
+                    if run is None:
+                        continue
+                    cell = f"{name}: {run.execution_time:.3f}s"
+                    if name != candidate and result.execution_time > 0:
+                        cell += f" ({run.execution_time / result.execution_time:.2f}x)"
+                    cells.append(cell)
+                print(f"  Threads: {result.thread_count}, {', '.join(cells)}")
+        
+        self._verify_ffi_scaling(runs[candidate])
+        return runs
+    
+    def _assert_exact_counts(self, results: Dict[str, List[ScalingResult]],
+                             iterations: int, calls: int = 1):
+        """Every increment from every thread must be in the final counter."""
+        for build_name, build_results in results.items():
+            for result in build_results:
+                self.assertEqual(result.stats["count"],
+                                 result.thread_count * calls * iterations,
+                                 f"{build_name}: lost updates at {result.thread_count} threads")
+                self.assertEqual(len(result.stats["returns"]), result.thread_count)
+    
+    def _run_ffi_scaling(self, func_name: str, iterations: int = 100000,
+                         calls: int = 1, counter: Optional[str] = None,
+                         lock_stats: Optional[Tuple[str, str, List[str]]] = None
+                         ) -> Dict[str, List[ScalingResult]]:
+        """Run `func_name(iterations)` `calls` times from 1..N Python threads in every build.
+        
+        Each result's stats hold every thread's last return value, the `counter`
+        getter's final value, and, for `lock_stats` = (get_fn, reset_fn, fields),
+        the struct of longs get_fn fills (reset after warm-up) under "lock".
+        """
+        results = {}
+        
+        # Optional read-back snippets spliced into the test code below
+        reset_lock = f"lib.{lock_stats[1]}()" if lock_stats else ""
+        read_lock = (f"fields = {list(lock_stats[2])!r}\n"
+                     f"buf = (ctypes.c_long * len(fields))()\n"
+                     f"lib.{lock_stats[0]}(buf)\n"
+                     f"stats['lock'] = dict(zip(fields, buf))" if lock_stats else "")
+        read_counter = (f"lib.{counter}.restype = ctypes.c_long\n"
+                        f"stats['count'] = lib.{counter}()" if counter else "")
         
         for build_name, python_path in self.python_builds.items():
             if not python_path.exists():
@@ -187,6 +331,7 @@ print(f"TIME: {{elapsed}}")
                 # Test code for FFI scaling
                 test_code = f"""
 import ctypes
+import json
 import threading
 import time
 from pathlib import Path
@@ -194,18 +339,27 @@ from pathlib import Path
 # Load library
 lib_path = Path("{self.lib_path}")
 lib = ctypes.CDLL(str(lib_path))
-lib.atomic_increment.argtypes = [ctypes.c_int]
-lib.atomic_increment.restype = ctypes.c_long
+lib.{func_name}.argtypes = [ctypes.c_int]
+lib.{func_name}.restype = ctypes.c_long
 lib.reset_counters.argtypes = []
 lib.reset_counters.restype = None
 
-def ffi_work():
-    lib.atomic_increment({iterations})
+returns = []
+
+def ffi_work(record=True):
+    for _ in range({calls}):
+        last = lib.{func_name}({iterations})
+    if record:
+        returns.append(last)
+
+def reset():
+    lib.reset_counters()
+    {reset_lock}
 
 # Reset and warm up
-lib.reset_counters()
-ffi_work()
-lib.reset_counters()
+reset()
+ffi_work(record=False)
+reset()
 
 # Measure
 start = time.perf_counter()
@@ -220,6 +374,12 @@ for t in threads:
     t.join()
 
 elapsed = time.perf_counter() - start
+
+# Lock stats first: the counter getters take the lock themselves
+stats = {{"returns": sorted(returns)}}
+{read_lock}
+{read_counter}
+print(f"STATS: {{json.dumps(stats)}}")
 print(f"TIME: {{elapsed}}")
 """
                 
@@ -234,6 +394,10 @@ print(f"TIME: {{elapsed}}")
                     if "TIME:" in output:
                         time_str = output.split("TIME:")[1].strip()
                         elapsed = float(time_str)
+                        stats = {}
+                        for line in output.splitlines():
+                            if line.startswith("STATS:"):
+                                stats = json.loads(line[len("STATS:"):])
                         
                         # Calculate metrics
                         baseline = build_results[0].execution_time if build_results else elapsed
@@ -246,14 +410,15 @@ print(f"TIME: {{elapsed}}")
                             execution_time=elapsed,
                             throughput=throughput,
                             speedup=speedup,
-                            efficiency=efficiency
+                            efficiency=efficiency,
+                            stats=stats
                         )
                         
                         build_results.append(scaling_result)
             
             results[build_name] = build_results
         
-        self._verify_ffi_scaling(results)
+        return results
     
     def test_memory_bandwidth_scaling(self):
         """Test memory bandwidth utilization under concurrent access."""
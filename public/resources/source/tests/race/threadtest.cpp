@@ -5,15 +5,24 @@
  * demonstrate race conditions in FFI calls from Python.
  * 
  * Compile with -fsanitize=thread for ThreadSanitizer support
+ *
+ * Structs passed across the FFI are mirrored field for field by
+ * ctypes.Structure classes in test_thread_library.py; keep the two in step.
  */
 
+#include <algorithm>
 #include <atomic>
 #include <barrier>
+#include <bit>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <expected>
 #include <latch>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <optional>
 #include <ranges>
 #include <semaphore>
 #include <span>
@@ -22,10 +31,31 @@
 #include <string_view>
 #include <thread>
 #include <vector>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <print>
 #include <format>
 #include <shared_mutex>
+#include <cstdio>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+// Native helpers shared with the pybind11 module
+#include "perf_counters.hpp"
+#include "pool_allocator.hpp"
 
 // Feature detection for jthread/stop_token
 #if defined(__has_include)
@@ -39,9 +69,509 @@
 #  endif
 #endif
 
+// Cache-line size used to pad per-thread slots against false sharing
+#ifdef __cpp_lib_hardware_interference_size
+#  define THREADTEST_CACHE_LINE std::hardware_destructive_interference_size
+#else
+#  define THREADTEST_CACHE_LINE 64
+#endif
+
 // Export C interface for Python FFI
 extern "C" {
 
+// ============================================================================
+// LOCK PROFILER - Wait and hold histograms for the named mutexes below
+// ============================================================================
+
+// TSAN reports whether the locks are correct, not what they cost. Each named
+// mutex is a profiled site: after lock_profiler_enable(1), every acquisition
+// records how long the caller waited and how long it held the lock into the
+// calling thread's own histograms, so the hot path only writes lines that
+// thread owns. While disabled (the default) a lock costs one relaxed load
+// more than the bare std::mutex.
+enum LockSite : int {
+    LOCK_SITE_GLOBAL = 0,        // global_mutex
+    LOCK_SITE_BUFFER = 1,        // buffer_mutex
+    LOCK_SITE_SHARED_WRITE = 2,  // shared_mutex, exclusive
+    LOCK_SITE_SHARED_READ = 3,   // shared_mutex, shared
+    LOCK_SITE_SINGLETON = 4,     // singleton_mutex
+    LOCK_SITE_COUNT = 5,
+};
+
+static constexpr const char* LOCK_SITE_NAMES[LOCK_SITE_COUNT] = {
+    "global_mutex", "buffer_mutex", "shared_mutex", "shared_mutex:shared", "singleton_mutex",
+};
+
+// Log-linear buckets: exact below 8 ns, then 8 per power of two (12.5%
+// resolution) up to 2^36 ns; anything longer lands in the last bucket
+static constexpr int LOCK_HIST_SUB_BITS = 3;
+static constexpr int LOCK_HIST_SUB = 1 << LOCK_HIST_SUB_BITS;
+static constexpr int LOCK_HIST_MAX_BITS = 36;
+static constexpr int LOCK_HIST_BUCKETS =
+    LOCK_HIST_SUB + (LOCK_HIST_MAX_BITS - LOCK_HIST_SUB_BITS) * LOCK_HIST_SUB;
+
+static int lock_hist_bucket(std::uint64_t ns) {
+    if (ns < LOCK_HIST_SUB) return static_cast<int>(ns);
+    int exponent = std::bit_width(ns) - 1;
+    if (exponent >= LOCK_HIST_MAX_BITS) return LOCK_HIST_BUCKETS - 1;
+    int sub = static_cast<int>((ns >> (exponent - LOCK_HIST_SUB_BITS)) & (LOCK_HIST_SUB - 1));
+    return LOCK_HIST_SUB + (exponent - LOCK_HIST_SUB_BITS) * LOCK_HIST_SUB + sub;
+}
+
+static std::uint64_t lock_hist_lower_ns(int bucket) {
+    if (bucket < LOCK_HIST_SUB) return static_cast<std::uint64_t>(bucket);
+    int shift = (bucket - LOCK_HIST_SUB) / LOCK_HIST_SUB;
+    std::uint64_t sub = static_cast<std::uint64_t>((bucket - LOCK_HIST_SUB) % LOCK_HIST_SUB);
+    return (LOCK_HIST_SUB + sub) << shift;
+}
+
+static std::uint64_t lock_hist_width_ns(int bucket) {
+    if (bucket < LOCK_HIST_SUB) return 1;
+    return std::uint64_t{1} << ((bucket - LOCK_HIST_SUB) / LOCK_HIST_SUB);
+}
+
+// Single writer (the owning thread), so updates are load + store, not RMW
+static void lock_stat_add(std::atomic<std::uint64_t>& stat, std::uint64_t by) {
+    stat.store(stat.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+struct LockHistogram {
+    std::atomic<std::uint64_t> buckets[LOCK_HIST_BUCKETS];
+    std::atomic<std::uint64_t> total_ns;
+    std::atomic<std::uint64_t> max_ns;
+};
+
+static void lock_hist_add(LockHistogram& hist, std::uint64_t ns) {
+    lock_stat_add(hist.buckets[lock_hist_bucket(ns)], 1);
+    lock_stat_add(hist.total_ns, ns);
+    if (ns > hist.max_ns.load(std::memory_order_relaxed)) {
+        hist.max_ns.store(ns, std::memory_order_relaxed);
+    }
+}
+
+struct LockSiteRecord {
+    std::atomic<std::uint64_t> acquisitions;
+    std::atomic<std::uint64_t> contended;  // The first try_lock failed
+    LockHistogram wait;
+    LockHistogram hold;
+    std::int64_t acquired_at;  // Owner only; 0 unless held under profiling
+    std::uint64_t acquired_epoch;  // lock_profiler_epoch when acquired_at was set
+};
+
+// Reused like CombiningRecord: an exiting thread's record, counts included,
+// passes to the next thread that profiles a lock
+struct alignas(THREADTEST_CACHE_LINE) LockProfileRecord {
+    LockSiteRecord sites[LOCK_SITE_COUNT]{};
+    std::atomic<bool> in_use{false};
+    LockProfileRecord* next = nullptr;  // Immutable once linked
+};
+
+static std::atomic<LockProfileRecord*> lock_profile_records{nullptr};
+static std::atomic<bool> lock_profiler_on{false};
+static std::atomic<std::uint64_t> lock_profiler_epoch{0};  // Bumped each time profiling turns on
+
+static LockProfileRecord* acquire_lock_profile_record() {
+    for (LockProfileRecord* rec = lock_profile_records.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next) {
+        bool expected = false;
+        if (!rec->in_use.load(std::memory_order_relaxed) &&
+            rec->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return rec;
+        }
+    }
+    auto* rec = new LockProfileRecord;
+    rec->in_use.store(true, std::memory_order_relaxed);
+    rec->next = lock_profile_records.load(std::memory_order_relaxed);
+    while (!lock_profile_records.compare_exchange_weak(rec->next, rec, std::memory_order_release,
+                                                       std::memory_order_relaxed)) {
+    }
+    return rec;
+}
+
+struct LockProfileHandle {
+    LockProfileRecord* record = nullptr;  // Acquired on the first profiled lock
+    ~LockProfileHandle() {
+        if (record != nullptr) record->in_use.store(false, std::memory_order_release);
+    }
+};
+
+static thread_local LockProfileHandle lock_profile_handle;
+
+static std::int64_t lock_profile_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void lock_profile_acquired(int site, std::int64_t started_at, bool contended) {
+    if (lock_profile_handle.record == nullptr) {
+        lock_profile_handle.record = acquire_lock_profile_record();
+    }
+    LockSiteRecord& rec = lock_profile_handle.record->sites[site];
+    std::int64_t now = lock_profile_clock_ns();
+    lock_stat_add(rec.acquisitions, 1);
+    if (contended) lock_stat_add(rec.contended, 1);
+    lock_hist_add(rec.wait, static_cast<std::uint64_t>(now - started_at));
+    rec.acquired_at = now;
+    rec.acquired_epoch = lock_profiler_epoch.load(std::memory_order_relaxed);
+}
+
+// Only runs while enabled, so a hold that straddles lock_profiler_enable(0)
+// leaves acquired_at set; the epoch check drops it rather than charging the
+// whole gap to the next unlock after profiling is turned back on
+static void lock_profile_released(int site) {
+    LockProfileRecord* record = lock_profile_handle.record;
+    if (record == nullptr) return;
+    LockSiteRecord& rec = record->sites[site];
+    if (rec.acquired_at == 0) return;
+    if (rec.acquired_epoch != lock_profiler_epoch.load(std::memory_order_relaxed)) {
+        rec.acquired_at = 0;
+        return;
+    }
+    lock_hist_add(rec.hold, static_cast<std::uint64_t>(lock_profile_clock_ns() - rec.acquired_at));
+    rec.acquired_at = 0;
+}
+
+// Try and blocking acquire for lock_profiled
+using LockTryFn = bool (*)(void*);
+using LockFn = void (*)(void*);
+
+static void lock_profiled(int site, void* mutex, LockTryFn try_lock, LockFn lock) {
+    std::int64_t started_at = lock_profile_clock_ns();
+    bool contended = !try_lock(mutex);
+    if (contended) lock(mutex);
+    lock_profile_acquired(site, started_at, contended);
+}
+
+// Drop-in std::mutex: same Lockable interface, so scoped_lock, lock_guard
+// and unique_lock work on it unchanged
+class ProfiledMutex {
+public:
+    explicit constexpr ProfiledMutex(LockSite site) : site_(site) {}
+
+    void lock() {
+        if (!lock_profiler_on.load(std::memory_order_relaxed)) {
+            mutex_.lock();
+            return;
+        }
+        lock_profiled(site_, &mutex_,
+                      [](void* m) { return static_cast<std::mutex*>(m)->try_lock(); },
+                      [](void* m) { static_cast<std::mutex*>(m)->lock(); });
+    }
+
+    bool try_lock() {
+        if (!lock_profiler_on.load(std::memory_order_relaxed)) return mutex_.try_lock();
+        std::int64_t started_at = lock_profile_clock_ns();
+        if (!mutex_.try_lock()) return false;
+        lock_profile_acquired(site_, started_at, false);
+        return true;
+    }
+
+    void unlock() {
+        if (lock_profiler_on.load(std::memory_order_relaxed)) lock_profile_released(site_);
+        mutex_.unlock();
+    }
+
+private:
+    std::mutex mutex_;
+    const LockSite site_;
+};
+
+// std::shared_mutex with the exclusive and shared sides as separate sites
+class ProfiledSharedMutex {
+public:
+    void lock() {
+        if (!lock_profiler_on.load(std::memory_order_relaxed)) {
+            mutex_.lock();
+            return;
+        }
+        lock_profiled(LOCK_SITE_SHARED_WRITE, &mutex_,
+                      [](void* m) { return static_cast<std::shared_mutex*>(m)->try_lock(); },
+                      [](void* m) { static_cast<std::shared_mutex*>(m)->lock(); });
+    }
+
+    bool try_lock() {
+        if (!lock_profiler_on.load(std::memory_order_relaxed)) return mutex_.try_lock();
+        std::int64_t started_at = lock_profile_clock_ns();
+        if (!mutex_.try_lock()) return false;
+        lock_profile_acquired(LOCK_SITE_SHARED_WRITE, started_at, false);
+        return true;
+    }
+
+    void unlock() {
+        if (lock_profiler_on.load(std::memory_order_relaxed)) lock_profile_released(LOCK_SITE_SHARED_WRITE);
+        mutex_.unlock();
+    }
+
+    void lock_shared() {
+        if (!lock_profiler_on.load(std::memory_order_relaxed)) {
+            mutex_.lock_shared();
+            return;
+        }
+        lock_profiled(LOCK_SITE_SHARED_READ, &mutex_,
+                      [](void* m) { return static_cast<std::shared_mutex*>(m)->try_lock_shared(); },
+                      [](void* m) { static_cast<std::shared_mutex*>(m)->lock_shared(); });
+    }
+
+    bool try_lock_shared() {
+        if (!lock_profiler_on.load(std::memory_order_relaxed)) return mutex_.try_lock_shared();
+        std::int64_t started_at = lock_profile_clock_ns();
+        if (!mutex_.try_lock_shared()) return false;
+        lock_profile_acquired(LOCK_SITE_SHARED_READ, started_at, false);
+        return true;
+    }
+
+    void unlock_shared() {
+        if (lock_profiler_on.load(std::memory_order_relaxed)) lock_profile_released(LOCK_SITE_SHARED_READ);
+        mutex_.unlock_shared();
+    }
+
+private:
+    std::shared_mutex mutex_;
+};
+
+// One site summed over every thread's record
+struct LockSiteTotals {
+    std::uint64_t acquisitions = 0;
+    std::uint64_t contended = 0;
+    std::uint64_t wait_buckets[LOCK_HIST_BUCKETS] = {};
+    std::uint64_t hold_buckets[LOCK_HIST_BUCKETS] = {};
+    std::uint64_t wait_count = 0;
+    std::uint64_t hold_count = 0;
+    std::uint64_t wait_total_ns = 0;
+    std::uint64_t hold_total_ns = 0;
+    std::uint64_t wait_max_ns = 0;
+    std::uint64_t hold_max_ns = 0;
+};
+
+static std::uint64_t lock_hist_merge(const LockHistogram& hist, std::uint64_t* buckets,
+                                     std::uint64_t& total_ns, std::uint64_t& max_ns) {
+    std::uint64_t count = 0;
+    for (int b = 0; b < LOCK_HIST_BUCKETS; b++) {
+        std::uint64_t n = hist.buckets[b].load(std::memory_order_relaxed);
+        buckets[b] += n;
+        count += n;
+    }
+    total_ns += hist.total_ns.load(std::memory_order_relaxed);
+    max_ns = std::max(max_ns, hist.max_ns.load(std::memory_order_relaxed));
+    return count;
+}
+
+static void lock_site_totals(int site, LockSiteTotals& totals) {
+    for (LockProfileRecord* rec = lock_profile_records.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next) {
+        const LockSiteRecord& s = rec->sites[site];
+        totals.acquisitions += s.acquisitions.load(std::memory_order_relaxed);
+        totals.contended += s.contended.load(std::memory_order_relaxed);
+        totals.wait_count += lock_hist_merge(s.wait, totals.wait_buckets, totals.wait_total_ns,
+                                             totals.wait_max_ns);
+        totals.hold_count += lock_hist_merge(s.hold, totals.hold_buckets, totals.hold_total_ns,
+                                             totals.hold_max_ns);
+    }
+}
+
+// Midpoint of the bucket holding the p-quantile, capped at the exact maximum
+static double lock_hist_percentile(const std::uint64_t* buckets, std::uint64_t count,
+                                   std::uint64_t max_ns, double p) {
+    if (count == 0) return 0.0;
+    auto rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(count)));
+    rank = std::clamp<std::uint64_t>(rank, 1, count);
+    std::uint64_t seen = 0;
+    for (int b = 0; b < LOCK_HIST_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            double mid = static_cast<double>(lock_hist_lower_ns(b)) +
+                         static_cast<double>(lock_hist_width_ns(b) - 1) / 2.0;
+            return std::min(mid, static_cast<double>(max_ns));
+        }
+    }
+    return static_cast<double>(max_ns);
+}
+
+// Returns the previous setting
+int lock_profiler_enable(int enabled) {
+    bool was_on = lock_profiler_on.exchange(enabled != 0, std::memory_order_relaxed);
+    if (enabled != 0 && !was_on) lock_profiler_epoch.fetch_add(1, std::memory_order_relaxed);
+    return was_on ? 1 : 0;
+}
+
+// Zeroes every thread's counts. Threads locking concurrently can keep a
+// few samples, since each record has a single writer and no RMW.
+void lock_profiler_reset() {
+    for (LockProfileRecord* rec = lock_profile_records.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next) {
+        for (LockSiteRecord& s : rec->sites) {
+            s.acquisitions.store(0, std::memory_order_relaxed);
+            s.contended.store(0, std::memory_order_relaxed);
+            for (LockHistogram* hist : {&s.wait, &s.hold}) {
+                for (auto& bucket : hist->buckets) bucket.store(0, std::memory_order_relaxed);
+                hist->total_ns.store(0, std::memory_order_relaxed);
+                hist->max_ns.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+int lock_profiler_site_count() {
+    return LOCK_SITE_COUNT;
+}
+
+// Filled by lock_profiler_get_site
+struct LockSiteStats {
+    char name[32];
+    long acquisitions;
+    long contended;
+    double wait_mean_ns;
+    double wait_p50_ns;
+    double wait_p99_ns;
+    double wait_max_ns;
+    double hold_mean_ns;
+    double hold_p50_ns;
+    double hold_p99_ns;
+    double hold_max_ns;
+};
+
+int lock_profiler_get_site(int site, LockSiteStats* out_stats) {
+    if (site < 0 || site >= LOCK_SITE_COUNT || out_stats == nullptr) return -1;
+    auto totals = std::make_unique<LockSiteTotals>();
+    lock_site_totals(site, *totals);
+
+    LockSiteStats stats{};
+    std::snprintf(stats.name, sizeof(stats.name), "%s", LOCK_SITE_NAMES[site]);
+    stats.acquisitions = static_cast<long>(totals->acquisitions);
+    stats.contended = static_cast<long>(totals->contended);
+    if (totals->wait_count > 0) {
+        stats.wait_mean_ns = static_cast<double>(totals->wait_total_ns) / static_cast<double>(totals->wait_count);
+    }
+    if (totals->hold_count > 0) {
+        stats.hold_mean_ns = static_cast<double>(totals->hold_total_ns) / static_cast<double>(totals->hold_count);
+    }
+    stats.wait_p50_ns = lock_hist_percentile(totals->wait_buckets, totals->wait_count, totals->wait_max_ns, 0.50);
+    stats.wait_p99_ns = lock_hist_percentile(totals->wait_buckets, totals->wait_count, totals->wait_max_ns, 0.99);
+    stats.hold_p50_ns = lock_hist_percentile(totals->hold_buckets, totals->hold_count, totals->hold_max_ns, 0.50);
+    stats.hold_p99_ns = lock_hist_percentile(totals->hold_buckets, totals->hold_count, totals->hold_max_ns, 0.99);
+    stats.wait_max_ns = static_cast<double>(totals->wait_max_ns);
+    stats.hold_max_ns = static_cast<double>(totals->hold_max_ns);
+    *out_stats = stats;
+    return 0;
+}
+
+// Quantile points per histogram in the JSON "sample_data" series
+static constexpr int LOCK_PROFILE_JSON_SAMPLES = 200;
+
+// printf-style append; the JSON is assembled once per dump
+static void json_appendf(std::string& json, const char* fmt, ...) {
+    char chunk[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vsnprintf(chunk, sizeof(chunk), fmt, args);
+    va_end(args);
+    if (n > 0) json.append(chunk, std::min<std::size_t>(static_cast<std::size_t>(n), sizeof(chunk) - 1));
+}
+
+static void lock_profile_json_series(std::string& json, const char* name, const char* kind,
+                                     const std::uint64_t* buckets, std::uint64_t count,
+                                     std::uint64_t max_ns, bool first) {
+    json_appendf(json, "%s\n    \"%s %s\": [", first ? "" : ",", name, kind);
+    for (int i = 0; i < LOCK_PROFILE_JSON_SAMPLES; i++) {
+        double p = (i + 0.5) / LOCK_PROFILE_JSON_SAMPLES;
+        json_appendf(json, "%s%.1f", i ? ", " : "", lock_hist_percentile(buckets, count, max_ns, p));
+    }
+    json += "]";
+}
+
+static void lock_profile_json_stats(std::string& json, const char* name, const char* kind,
+                                    const std::uint64_t* buckets, std::uint64_t count,
+                                    std::uint64_t total_ns, std::uint64_t max_ns, bool first) {
+    json_appendf(json, "%s\n    \"%s %s\": {\"median\": %.1f, \"mean\": %.1f, \"q25\": %.1f, \"q75\": %.1f}",
+                 first ? "" : ",", name, kind,
+                 lock_hist_percentile(buckets, count, max_ns, 0.50),
+                 static_cast<double>(total_ns) / static_cast<double>(count),
+                 lock_hist_percentile(buckets, count, max_ns, 0.25),
+                 lock_hist_percentile(buckets, count, max_ns, 0.75));
+}
+
+static void lock_profile_json_buckets(std::string& json, const std::uint64_t* buckets) {
+    json += "[";
+    for (int b = 0; b < LOCK_HIST_BUCKETS; b++) {
+        json_appendf(json, "%s%llu", b ? ", " : "", static_cast<unsigned long long>(buckets[b]));
+    }
+    json += "]";
+}
+
+// Writes the profile as JSON in the shape viz_bench_from_json.py reads:
+// "sample_data" holds quantile points of each site's wait and hold
+// histograms (ns) and "method_stats" their median/mean/quartiles; the raw
+// buckets and counts are under "lock_profile". Copies at most size-1 bytes
+// plus a terminator into buffer and returns the full length, so call once
+// with size 0 to size the buffer.
+long lock_profiler_dump_json(char* buffer, long size) {
+    std::vector<LockSiteTotals> sites(LOCK_SITE_COUNT);
+    for (int site = 0; site < LOCK_SITE_COUNT; site++) lock_site_totals(site, sites[site]);
+
+    std::string json = "{\n  \"sample_data\": {";
+    bool first = true;
+    for (int site = 0; site < LOCK_SITE_COUNT; site++) {
+        const LockSiteTotals& t = sites[site];
+        if (t.wait_count > 0) {
+            lock_profile_json_series(json, LOCK_SITE_NAMES[site], "wait", t.wait_buckets,
+                                     t.wait_count, t.wait_max_ns, first);
+            first = false;
+        }
+        if (t.hold_count > 0) {
+            lock_profile_json_series(json, LOCK_SITE_NAMES[site], "hold", t.hold_buckets,
+                                     t.hold_count, t.hold_max_ns, first);
+            first = false;
+        }
+    }
+    json += "\n  },\n  \"method_stats\": {";
+    first = true;
+    for (int site = 0; site < LOCK_SITE_COUNT; site++) {
+        const LockSiteTotals& t = sites[site];
+        if (t.wait_count > 0) {
+            lock_profile_json_stats(json, LOCK_SITE_NAMES[site], "wait", t.wait_buckets, t.wait_count,
+                                    t.wait_total_ns, t.wait_max_ns, first);
+            first = false;
+        }
+        if (t.hold_count > 0) {
+            lock_profile_json_stats(json, LOCK_SITE_NAMES[site], "hold", t.hold_buckets, t.hold_count,
+                                    t.hold_total_ns, t.hold_max_ns, first);
+            first = false;
+        }
+    }
+    json += "\n  },\n  \"lock_profile\": {\n    \"unit\": \"ns\",\n    \"bucket_lower_ns\": [";
+    for (int b = 0; b < LOCK_HIST_BUCKETS; b++) {
+        json_appendf(json, "%s%llu", b ? ", " : "", static_cast<unsigned long long>(lock_hist_lower_ns(b)));
+    }
+    json += "],\n    \"sites\": {";
+    for (int site = 0; site < LOCK_SITE_COUNT; site++) {
+        const LockSiteTotals& t = sites[site];
+        json_appendf(json,
+                     "%s\n      \"%s\": {\"acquisitions\": %llu, \"contended\": %llu, "
+                     "\"wait_total_ns\": %llu, \"wait_max_ns\": %llu, \"hold_total_ns\": %llu, "
+                     "\"hold_max_ns\": %llu, \"wait_buckets\": ",
+                     site ? "," : "", LOCK_SITE_NAMES[site],
+                     static_cast<unsigned long long>(t.acquisitions),
+                     static_cast<unsigned long long>(t.contended),
+                     static_cast<unsigned long long>(t.wait_total_ns),
+                     static_cast<unsigned long long>(t.wait_max_ns),
+                     static_cast<unsigned long long>(t.hold_total_ns),
+                     static_cast<unsigned long long>(t.hold_max_ns));
+        lock_profile_json_buckets(json, t.wait_buckets);
+        json += ", \"hold_buckets\": ";
+        lock_profile_json_buckets(json, t.hold_buckets);
+        json += "}";
+    }
+    json += "\n    }\n  }\n}\n";
+
+    if (buffer != nullptr && size > 0) {
+        std::size_t n = std::min(json.size(), static_cast<std::size_t>(size - 1));
+        std::memcpy(buffer, json.data(), n);
+        buffer[n] = '\0';
+    }
+    return static_cast<long>(json.size());
+}
+
+
 // ============================================================================
 // SHARED STATE - Used by both safe and unsafe functions
 // ============================================================================
@@ -49,15 +579,26 @@ extern "C" {
 // Global variables for demonstrating race conditions
 static long global_counter = 0;  // Intentionally non-atomic for race demos
 static long safe_counter = 0;
-static std::mutex global_mutex;
-static std::shared_mutex shared_mutex;
+static ProfiledMutex global_mutex{LOCK_SITE_GLOBAL};
+static ProfiledSharedMutex shared_mutex;
 
 // Atomic counter for lock-free operations
 static std::atomic<long> atomic_counter{0};
 
+// Lock-guarded counters are mirrored into these at the end of each critical
+// section so get_all_stats never takes a lock. The writer already owns the
+// counter's line; the mirror store is relaxed and on its own line.
+struct alignas(THREADTEST_CACHE_LINE) PublishedCounter {
+    std::atomic<long> value{0};
+};
+static PublishedCounter published_safe_counter;
+static PublishedCounter published_adaptive_counter;
+static PublishedCounter published_combining_counter;
+static std::atomic<long> reset_epoch{0};  // Bumped by reset_counters
+
 // Shared buffer for string operations
 static char shared_buffer[1024];
-static std::mutex buffer_mutex;
+static ProfiledMutex buffer_mutex{LOCK_SITE_BUFFER};
 
 // Modern C++23 features
 static std::binary_semaphore data_ready{0};
@@ -73,6 +614,17 @@ static std::counting_semaphore<10> resource_pool{10};
     #define COMPILER_BARRIER() std::atomic_thread_fence(std::memory_order_seq_cst)
 #endif
 
+// Spin-wait hint for busy loops
+#if defined(_MSC_VER)
+    #define CPU_RELAX() _mm_pause()
+#elif defined(__x86_64__) || defined(__i386__)
+    #define CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+    #define CPU_RELAX() __asm__ __volatile__("yield" ::: "memory")
+#else
+    #define CPU_RELAX() COMPILER_BARRIER()
+#endif
+
 // ============================================================================
 // INTENTIONALLY BAD CODE - Race conditions for demonstration
 // ============================================================================
@@ -133,7 +685,7 @@ long unsafe_complex_operation(int value) {
 
 // BAD: Double-checked locking anti-pattern (broken!)
 static void* singleton = nullptr;
-static std::mutex singleton_mutex;
+static ProfiledMutex singleton_mutex{LOCK_SITE_SINGLETON};
 
 void* get_singleton_unsafe() {
     if (singleton == nullptr) {  // RACE: Non-atomic read
@@ -202,6 +754,7 @@ long safe_increment(int iterations) {
     for (int _ = 0; _ < iterations; _++) {
         safe_counter++;
     }
+    published_safe_counter.value.store(safe_counter, std::memory_order_relaxed);
     return safe_counter;
 }
 
@@ -211,6 +764,7 @@ long safe_decrement(int iterations) {
     for (int _ = 0; _ < iterations; _++) {
         safe_counter--;
     }
+    published_safe_counter.value.store(safe_counter, std::memory_order_relaxed);
     return safe_counter;
 }
 
@@ -218,6 +772,7 @@ long safe_decrement(int iterations) {
 long safe_multiply(int factor) {
     std::unique_lock lock(global_mutex);
     safe_counter *= factor;
+    published_safe_counter.value.store(safe_counter, std::memory_order_relaxed);
     return safe_counter;
 }
 
@@ -229,6 +784,73 @@ const char* safe_write_buffer(const char* text) {
     return shared_buffer;
 }
 
+// GOOD: Per-thread bump arena for string results - no lock, no shared
+// buffer, no overflow. Results stay valid until the same thread calls
+// arena_reset_thread(), which rewinds but keeps the chunks it already owns,
+// so steady-state callers never touch the allocator.
+struct ThreadArena {
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+    char* allocate(std::size_t size) {
+        while (current < chunks.size()) {
+            Chunk& chunk = chunks[current];
+            if (chunk.capacity - used >= size) {
+                char* ptr = chunk.data.get() + used;
+                used += size;
+                return ptr;
+            }
+            current++;
+            used = 0;
+        }
+        std::size_t capacity = std::max(size, CHUNK_SIZE);
+        chunks.push_back({std::make_unique_for_overwrite<char[]>(capacity), capacity});
+        used = size;
+        return chunks.back().data.get();
+    }
+
+    void reset() {
+        current = 0;
+        used = 0;
+    }
+
+    std::size_t bytes_used() const {
+        std::size_t total = used;
+        for (std::size_t i = 0; i < current && i < chunks.size(); i++) {
+            total += chunks[i].capacity;
+        }
+        return total;
+    }
+
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        std::size_t capacity;
+    };
+    std::vector<Chunk> chunks;
+    std::size_t current = 0;
+    std::size_t used = 0;
+};
+
+static thread_local ThreadArena thread_arena;
+
+const char* arena_write_buffer(const char* text) {
+    static constexpr std::string_view suffix = " - processed";
+    std::size_t len = std::strlen(text);
+    char* out = thread_arena.allocate(len + suffix.size() + 1);
+    std::memcpy(out, text, len);
+    std::memcpy(out + len, suffix.data(), suffix.size());
+    out[len + suffix.size()] = '\0';
+    return out;
+}
+
+// Invalidates every pointer arena_write_buffer returned on this thread
+void arena_reset_thread() {
+    thread_arena.reset();
+}
+
+long arena_thread_bytes_used() {
+    return static_cast<long>(thread_arena.bytes_used());
+}
+
 // GOOD: Complex operation with proper synchronization
 long safe_complex_operation(int value) {
     std::scoped_lock lock(global_mutex);
@@ -238,6 +860,7 @@ long safe_complex_operation(int value) {
     safe_counter *= 2;
     result += safe_counter;
     safe_counter -= value;
+    published_safe_counter.value.store(safe_counter, std::memory_order_relaxed);
     
     return result;
 }
@@ -284,6 +907,7 @@ long modern_atomic_ref_increment(long& target, int iterations) {
 #ifndef THREADTEST_NO_JTHREAD
 // Using std::jthread (C++20) with stop_token
 static std::atomic<long> jthread_counter{0};
+static std::jthread jthread_background_worker;  // Shared by start/stop; joins itself at exit
 
 void jthread_worker(std::stop_token stoken) {
     while (!stoken.stop_requested()) {
@@ -293,20 +917,17 @@ void jthread_worker(std::stop_token stoken) {
 }
 
 long start_jthread_worker() {
-    static std::jthread worker;
-    
-    if (!worker.joinable()) {
-        worker = std::jthread(jthread_worker);
+    if (!jthread_background_worker.joinable()) {
+        jthread_background_worker = std::jthread(jthread_worker);
     }
     
     return jthread_counter.load();
 }
 
 void stop_jthread_worker() {
-    static std::jthread worker;
-    if (worker.joinable()) {
-        worker.request_stop();
-        worker.join();
+    if (jthread_background_worker.joinable()) {
+        jthread_background_worker.request_stop();
+        jthread_background_worker.join();
     }
 }
 #else
@@ -359,6 +980,275 @@ void latch_signal() {
     start_latch.count_down();  // Release all waiting threads
 }
 
+// ============================================================================
+// PHASE BARRIERS - Runtime-sized central/tree barriers, reusable latch
+// ============================================================================
+
+// sync_barrier and start_latch above are fixed at compile time and single
+// use. These are handle-based (like the channel) so BSP-style loops can
+// pick the thread count at runtime and reuse them across phases.
+
+using barrier_completion_fn = void (*)(void* context, long phase);
+
+// Per-thread timing, written only by the thread using that index
+struct alignas(THREADTEST_CACHE_LINE) BarrierThreadSlot {
+    long waits = 0;
+    long wait_ns = 0;      // Arrival to release: skew plus barrier overhead
+    long max_wait_ns = 0;
+    long wake_ns = 0;      // Last arrival to this thread running again: pure overhead
+    long max_wake_ns = 0;
+};
+
+struct alignas(THREADTEST_CACHE_LINE) BarrierNode {
+    std::atomic<int> arrived{0};
+    int expected = 0;
+    int parent = -1;
+};
+
+// Combining tree: each thread arrives at leaf index / fan_in, and the last
+// arrival at a node carries on to its parent, so no counter sees more than
+// fan_in threads. The thread completing the root runs the completion and
+// bumps `generation`, which everyone else waits on. A fan-in of at least
+// `threads` is the classic single-counter central barrier.
+struct PhaseBarrier {
+    PhaseBarrier(int threads, int fan_in, barrier_completion_fn completion, void* context)
+        : threads(threads), fan_in(fan_in), completion(completion), context(context),
+          slots(threads) {
+        int children = threads;
+        int level_start = 0;
+        for (;;) {
+            int count = (children + fan_in - 1) / fan_in;
+            nodes.resize(level_start + count);
+            for (int i = 0; i < count; i++) {
+                nodes[level_start + i].expected = std::min(fan_in, children - i * fan_in);
+            }
+            if (level_start > 0) {
+                int prev_start = level_start - children;
+                for (int c = 0; c < children; c++) {
+                    nodes[prev_start + c].parent = level_start + c / fan_in;
+                }
+            }
+            if (count == 1) break;
+            level_start += count;
+            children = count;
+        }
+    }
+
+    const int threads;
+    const int fan_in;
+    const barrier_completion_fn completion;
+    void* const context;
+    std::deque<BarrierNode> nodes;  // Deque: BarrierNode holds an atomic and cannot move
+    std::vector<BarrierThreadSlot> slots;
+    alignas(THREADTEST_CACHE_LINE) std::atomic<long> generation{0};
+    std::atomic<long> last_arrival_ns{0};
+    std::atomic<int> sleepers{0};
+};
+
+static constexpr int BARRIER_SPIN_LIMIT = 1024;
+
+static std::int64_t barrier_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Returns the phase that completed; wake latency goes to *wake_ns_out
+static long barrier_arrive(PhaseBarrier& b, int index, std::int64_t* wake_ns_out) {
+    const std::int64_t arrived_at = barrier_clock_ns();
+    const long phase = b.generation.load(std::memory_order_acquire);
+
+    bool completed = false;
+    int node = index / b.fan_in;
+    for (;;) {
+        BarrierNode& n = b.nodes[node];
+        if (n.arrived.fetch_add(1, std::memory_order_acq_rel) + 1 < n.expected) break;
+        // Every child is in, so nobody touches this node again until the next phase
+        n.arrived.store(0, std::memory_order_relaxed);
+        if (n.parent < 0) {
+            completed = true;
+            break;
+        }
+        node = n.parent;
+    }
+
+    if (completed) {
+        b.last_arrival_ns.store(barrier_clock_ns(), std::memory_order_relaxed);
+        if (b.completion != nullptr) b.completion(b.context, phase);
+        b.generation.store(phase + 1, std::memory_order_seq_cst);
+        if (b.sleepers.load(std::memory_order_seq_cst) > 0) b.generation.notify_all();
+    } else {
+        for (int spin = 1; b.generation.load(std::memory_order_acquire) == phase; spin++) {
+            if (spin < BARRIER_SPIN_LIMIT) {
+                if ((spin & 15) == 0) {
+                    std::this_thread::yield();
+                } else {
+                    CPU_RELAX();
+                }
+                continue;
+            }
+            b.sleepers.fetch_add(1, std::memory_order_seq_cst);
+            b.generation.wait(phase, std::memory_order_acquire);
+            b.sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    const std::int64_t released_at = barrier_clock_ns();
+    const std::int64_t wake_ns = completed
+        ? 0
+        : std::max<std::int64_t>(0, released_at - b.last_arrival_ns.load(std::memory_order_relaxed));
+    BarrierThreadSlot& slot = b.slots[index];
+    slot.waits++;
+    slot.wait_ns += released_at - arrived_at;
+    slot.max_wait_ns = std::max<long>(slot.max_wait_ns, released_at - arrived_at);
+    slot.wake_ns += wake_ns;
+    slot.max_wake_ns = std::max<long>(slot.max_wake_ns, wake_ns);
+    if (wake_ns_out != nullptr) *wake_ns_out = wake_ns;
+    return phase;
+}
+
+// Filled by barrier_get_stats
+struct BarrierStats {
+    int threads;
+    int fan_in;
+    int depth;              // Tree levels; 1 for a central barrier
+    long phases;            // Completed generations
+    long waits;             // Arrivals summed over all threads
+    double mean_wait_ns;
+    long max_wait_ns;
+    double mean_wake_ns;    // Excludes the completing thread, which never waits
+    long max_wake_ns;
+};
+
+// Central barrier: one shared arrival counter. completion(context, phase)
+// runs on the last thread to arrive, before anyone is released.
+// Returns nullptr if threads <= 0.
+void* barrier_create(int threads, barrier_completion_fn completion, void* context) {
+    if (threads <= 0) return nullptr;
+    return new PhaseBarrier(threads, threads, completion, context);
+}
+
+// Tree barrier with `fan_in` threads (or child nodes) per counter
+void* barrier_create_tree(int threads, int fan_in, barrier_completion_fn completion, void* context) {
+    if (threads <= 0 || fan_in < 2) return nullptr;
+    return new PhaseBarrier(threads, std::min(fan_in, threads), completion, context);
+}
+
+// Caller must ensure no thread is still waiting
+void barrier_destroy(void* handle) {
+    delete static_cast<PhaseBarrier*>(handle);
+}
+
+// Each participating thread passes its own index in [0, threads). Returns
+// the phase that just completed, or -1 for a bad index.
+long barrier_arrive_and_wait(void* handle, int thread_index) {
+    PhaseBarrier* b = static_cast<PhaseBarrier*>(handle);
+    if (b == nullptr || thread_index < 0 || thread_index >= b->threads) return -1;
+    return barrier_arrive(*b, thread_index, nullptr);
+}
+
+long barrier_phase(void* handle) {
+    return static_cast<PhaseBarrier*>(handle)->generation.load(std::memory_order_acquire);
+}
+
+// Per-thread slots are plain fields, so read and reset between phases only
+void barrier_get_stats(void* handle, BarrierStats* out_stats) {
+    const PhaseBarrier& b = *static_cast<PhaseBarrier*>(handle);
+    BarrierStats stats{};
+    stats.threads = b.threads;
+    stats.fan_in = b.fan_in;
+    for (int node = 0; node >= 0; node = b.nodes[node].parent) stats.depth++;
+    stats.phases = b.generation.load(std::memory_order_acquire);
+    long wait_total = 0;
+    long wake_total = 0;
+    for (const BarrierThreadSlot& slot : b.slots) {
+        stats.waits += slot.waits;
+        wait_total += slot.wait_ns;
+        wake_total += slot.wake_ns;
+        stats.max_wait_ns = std::max(stats.max_wait_ns, slot.max_wait_ns);
+        stats.max_wake_ns = std::max(stats.max_wake_ns, slot.max_wake_ns);
+    }
+    if (stats.waits > 0) {
+        stats.mean_wait_ns = static_cast<double>(wait_total) / static_cast<double>(stats.waits);
+        long woken = stats.waits - stats.phases;
+        stats.mean_wake_ns = woken > 0 ? static_cast<double>(wake_total) / static_cast<double>(woken) : 0.0;
+    }
+    *out_stats = stats;
+}
+
+void barrier_reset_stats(void* handle) {
+    for (BarrierThreadSlot& slot : static_cast<PhaseBarrier*>(handle)->slots) {
+        slot = BarrierThreadSlot{};
+    }
+}
+
+// Reusable latch: one word holding generation << 32 | remaining count.
+// latch_reset opens a new generation once the current one has opened, and
+// a waiter only waits for the generation it first saw, so a late waiter is
+// never caught by the next round.
+struct GenerationLatch {
+    std::atomic<std::uint64_t> state;
+};
+
+static constexpr std::uint64_t LATCH_COUNT_MASK = 0xffffffffull;
+
+void* latch_create(long count) {
+    if (count <= 0 || count > static_cast<long>(LATCH_COUNT_MASK)) return nullptr;
+    return new GenerationLatch{static_cast<std::uint64_t>(count)};
+}
+
+void latch_destroy(void* handle) {
+    delete static_cast<GenerationLatch*>(handle);
+}
+
+// Returns 1 if this call opened the latch, 0 if it is still closed, -1 if
+// n is not in [1, remaining]
+int latch_count_down(void* handle, long n) {
+    GenerationLatch* latch = static_cast<GenerationLatch*>(handle);
+    std::uint64_t state = latch->state.load(std::memory_order_relaxed);
+    do {
+        if (n <= 0 || static_cast<std::uint64_t>(n) > (state & LATCH_COUNT_MASK)) return -1;
+    } while (!latch->state.compare_exchange_weak(state, state - static_cast<std::uint64_t>(n),
+                                                 std::memory_order_acq_rel));
+    if ((state & LATCH_COUNT_MASK) != static_cast<std::uint64_t>(n)) return 0;
+    latch->state.notify_all();
+    return 1;
+}
+
+// Blocks until the current generation opens; returns that generation
+long latch_wait(void* handle) {
+    GenerationLatch* latch = static_cast<GenerationLatch*>(handle);
+    std::uint64_t state = latch->state.load(std::memory_order_acquire);
+    const std::uint64_t generation = state >> 32;
+    while ((state >> 32) == generation && (state & LATCH_COUNT_MASK) != 0) {
+        latch->state.wait(state, std::memory_order_acquire);
+        state = latch->state.load(std::memory_order_acquire);
+    }
+    return static_cast<long>(generation);
+}
+
+int latch_try_wait(void* handle) {
+    return (static_cast<GenerationLatch*>(handle)->state.load(std::memory_order_acquire) &
+            LATCH_COUNT_MASK) == 0 ? 1 : 0;
+}
+
+// Re-arms an open latch with `count`; returns the new generation, or -1 if
+// the latch is still closed or count is out of range
+long latch_reset(void* handle, long count) {
+    GenerationLatch* latch = static_cast<GenerationLatch*>(handle);
+    if (count <= 0 || count > static_cast<long>(LATCH_COUNT_MASK)) return -1;
+    std::uint64_t state = latch->state.load(std::memory_order_relaxed);
+    std::uint64_t next;
+    do {
+        if ((state & LATCH_COUNT_MASK) != 0) return -1;
+        next = (((state >> 32) + 1) << 32) | static_cast<std::uint64_t>(count);
+    } while (!latch->state.compare_exchange_weak(state, next, std::memory_order_acq_rel));
+    return static_cast<long>(next >> 32);
+}
+
+long latch_generation(void* handle) {
+    return static_cast<long>(static_cast<GenerationLatch*>(handle)->state.load(std::memory_order_acquire) >> 32);
+}
+
 // ============================================================================
 // ATOMIC OPERATIONS - Lock-free implementations
 // ============================================================================
@@ -393,84 +1283,705 @@ void atomic_wait_for_value(long value) {
     atomic_counter.wait(value);  // Block until counter != value
 }
 
+// Async counter waiters, defined with ASYNC COMPLETIONS below; returns how many it woke
+static long async_notify_value_waiters(bool only_one);
+
+// Wakes exactly one waiter: a registered async one if any is due, else a blocked thread
 void atomic_notify_one() {
-    atomic_counter.notify_one();
+    if (async_notify_value_waiters(true) == 0) {
+        atomic_counter.notify_one();
+    }
 }
 
 void atomic_notify_all() {
+    async_notify_value_waiters(false);
     atomic_counter.notify_all();
 }
 
 // ============================================================================
-// READER-WRITER PATTERNS
+// SHARDED COUNTER - Contention-free alternative to atomic_counter
 // ============================================================================
 
-// BAD: Unprotected reader-writer
-static long shared_data = 0;
+// GOOD: Each thread increments its own cache-line-padded slot, so the hot
+// path never bounces a shared line between cores. Reads sum every slot.
+struct alignas(THREADTEST_CACHE_LINE) CounterShard {
+    std::atomic<long> value{0};
+};
 
-long unsafe_read() {
-    return shared_data;  // RACE: Concurrent write possible
+static constexpr unsigned SHARD_COUNT = 64;
+static CounterShard counter_shards[SHARD_COUNT];
+static std::atomic<unsigned> next_shard{0};
+
+// Round-robin assignment on first use; threads beyond SHARD_COUNT share
+static unsigned this_thread_slot() {
+    thread_local unsigned slot = next_shard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+    return slot;
 }
 
-void unsafe_write(long value) {
-    shared_data = value;  // RACE: Concurrent read/write possible
+static CounterShard& this_thread_shard() {
+    return counter_shards[this_thread_slot()];
 }
 
-// GOOD: Protected with shared_mutex (C++17)
-long safe_read() {
-    std::shared_lock lock(shared_mutex);  // Multiple readers allowed
-    return safe_counter;
+// Returns this thread's slot value (reading the total would touch every line)
+long sharded_increment(int iterations) {
+    CounterShard& shard = this_thread_shard();
+    for (int i = 0; i < iterations; i++) {
+        shard.value.fetch_add(1, std::memory_order_relaxed);
+    }
+    return shard.value.load(std::memory_order_relaxed);
 }
 
-void safe_write(long value) {
-    std::unique_lock lock(shared_mutex);  // Exclusive write access
-    safe_counter = value;
+long sharded_decrement(int iterations) {
+    CounterShard& shard = this_thread_shard();
+    for (int i = 0; i < iterations; i++) {
+        shard.value.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return shard.value.load(std::memory_order_relaxed);
+}
+
+long get_sharded_counter() {
+    long total = 0;
+    for (const CounterShard& shard : counter_shards) {
+        total += shard.value.load(std::memory_order_acquire);
+    }
+    return total;
 }
 
 // ============================================================================
-// DEADLOCK SCENARIOS
+// ADAPTIVE MUTEX - Bounded spin, then park on a futex via std::atomic::wait
 // ============================================================================
 
-static std::mutex lock1, lock2;
+// Filled by adaptive_get_stats
+struct AdaptiveLockStats {
+    long acquisitions;
+    long uncontended;        // Taken by the first CAS
+    long spin_acquisitions;  // Taken while spinning, without parking
+    long spin_iterations;
+    long parks;              // Times a thread slept in wait()
+    long handoffs;           // Unlocks that found sleepers flagged and issued a wake
+};
 
-// BAD: Can deadlock with opposite lock ordering
-void deadlock_function1() {
-    std::lock_guard l1(lock1);
-    std::this_thread::sleep_for(std::chrono::microseconds(100));
-    std::lock_guard l2(lock2);  // DEADLOCK: If function2 has lock2
-    global_counter++;
-}
+// GOOD: Three-state futex lock (0 free, 1 locked, 2 locked with sleepers).
+// Short critical sections are usually free again within a few hundred
+// cycles, so spinning first avoids the kernel sleep/wake pair; the bound
+// keeps a preempted holder from burning a whole timeslice per waiter.
+// Stats sit on the lock's own line, which is bouncing anyway.
+class alignas(THREADTEST_CACHE_LINE) AdaptiveMutex {
+public:
+    static constexpr int DEFAULT_SPIN_LIMIT = 128;
 
-void deadlock_function2() {
-    std::lock_guard l2(lock2);  // Opposite order!
-    std::this_thread::sleep_for(std::chrono::microseconds(100));
-    std::lock_guard l1(lock1);  // DEADLOCK: If function1 has lock1
-    global_counter++;
-}
+    void lock() {
+        if (try_lock()) return;
 
-// GOOD: Using std::scoped_lock to avoid deadlock (C++17)
-int safe_dual_lock_operation() {
-    std::scoped_lock lock(lock1, lock2);  // Acquires both atomically
-    global_counter++;
-    return global_counter;
-}
+        std::uint32_t expected;
+        const int limit = spin_limit_.load(std::memory_order_relaxed);
+        for (int spin = 0; spin < limit; spin++) {
+            // Every 16th round yields, in case the holder shares our core
+            if ((spin & 15) == 15) {
+                std::this_thread::yield();
+            } else {
+                CPU_RELAX();
+            }
+            expected = FREE;
+            if (state_.load(std::memory_order_relaxed) == FREE &&
+                state_.compare_exchange_weak(expected, LOCKED, std::memory_order_acquire)) {
+                acquisitions_.fetch_add(1, std::memory_order_relaxed);
+                spin_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+                spin_iterations_.fetch_add(spin + 1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        spin_iterations_.fetch_add(limit, std::memory_order_relaxed);
 
-// ============================================================================
-// RESET AND UTILITY FUNCTIONS
-// ============================================================================
+        // Mark the lock contended so the holder knows to notify
+        std::uint32_t previous = state_.exchange(CONTENDED, std::memory_order_acquire);
+        while (previous != FREE) {
+            parks_.fetch_add(1, std::memory_order_relaxed);
+            state_.wait(CONTENDED, std::memory_order_relaxed);
+            previous = state_.exchange(CONTENDED, std::memory_order_acquire);
+        }
+        acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    }
 
-void reset_counters() {
-    std::scoped_lock lock(global_mutex, buffer_mutex, shared_mutex);
-    
-    global_counter = 0;
+    bool try_lock() {
+        std::uint32_t expected = FREE;
+        if (!state_.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire)) {
+            return false;
+        }
+        acquisitions_.fetch_add(1, std::memory_order_relaxed);
+        uncontended_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void unlock() {
+        if (state_.exchange(FREE, std::memory_order_release) == CONTENDED) {
+            handoffs_.fetch_add(1, std::memory_order_relaxed);
+            state_.notify_one();
+        }
+    }
+
+    int set_spin_limit(int limit) {
+        return spin_limit_.exchange(limit, std::memory_order_relaxed);
+    }
+
+    void stats(AdaptiveLockStats* out) const {
+        out->acquisitions = acquisitions_.load(std::memory_order_relaxed);
+        out->uncontended = uncontended_.load(std::memory_order_relaxed);
+        out->spin_acquisitions = spin_acquisitions_.load(std::memory_order_relaxed);
+        out->spin_iterations = spin_iterations_.load(std::memory_order_relaxed);
+        out->parks = parks_.load(std::memory_order_relaxed);
+        out->handoffs = handoffs_.load(std::memory_order_relaxed);
+    }
+
+    void reset_stats() {
+        for (auto* counter : {&acquisitions_, &uncontended_, &spin_acquisitions_,
+                              &spin_iterations_, &parks_, &handoffs_}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static constexpr std::uint32_t FREE = 0;
+    static constexpr std::uint32_t LOCKED = 1;
+    static constexpr std::uint32_t CONTENDED = 2;
+
+    std::atomic<std::uint32_t> state_{FREE};
+    std::atomic<int> spin_limit_{DEFAULT_SPIN_LIMIT};
+    std::atomic<long> acquisitions_{0};
+    std::atomic<long> uncontended_{0};
+    std::atomic<long> spin_acquisitions_{0};
+    std::atomic<long> spin_iterations_{0};
+    std::atomic<long> parks_{0};
+    std::atomic<long> handoffs_{0};
+};
+
+static AdaptiveMutex adaptive_mutex;
+static long adaptive_counter = 0;  // Guarded by adaptive_mutex
+
+// Same bodies as the safe_* family, on adaptive_counter
+long adaptive_increment(int iterations) {
+    std::scoped_lock lock(adaptive_mutex);
+    for (int _ = 0; _ < iterations; _++) {
+        adaptive_counter++;
+    }
+    published_adaptive_counter.value.store(adaptive_counter, std::memory_order_relaxed);
+    return adaptive_counter;
+}
+
+long adaptive_decrement(int iterations) {
+    std::lock_guard lock(adaptive_mutex);
+    for (int _ = 0; _ < iterations; _++) {
+        adaptive_counter--;
+    }
+    published_adaptive_counter.value.store(adaptive_counter, std::memory_order_relaxed);
+    return adaptive_counter;
+}
+
+long adaptive_multiply(int factor) {
+    std::unique_lock lock(adaptive_mutex);
+    adaptive_counter *= factor;
+    published_adaptive_counter.value.store(adaptive_counter, std::memory_order_relaxed);
+    return adaptive_counter;
+}
+
+long adaptive_complex_operation(int value) {
+    std::scoped_lock lock(adaptive_mutex);
+    
+    adaptive_counter += value;
+    long result = adaptive_counter;
+    adaptive_counter *= 2;
+    result += adaptive_counter;
+    adaptive_counter -= value;
+    published_adaptive_counter.value.store(adaptive_counter, std::memory_order_relaxed);
+    
+    return result;
+}
+
+long get_adaptive_counter() {
+    std::lock_guard lock(adaptive_mutex);
+    return adaptive_counter;
+}
+
+// Spin rounds before parking (0 = park immediately); returns the old limit
+int adaptive_set_spin_limit(int limit) {
+    if (limit < 0) return -1;
+    return adaptive_mutex.set_spin_limit(limit);
+}
+
+void adaptive_get_stats(AdaptiveLockStats* out_stats) {
+    adaptive_mutex.stats(out_stats);
+}
+
+void adaptive_reset_stats() {
+    adaptive_mutex.reset_stats();
+}
+
+// ============================================================================
+// FLAT COMBINING - One lock holder applies every posted operation per pass
+// ============================================================================
+
+// Filled by combining_get_stats
+struct CombiningStats {
+    long operations;  // Operations applied by combiners
+    long passes;      // Combiner lock acquisitions
+    long max_batch;   // Most operations applied in one pass
+};
+
+enum CombiningOp : int {
+    COMBINING_NONE = 0,
+    COMBINING_ADD,
+    COMBINING_MULTIPLY,
+    COMBINING_COMPLEX,
+};
+
+// GOOD: Instead of every thread taking the lock in turn, threads post their
+// operation in a per-thread publication record and whoever wins the lock
+// applies all pending records in one pass. The shared counter stays in the
+// combiner's cache and the lock changes hands once per batch, not per call.
+// Records are linked once and never freed; an exiting thread's record is
+// released for reuse by the next thread that registers.
+struct alignas(THREADTEST_CACHE_LINE) CombiningRecord {
+    std::atomic<int> op{COMBINING_NONE};  // Owner posts, combiner clears when done
+    long argument = 0;
+    long result = 0;
+    std::atomic<bool> in_use{false};
+    CombiningRecord* next = nullptr;      // Immutable once linked
+};
+
+static std::atomic<CombiningRecord*> combining_records{nullptr};
+static std::mutex combining_mutex;
+static long combining_counter = 0;        // Guarded by combining_mutex
+static CombiningStats combining_stats{};  // Guarded by combining_mutex
+
+static CombiningRecord* acquire_combining_record() {
+    for (CombiningRecord* rec = combining_records.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next) {
+        bool expected = false;
+        if (!rec->in_use.load(std::memory_order_relaxed) &&
+            rec->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return rec;
+        }
+    }
+    auto* rec = new CombiningRecord;
+    rec->in_use.store(true, std::memory_order_relaxed);
+    rec->next = combining_records.load(std::memory_order_relaxed);
+    while (!combining_records.compare_exchange_weak(rec->next, rec, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+    }
+    return rec;
+}
+
+struct CombiningHandle {
+    CombiningRecord* record = acquire_combining_record();
+    ~CombiningHandle() { record->in_use.store(false, std::memory_order_release); }
+};
+
+static long apply_combining_op(int op, long argument) {
+    switch (op) {
+        case COMBINING_ADD:
+            combining_counter += argument;
+            return combining_counter;
+        case COMBINING_MULTIPLY:
+            combining_counter *= argument;
+            return combining_counter;
+        case COMBINING_COMPLEX: {
+            combining_counter += argument;
+            long result = combining_counter;
+            combining_counter *= 2;
+            result += combining_counter;
+            combining_counter -= argument;
+            return result;
+        }
+    }
+    return combining_counter;
+}
+
+// Caller holds combining_mutex
+static void combine_pending() {
+    long applied = 0;
+    for (CombiningRecord* rec = combining_records.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next) {
+        int op = rec->op.load(std::memory_order_acquire);
+        if (op == COMBINING_NONE) continue;
+        rec->result = apply_combining_op(op, rec->argument);
+        rec->op.store(COMBINING_NONE, std::memory_order_release);
+        applied++;
+    }
+    published_combining_counter.value.store(combining_counter, std::memory_order_relaxed);
+    combining_stats.operations += applied;
+    combining_stats.passes++;
+    combining_stats.max_batch = std::max(combining_stats.max_batch, applied);
+}
+
+static long combining_submit(int op, long argument) {
+    thread_local CombiningHandle handle;
+    CombiningRecord* rec = handle.record;
+    rec->argument = argument;
+    rec->op.store(op, std::memory_order_release);
+
+    for (unsigned spin = 1;; spin++) {
+        if (combining_mutex.try_lock()) {
+            combine_pending();  // Our own record is in the list, so it is done after this
+            combining_mutex.unlock();
+            break;
+        }
+        if (rec->op.load(std::memory_order_acquire) == COMBINING_NONE) break;
+        if ((spin & 15) == 0) {
+            std::this_thread::yield();
+        } else {
+            CPU_RELAX();
+        }
+    }
+    return rec->result;
+}
+
+// Same results as the safe_* family, on combining_counter
+long combining_increment(int iterations) {
+    return combining_submit(COMBINING_ADD, iterations);
+}
+
+long combining_decrement(int iterations) {
+    return combining_submit(COMBINING_ADD, -static_cast<long>(iterations));
+}
+
+long combining_multiply(int factor) {
+    return combining_submit(COMBINING_MULTIPLY, factor);
+}
+
+long combining_complex_operation(int value) {
+    return combining_submit(COMBINING_COMPLEX, value);
+}
+
+long get_combining_counter() {
+    std::lock_guard lock(combining_mutex);
+    return combining_counter;
+}
+
+void combining_get_stats(CombiningStats* out_stats) {
+    std::lock_guard lock(combining_mutex);
+    *out_stats = combining_stats;
+}
+
+void combining_reset_stats() {
+    std::lock_guard lock(combining_mutex);
+    combining_stats = CombiningStats{};
+}
+
+// ============================================================================
+// READER-WRITER PATTERNS
+// ============================================================================
+
+// BAD: Unprotected reader-writer
+static long shared_data = 0;
+
+long unsafe_read() {
+    return shared_data;  // RACE: Concurrent write possible
+}
+
+void unsafe_write(long value) {
+    shared_data = value;  // RACE: Concurrent read/write possible
+}
+
+// GOOD: Protected with shared_mutex (C++17)
+long safe_read() {
+    std::shared_lock lock(shared_mutex);  // Multiple readers allowed
+    return safe_counter;
+}
+
+void safe_write(long value) {
+    std::unique_lock lock(shared_mutex);  // Exclusive write access
+    safe_counter = value;
+    published_safe_counter.value.store(value, std::memory_order_relaxed);
+}
+
+// Config-style record for the read-mostly patterns below: one cache line,
+// every word holds the last written value, so a torn read is detectable
+static constexpr int CONFIG_WORDS = 8;
+
+struct ConfigRecord {
+    long words[CONFIG_WORDS];
+};
+
+static bool config_consistent(const long* words) {
+    for (int i = 1; i < CONFIG_WORDS; i++) {
+        if (words[i] != words[0]) return false;
+    }
+    return true;
+}
+
+// shared_mutex reference: readers still write the lock word
+static ConfigRecord shared_config{};
+
+static void shared_config_read(long* out) {
+    std::shared_lock lock(shared_mutex);
+    std::memcpy(out, shared_config.words, sizeof(shared_config.words));
+}
+
+static void shared_config_write(long value) {
+    std::unique_lock lock(shared_mutex);
+    for (long& word : shared_config.words) word = value;
+}
+
+// GOOD: Seqlock - readers never write shared memory. A writer makes the
+// sequence odd, updates, then makes it even; a reader that saw an odd or
+// changed sequence retries. Words are atomics so the optimistic reads are
+// not data races. Without fences, the ordering comes from the words
+// themselves (plain moves on x86): release stores keep the odd sequence
+// ahead of every word, and acquire loads keep the recheck behind them. A
+// reader that sees any new word is then guaranteed to see the odd sequence.
+struct alignas(THREADTEST_CACHE_LINE) SeqlockConfig {
+    std::atomic<unsigned long> sequence{0};
+    std::atomic<long> words[CONFIG_WORDS]{};
+};
+
+static SeqlockConfig seqlock_config;
+static std::mutex seqlock_writer_mutex;  // Writers still serialize among themselves
+
+// Returns the number of retries the read needed
+static long seqlock_read_words(long* out) {
+    long retries = 0;
+    for (;;) {
+        unsigned long before = seqlock_config.sequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            for (int i = 0; i < CONFIG_WORDS; i++) {
+                out[i] = seqlock_config.words[i].load(std::memory_order_acquire);
+            }
+            if (seqlock_config.sequence.load(std::memory_order_relaxed) == before) {
+                return retries;
+            }
+        }
+        // Back off to the scheduler in case the writer was preempted mid-update
+        if (++retries % 64 == 0) {
+            std::this_thread::yield();
+        } else {
+            CPU_RELAX();
+        }
+    }
+}
+
+long seqlock_read() {
+    long words[CONFIG_WORDS];
+    seqlock_read_words(words);
+    return words[0];
+}
+
+void seqlock_write(long value) {
+    std::lock_guard lock(seqlock_writer_mutex);
+    unsigned long sequence = seqlock_config.sequence.load(std::memory_order_relaxed);
+    seqlock_config.sequence.store(sequence + 1, std::memory_order_relaxed);
+    for (std::atomic<long>& word : seqlock_config.words) {
+        word.store(value, std::memory_order_release);
+    }
+    seqlock_config.sequence.fetch_add(1, std::memory_order_release);
+}
+
+// GOOD: RCU-style snapshots - readers load an immutable record through one
+// pointer; writers publish a fresh copy and free the old one after a grace
+// period. Readers announce themselves in their own padded slot (two
+// counters, one per grace-period phase) instead of a shared lock word.
+struct alignas(THREADTEST_CACHE_LINE) RcuReaderSlot {
+    std::atomic<long> active[2] = {0, 0};
+};
+
+static RcuReaderSlot rcu_readers[SHARD_COUNT];
+static std::atomic<unsigned> rcu_phase{0};
+static std::atomic<ConfigRecord*> rcu_current{new ConfigRecord{}};
+static std::mutex rcu_writer_mutex;
+
+static void rcu_read_words(long* out) {
+    RcuReaderSlot& slot = rcu_readers[this_thread_slot()];
+    unsigned phase = rcu_phase.load(std::memory_order_seq_cst) & 1;
+    slot.active[phase].fetch_add(1, std::memory_order_seq_cst);
+    const ConfigRecord* record = rcu_current.load(std::memory_order_seq_cst);
+    std::memcpy(out, record->words, sizeof(record->words));
+    slot.active[phase].fetch_sub(1, std::memory_order_release);
+}
+
+// Waits out readers of the current phase, flipping first so new readers
+// land in the other one. Run twice: a reader may have sampled the phase
+// before the previous flip and still be counted in the older counter.
+static void rcu_wait_phase() {
+    unsigned old_phase = rcu_phase.fetch_add(1, std::memory_order_seq_cst) & 1;
+    for (RcuReaderSlot& slot : rcu_readers) {
+        while (slot.active[old_phase].load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+long rcu_read() {
+    long words[CONFIG_WORDS];
+    rcu_read_words(words);
+    return words[0];
+}
+
+void rcu_publish(long value) {
+    auto* fresh = new ConfigRecord;
+    for (long& word : fresh->words) word = value;
+
+    std::lock_guard lock(rcu_writer_mutex);
+    ConfigRecord* old = rcu_current.exchange(fresh, std::memory_order_seq_cst);
+    rcu_wait_phase();
+    rcu_wait_phase();
+    delete old;
+}
+
+// ============================================================================
+// DEADLOCK SCENARIOS
+// ============================================================================
+
+static std::mutex lock1, lock2;
+
+// BAD: Can deadlock with opposite lock ordering
+void deadlock_function1() {
+    std::lock_guard l1(lock1);
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    std::lock_guard l2(lock2);  // DEADLOCK: If function2 has lock2
+    global_counter++;
+}
+
+void deadlock_function2() {
+    std::lock_guard l2(lock2);  // Opposite order!
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    std::lock_guard l1(lock1);  // DEADLOCK: If function1 has lock1
+    global_counter++;
+}
+
+// GOOD: Using std::scoped_lock to avoid deadlock (C++17)
+int safe_dual_lock_operation() {
+    std::scoped_lock lock(lock1, lock2);  // Acquires both atomically
+    global_counter++;
+    return global_counter;
+}
+
+// GOOD: Lock table for many-resource operations. Resource ids hash onto a
+// fixed array of padded stripes, and multi_lock always takes the stripes in
+// ascending index order, so no two callers can wait on each other in a
+// cycle and nobody has to back off and retry the way std::lock does.
+// Each stripe also guards one value slot for the transaction helpers.
+static constexpr int LOCK_TABLE_SIZE = 256;
+static constexpr int MULTI_LOCK_MAX = 32;  // Resources per call; TSAN tracks at most 64 held locks
+
+struct alignas(THREADTEST_CACHE_LINE) LockStripe {
+    std::mutex mutex;
+    long value = 0;  // Guarded by mutex
+};
+
+static LockStripe lock_table[LOCK_TABLE_SIZE];
+
+static int lock_stripe_index(long id) {
+    auto key = static_cast<std::uint64_t>(id) * 0x9e3779b97f4a7c15ULL;  // Fibonacci hashing
+    return static_cast<int>(key >> 56);  // Top 8 bits for 256 stripes
+}
+static_assert(LOCK_TABLE_SIZE == 256, "lock_stripe_index keeps the top 8 bits");
+
+// Sorted, de-duplicated stripe indices for `ids`; returns how many
+static int sorted_stripes(const long* ids, int n, int* out) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        int stripe = lock_stripe_index(ids[i]);
+        int pos = count;
+        while (pos > 0 && out[pos - 1] > stripe) pos--;
+        if (pos > 0 && out[pos - 1] == stripe) continue;
+        std::memmove(out + pos + 1, out + pos, static_cast<std::size_t>(count - pos) * sizeof(int));
+        out[pos] = stripe;
+        count++;
+    }
+    return count;
+}
+
+static bool valid_multi_lock_args(const long* ids, int n) {
+    return ids != nullptr && n > 0 && n <= MULTI_LOCK_MAX;
+}
+
+int lock_table_stripe(long id) {
+    return lock_stripe_index(id);
+}
+
+// Locks every resource in `ids` (duplicates and shared stripes are fine).
+// Pair with multi_unlock on the same thread. Returns 0, or -1 on bad args.
+int multi_lock(const long* ids, int n) {
+    if (!valid_multi_lock_args(ids, n)) return -1;
+    int stripes[MULTI_LOCK_MAX];
+    int count = sorted_stripes(ids, n, stripes);
+    for (int i = 0; i < count; i++) {
+        lock_table[stripes[i]].mutex.lock();
+    }
+    return 0;
+}
+
+int multi_unlock(const long* ids, int n) {
+    if (!valid_multi_lock_args(ids, n)) return -1;
+    int stripes[MULTI_LOCK_MAX];
+    int count = sorted_stripes(ids, n, stripes);
+    for (int i = count - 1; i >= 0; i--) {
+        lock_table[stripes[i]].mutex.unlock();
+    }
+    return 0;
+}
+
+// Adds `delta` to every distinct stripe the ids map to, all under one
+// multi_lock; returns the sum of those stripes afterwards, or -1 on bad args
+long multi_lock_transaction(const long* ids, int n, long delta) {
+    if (!valid_multi_lock_args(ids, n)) return -1;
+    int stripes[MULTI_LOCK_MAX];
+    int count = sorted_stripes(ids, n, stripes);
+    for (int i = 0; i < count; i++) lock_table[stripes[i]].mutex.lock();
+    long sum = 0;
+    for (int i = 0; i < count; i++) {
+        lock_table[stripes[i]].value += delta;
+        sum += lock_table[stripes[i]].value;
+    }
+    for (int i = count - 1; i >= 0; i--) lock_table[stripes[i]].mutex.unlock();
+    return sum;
+}
+
+// Sum of every stripe value, one stripe at a time: exact only while no
+// transaction is running (taking all 256 at once would trip TSAN's limit)
+long lock_table_total() {
+    long total = 0;
+    for (LockStripe& stripe : lock_table) {
+        std::lock_guard lock(stripe.mutex);
+        total += stripe.value;
+    }
+    return total;
+}
+
+void lock_table_reset() {
+    for (LockStripe& stripe : lock_table) {
+        std::lock_guard lock(stripe.mutex);
+        stripe.value = 0;
+    }
+}
+
+// ============================================================================
+// RESET AND UTILITY FUNCTIONS
+// ============================================================================
+
+void reset_counters() {
+    std::scoped_lock lock(global_mutex, buffer_mutex, shared_mutex, adaptive_mutex, combining_mutex);
+    
+    global_counter = 0;
     safe_counter = 0;
     atomic_counter.store(0);
     std::memset(shared_buffer, 0, sizeof(shared_buffer));
     atomic_bank_balance.store(1000);
     bank_balance = 1000;
     fast_bank_balance = 1000;
+    adaptive_counter = 0;
+    combining_counter = 0;
     shared_data = 0;
     jthread_counter.store(0);
+    for (CounterShard& shard : counter_shards) {
+        shard.value.store(0);
+    }
+    for (long& word : shared_config.words) word = 0;
+    seqlock_write(0);
+    rcu_publish(0);
+    published_safe_counter.value.store(0, std::memory_order_relaxed);
+    published_adaptive_counter.value.store(0, std::memory_order_relaxed);
+    published_combining_counter.value.store(0, std::memory_order_relaxed);
+    reset_epoch.fetch_add(1, std::memory_order_release);
 }
 
 long get_global_counter() {
@@ -494,6 +2005,49 @@ long get_unsafe_balance() {
     return bank_balance;  // Intentionally unsafe
 }
 
+// Every counter above in one FFI call.
+// All fields are long so the layout has no padding.
+struct ThreadtestStats {
+    long timestamp_ns;       // steady_clock, for rates between polls
+    long reset_epoch;        // Changes whenever reset_counters runs
+    long global_counter;     // Racy fields are read as racily as their getters
+    long safe_counter;
+    long atomic_counter;
+    long sharded_counter;
+    long adaptive_counter;
+    long combining_counter;
+    long jthread_counter;
+    long shared_data;
+    long balance;
+    long unsafe_balance;
+    long fast_bank_balance;
+};
+
+// Wait-free: only loads, no locks, so a monitor can poll it at high
+// frequency without slowing the writers down. Each field is a value it
+// really held, but fields are not mutually consistent while writers run.
+// Returns 0, or -1 if out_stats is null.
+int get_all_stats(ThreadtestStats* out_stats) {
+    if (out_stats == nullptr) return -1;
+    ThreadtestStats stats{};
+    stats.reset_epoch = reset_epoch.load(std::memory_order_acquire);
+    stats.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    stats.global_counter = global_counter;
+    stats.safe_counter = published_safe_counter.value.load(std::memory_order_relaxed);
+    stats.atomic_counter = atomic_counter.load(std::memory_order_relaxed);
+    stats.sharded_counter = get_sharded_counter();
+    stats.adaptive_counter = published_adaptive_counter.value.load(std::memory_order_relaxed);
+    stats.combining_counter = published_combining_counter.value.load(std::memory_order_relaxed);
+    stats.jthread_counter = jthread_counter.load(std::memory_order_relaxed);
+    stats.shared_data = shared_data;
+    stats.balance = atomic_bank_balance.load(std::memory_order_relaxed);
+    stats.unsafe_balance = bank_balance;
+    stats.fast_bank_balance = fast_bank_balance;
+    *out_stats = stats;
+    return 0;
+}
+
 // ============================================================================
 // SEMAPHORE EXAMPLES (C++20)
 // ============================================================================
@@ -512,16 +2066,3173 @@ int acquire_resource_timeout(int ms) {
     return 0;
 }
 
+// Release the unit, then hand it to a registered async waiter (ASYNC
+// COMPLETIONS below) if one might exist; blocked threads can take it first
+static void async_deliver_resource_release();
+static void async_deliver_data_signal();
+
 void release_resource() {
-    resource_pool.release();
+    async_deliver_resource_release();
 }
 
 void signal_data_ready() {
-    data_ready.release();
+    async_deliver_data_signal();
 }
 
 void wait_for_data() {
     data_ready.acquire();
 }
 
+// ============================================================================
+// OBJECT POOL - Runtime-capacity handle pool with per-thread slot caches
+// ============================================================================
+
+// GOOD: resource_pool only counts to a compile-time 10. An ObjectPool owns
+// `capacity` payload buffers and acquire hands out an actual slot. Each
+// slot's state word is the source of truth: FREE slots sit in the shared
+// free list (one semaphore unit each), PARKED slots sit in the releasing
+// thread's cache and are re-acquired by that thread without touching the
+// semaphore or the free-list mutex. A thread that finds the semaphore empty
+// steals PARKED slots from anyone, and a release that sees waiters unparks
+// straight back to the semaphore, so caches never starve other threads.
+
+struct ObjectHandle {
+    long slot;
+    void* payload;
+};
+
+// Filled by object_pool_get_stats
+struct ObjectPoolStats {
+    long capacity;
+    long payload_bytes;
+    long in_use;
+    long parked;            // Released into some thread's cache
+    long shared_acquires;   // Took a semaphore unit (the slow path)
+    long steals;            // Took a slot parked in another thread's cache
+    long waits;             // Had to block (or time out) for a slot
+    long timeouts;
+};
+
+enum ObjectSlotState : int {
+    OBJECT_SLOT_FREE = 0,
+    OBJECT_SLOT_IN_USE = 1,
+    OBJECT_SLOT_PARKED = 2,
+};
+
+static constexpr int OBJECT_POOL_CACHE_MAX = 8;
+
+struct alignas(THREADTEST_CACHE_LINE) ObjectSlot {
+    std::atomic<int> state{OBJECT_SLOT_FREE};
+};
+
+static std::atomic<std::uint64_t> object_pool_next_id{1};
+
+struct ObjectPool {
+    ObjectPool(long capacity, long payload_bytes, int cache_slots)
+        : id(object_pool_next_id.fetch_add(1, std::memory_order_relaxed)),
+          capacity(capacity), payload_bytes(payload_bytes), cache_slots(cache_slots),
+          stride((payload_bytes + THREADTEST_CACHE_LINE - 1) / THREADTEST_CACHE_LINE * THREADTEST_CACHE_LINE),
+          slots(static_cast<std::size_t>(capacity)),
+          available(static_cast<std::ptrdiff_t>(capacity)) {
+        free_list.reserve(static_cast<std::size_t>(capacity));
+        for (long s = capacity - 1; s >= 0; s--) free_list.push_back(s);
+    }
+
+    ~ObjectPool() {
+        ::operator delete(payload, std::align_val_t{THREADTEST_CACHE_LINE});
+    }
+
+    bool allocate_payload() {
+        if (stride == 0) return true;
+        payload = static_cast<std::byte*>(::operator new(static_cast<std::size_t>(capacity * stride),
+                                                         std::align_val_t{THREADTEST_CACHE_LINE},
+                                                         std::nothrow));
+        if (payload == nullptr) return false;
+        std::memset(payload, 0, static_cast<std::size_t>(capacity * stride));
+        return true;
+    }
+
+    void fill(long slot, ObjectHandle* out) const {
+        out->slot = slot;
+        out->payload = payload == nullptr ? nullptr : payload + slot * stride;
+    }
+
+    // Caller holds a semaphore unit, so the list is not empty
+    long pop_free() {
+        std::lock_guard lock(free_mutex);
+        long slot = free_list.back();
+        free_list.pop_back();
+        slots[slot].state.store(OBJECT_SLOT_IN_USE, std::memory_order_relaxed);
+        return slot;
+    }
+
+    void push_free(long slot) {
+        {
+            std::lock_guard lock(free_mutex);
+            slots[slot].state.store(OBJECT_SLOT_FREE, std::memory_order_relaxed);
+            free_list.push_back(slot);
+        }
+        available.release();
+    }
+
+    bool claim_parked(long slot) {
+        int parked = OBJECT_SLOT_PARKED;
+        return slots[slot].state.compare_exchange_strong(parked, OBJECT_SLOT_IN_USE,
+                                                         std::memory_order_acq_rel);
+    }
+
+    // The seq_cst load pairs with object_pool_release: a waiter announces
+    // (seq_cst fetch_add on waiters) then scans, a release parks (seq_cst
+    // CAS) then reads waiters. In the single total order one of the two
+    // comes second and sees the other, so a parked slot is never missed by
+    // a waiter that the release also missed. A relaxed scan breaks that.
+    long steal_parked() {
+        for (long s = 0; s < capacity; s++) {
+            if (slots[s].state.load(std::memory_order_seq_cst) == OBJECT_SLOT_PARKED && claim_parked(s)) {
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return s;
+            }
+        }
+        return -1;
+    }
+
+    const std::uint64_t id;  // Lets a thread cache notice its pool was replaced at the same address
+    const long capacity;
+    const long payload_bytes;
+    const int cache_slots;
+    const long stride;
+    std::byte* payload = nullptr;
+    std::vector<ObjectSlot> slots;
+    std::counting_semaphore<> available;
+    std::mutex free_mutex;
+    std::vector<long> free_list;
+    alignas(THREADTEST_CACHE_LINE) std::atomic<int> waiters{0};
+    std::atomic<long> shared_acquires{0};
+    std::atomic<long> steals{0};
+    std::atomic<long> waits{0};
+    std::atomic<long> timeouts{0};
+};
+
+// Cache for the pool this thread used last; switching pools just forgets
+// the entries, which stay PARKED and therefore stealable
+struct ObjectPoolThreadCache {
+    const ObjectPool* pool = nullptr;
+    std::uint64_t pool_id = 0;
+    int count = 0;
+    long slots[OBJECT_POOL_CACHE_MAX];
+};
+
+static thread_local ObjectPoolThreadCache object_pool_cache;
+
+static ObjectPoolThreadCache& object_pool_cache_for(const ObjectPool& pool) {
+    ObjectPoolThreadCache& cache = object_pool_cache;
+    if (cache.pool != &pool || cache.pool_id != pool.id) {
+        cache.pool = &pool;
+        cache.pool_id = pool.id;
+        cache.count = 0;
+    }
+    return cache;
+}
+
+// cache_slots (0..8) is the per-thread cache depth; 0 disables it.
+// Payloads are zeroed and cache-line aligned. Returns nullptr on bad args.
+void* object_pool_create(long capacity, long payload_bytes, int cache_slots) {
+    if (capacity <= 0 || payload_bytes < 0 || cache_slots < 0 || cache_slots > OBJECT_POOL_CACHE_MAX) {
+        return nullptr;
+    }
+    auto pool = std::make_unique<ObjectPool>(capacity, payload_bytes, cache_slots);
+    if (!pool->allocate_payload()) return nullptr;
+    return pool.release();
+}
+
+// Returns -1 (and keeps the pool) while any handle is still acquired
+int object_pool_destroy(void* handle) {
+    ObjectPool* pool = static_cast<ObjectPool*>(handle);
+    for (const ObjectSlot& slot : pool->slots) {
+        if (slot.state.load(std::memory_order_acquire) == OBJECT_SLOT_IN_USE) return -1;
+    }
+    delete pool;
+    return 0;
+}
+
+// timeout_ms < 0 waits forever, 0 only tries. Returns 1 with *out filled,
+// 0 on timeout, -1 on bad arguments.
+int object_pool_acquire(void* handle, long timeout_ms, ObjectHandle* out) {
+    ObjectPool* pool = static_cast<ObjectPool*>(handle);
+    if (pool == nullptr || out == nullptr) return -1;
+
+    ObjectPoolThreadCache& cache = object_pool_cache_for(*pool);
+    while (cache.count > 0) {
+        long slot = cache.slots[--cache.count];
+        if (pool->claim_parked(slot)) {  // Fails if another thread stole it
+            pool->fill(slot, out);
+            return 1;
+        }
+    }
+
+    if (pool->available.try_acquire()) {
+        pool->shared_acquires.fetch_add(1, std::memory_order_relaxed);
+        pool->fill(pool->pop_free(), out);
+        return 1;
+    }
+    long slot = pool->steal_parked();
+    if (slot < 0 && timeout_ms != 0) {
+        pool->waits.fetch_add(1, std::memory_order_relaxed);
+        // Announce first: a release that parks after this sees us and unparks
+        pool->waiters.fetch_add(1, std::memory_order_seq_cst);
+        slot = pool->steal_parked();
+        if (slot < 0) {
+            bool got = true;
+            if (timeout_ms < 0) {
+                pool->available.acquire();
+            } else {
+                got = pool->available.try_acquire_for(std::chrono::milliseconds(timeout_ms));
+            }
+            if (got) {
+                pool->shared_acquires.fetch_add(1, std::memory_order_relaxed);
+                slot = pool->pop_free();
+            }
+        }
+        pool->waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (slot < 0) {
+        pool->timeouts.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    pool->fill(slot, out);
+    return 1;
+}
+
+// Returns 0, or -1 if the slot is out of range or not currently acquired
+int object_pool_release(void* handle, long slot) {
+    ObjectPool* pool = static_cast<ObjectPool*>(handle);
+    if (pool == nullptr || slot < 0 || slot >= pool->capacity) return -1;
+    std::atomic<int>& state = pool->slots[slot].state;
+
+    ObjectPoolThreadCache& cache = object_pool_cache_for(*pool);
+    if (cache.count < pool->cache_slots && pool->waiters.load(std::memory_order_relaxed) == 0) {
+        int in_use = OBJECT_SLOT_IN_USE;
+        if (!state.compare_exchange_strong(in_use, OBJECT_SLOT_PARKED, std::memory_order_seq_cst)) {
+            return -1;
+        }
+        cache.slots[cache.count++] = slot;
+        // A waiter may have arrived (and scanned) just before we parked; the
+        // seq_cst CAS and this seq_cst load pair with steal_parked
+        if (pool->waiters.load(std::memory_order_seq_cst) > 0 && pool->claim_parked(slot)) {
+            cache.count--;
+            pool->push_free(slot);
+        }
+        return 0;
+    }
+
+    int in_use = OBJECT_SLOT_IN_USE;
+    if (!state.compare_exchange_strong(in_use, OBJECT_SLOT_FREE, std::memory_order_acq_rel)) return -1;
+    pool->push_free(slot);
+    return 0;
+}
+
+void object_pool_get_stats(void* handle, ObjectPoolStats* out_stats) {
+    const ObjectPool& pool = *static_cast<ObjectPool*>(handle);
+    ObjectPoolStats stats{};
+    stats.capacity = pool.capacity;
+    stats.payload_bytes = pool.payload_bytes;
+    for (const ObjectSlot& slot : pool.slots) {
+        int state = slot.state.load(std::memory_order_relaxed);
+        if (state == OBJECT_SLOT_IN_USE) stats.in_use++;
+        if (state == OBJECT_SLOT_PARKED) stats.parked++;
+    }
+    stats.shared_acquires = pool.shared_acquires.load(std::memory_order_relaxed);
+    stats.steals = pool.steals.load(std::memory_order_relaxed);
+    stats.waits = pool.waits.load(std::memory_order_relaxed);
+    stats.timeouts = pool.timeouts.load(std::memory_order_relaxed);
+    *out_stats = stats;
+}
+
+// ============================================================================
+// MPMC CHANNEL - Bounded lock-free ring (Vyukov sequence-numbered cells)
+// ============================================================================
+
+// GOOD: Unlike signal_data_ready/wait_for_data this moves a payload, and the
+// non-blocking paths never sleep. Each cell's sequence number says whether it
+// is free for the producer at `pos` (seq == pos) or holds data for the
+// consumer at `pos` (seq == pos + 1).
+struct ChannelCell {
+    std::atomic<std::size_t> seq;
+    long value;
+};
+
+// Free functions so the shared-memory channel runs the same ring over
+// cells that live in its segment
+static bool ring_try_push(ChannelCell* cells, std::size_t mask,
+                          std::atomic<std::size_t>& enqueue_pos, long value) {
+    std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        ChannelCell& cell = cells[pos & mask];
+        std::size_t seq = cell.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.value = value;
+                cell.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // Full
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+static bool ring_try_pop(ChannelCell* cells, std::size_t mask,
+                         std::atomic<std::size_t>& dequeue_pos, long& value) {
+    std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        ChannelCell& cell = cells[pos & mask];
+        std::size_t seq = cell.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                value = cell.value;
+                cell.seq.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // Empty
+        } else {
+            pos = dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+struct Channel {
+    explicit Channel(std::size_t capacity)
+        : mask(capacity - 1), cells(new ChannelCell[capacity]) {
+        for (std::size_t i = 0; i < capacity; i++) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Fails once the channel is closed, like the blocking push
+    bool try_push(long value) {
+        return !closed.load(std::memory_order_acquire) &&
+               ring_try_push(cells.get(), mask, enqueue_pos, value);
+    }
+
+    bool try_pop(long& value) {
+        return ring_try_pop(cells.get(), mask, dequeue_pos, value);
+    }
+
+    // Blocking side: waiters park on an epoch with std::atomic::wait. Both
+    // sides reach the waiter count with a seq_cst RMW (a waker's fetch_add(0)
+    // rather than a load), so they are totally ordered on it: a waker that
+    // reads zero came first, its earlier push/pop happens-before the waiter's
+    // retry, and the retry sees it. Uncontended ops skip the notify syscall.
+    static void wake(std::atomic<unsigned>& waiters, std::atomic<unsigned>& epoch) {
+        if (waiters.fetch_add(0, std::memory_order_seq_cst) > 0) {
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+            epoch.notify_all();
+        }
+    }
+
+    // Plain function pointer rather than a template: no templates under extern "C"
+    using TryOp = bool (*)(Channel&, long&);
+
+    bool wait_until(std::atomic<unsigned>& waiters, std::atomic<unsigned>& epoch,
+                    TryOp try_op, long& value) {
+        for (;;) {
+            if (try_op(*this, value)) return true;
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            // A bump before this load is visible here; one after wakes the wait
+            unsigned seen = epoch.load(std::memory_order_seq_cst);
+            bool ok = try_op(*this, value);
+            bool closed_now = closed.load(std::memory_order_acquire);
+            if (!ok && !closed_now) {
+                epoch.wait(seen, std::memory_order_acquire);
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            if (ok) return true;
+            if (closed_now) return try_op(*this, value);
+        }
+    }
+
+    bool push(long value) {
+        TryOp op = [](Channel& ch, long& v) { return ch.try_push(v); };
+        bool ok = wait_until(push_waiters, space_epoch, op, value);
+        if (ok) wake(pop_waiters, items_epoch);
+        return ok;
+    }
+
+    bool pop(long& value) {
+        TryOp op = [](Channel& ch, long& v) { return ch.try_pop(v); };
+        bool ok = wait_until(pop_waiters, items_epoch, op, value);
+        if (ok) wake(push_waiters, space_epoch);
+        return ok;
+    }
+
+    void close() {
+        closed.store(true, std::memory_order_release);
+        items_epoch.fetch_add(1, std::memory_order_seq_cst);
+        space_epoch.fetch_add(1, std::memory_order_seq_cst);
+        items_epoch.notify_all();
+        space_epoch.notify_all();
+    }
+
+    const std::size_t mask;
+    std::unique_ptr<ChannelCell[]> cells;
+    alignas(THREADTEST_CACHE_LINE) std::atomic<std::size_t> enqueue_pos{0};
+    alignas(THREADTEST_CACHE_LINE) std::atomic<std::size_t> dequeue_pos{0};
+    alignas(THREADTEST_CACHE_LINE) std::atomic<unsigned> items_epoch{0};
+    std::atomic<unsigned> pop_waiters{0};
+    alignas(THREADTEST_CACHE_LINE) std::atomic<unsigned> space_epoch{0};
+    std::atomic<unsigned> push_waiters{0};
+    std::atomic<bool> closed{false};
+};
+
+// Capacity is rounded up to a power of two, and to at least 2: with one
+// cell the sequence numbers of a full and an empty slot coincide. Returns
+// nullptr if capacity <= 0.
+void* channel_create(long capacity) {
+    if (capacity <= 0) return nullptr;
+    return new Channel(std::bit_ceil(std::max<std::size_t>(static_cast<std::size_t>(capacity), 2)));
+}
+
+// Caller must ensure no thread is still using the channel
+void channel_destroy(void* handle) {
+    delete static_cast<Channel*>(handle);
+}
+
+int channel_try_push(void* handle, long value) {
+    Channel* ch = static_cast<Channel*>(handle);
+    if (!ch->try_push(value)) return 0;
+    Channel::wake(ch->pop_waiters, ch->items_epoch);
+    return 1;
+}
+
+int channel_try_pop(void* handle, long* out) {
+    Channel* ch = static_cast<Channel*>(handle);
+    if (!ch->try_pop(*out)) return 0;
+    Channel::wake(ch->push_waiters, ch->space_epoch);
+    return 1;
+}
+
+// Batch variants amortize the FFI call; they stop at the first full/empty slot
+// (or at close, for pushes) and return how many items were moved
+long channel_push_batch(void* handle, const long* values, long count) {
+    Channel* ch = static_cast<Channel*>(handle);
+    long pushed = 0;
+    while (pushed < count && ch->try_push(values[pushed])) {
+        pushed++;
+    }
+    if (pushed > 0) Channel::wake(ch->pop_waiters, ch->items_epoch);
+    return pushed;
+}
+
+long channel_pop_batch(void* handle, long* out, long max_items) {
+    Channel* ch = static_cast<Channel*>(handle);
+    long popped = 0;
+    while (popped < max_items && ch->try_pop(out[popped])) {
+        popped++;
+    }
+    if (popped > 0) Channel::wake(ch->push_waiters, ch->space_epoch);
+    return popped;
+}
+
+// Blocking variants park on std::atomic::wait. They return 0 once the
+// channel is closed (push) or closed and drained (pop), 1 otherwise. The
+// try variants return 0 in the same cases, plus full/empty.
+int channel_push(void* handle, long value) {
+    return static_cast<Channel*>(handle)->push(value) ? 1 : 0;
+}
+
+int channel_pop(void* handle, long* out) {
+    return static_cast<Channel*>(handle)->pop(*out) ? 1 : 0;
+}
+
+void channel_close(void* handle) {
+    static_cast<Channel*>(handle)->close();
+}
+
+// Approximate under concurrency
+long channel_size(void* handle) {
+    Channel* ch = static_cast<Channel*>(handle);
+    std::size_t tail = ch->enqueue_pos.load(std::memory_order_acquire);
+    std::size_t head = ch->dequeue_pos.load(std::memory_order_acquire);
+    return tail >= head ? static_cast<long>(tail - head) : 0;
+}
+
+// ============================================================================
+// POOL ALLOCATOR - Size-class pool with thread-local free lists
+// ============================================================================
+
+// GOOD: Blocks come from per-thread free lists that refill from a shared
+// slab pool in batches, so steady-state alloc/free takes no lock and RSS is
+// capped at the pool's high-water mark (see pool_allocator.hpp).
+struct PoolStats {
+    size_t slab_bytes;
+    size_t slabs;
+    size_t shared_free_blocks;
+    size_t max_block_size;
+};
+
+// Returns nullptr for size 0 or sizes above max_block_size
+void* pool_allocate(size_t size) {
+    return benchpool::allocate(size);
+}
+
+// Any thread may free any pool block
+void pool_deallocate(void* ptr) {
+    benchpool::deallocate(ptr);
+}
+
+size_t pool_block_size(void* ptr) {
+    return benchpool::block_size(ptr);
+}
+
+void pool_get_stats(PoolStats* out_stats) {
+    if (out_stats == nullptr) return;
+    benchpool::Stats stats = benchpool::stats();
+    out_stats->slab_bytes = stats.slab_bytes;
+    out_stats->slabs = stats.slabs;
+    out_stats->shared_free_blocks = stats.shared_free_blocks;
+    out_stats->max_block_size = benchpool::MAX_BLOCK_SIZE;
+}
+
+// ============================================================================
+// HARDWARE COUNTERS - perf_event_open regions around native code
+// ============================================================================
+
+// Region ids used by the built-in benchmarks; callers pick ids from
+// COUNTER_REGION_USER up to 63 for their own begin/end pairs
+enum CounterRegion : int {
+    COUNTER_REGION_SYNC_BENCH = 0,
+    COUNTER_REGION_ALLOC_BENCH = 1,
+    COUNTER_REGION_USER = 8,
+};
+
+struct CounterStats {
+    uint64_t calls;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t llc_misses;
+    uint64_t branch_misses;
+    uint64_t time_enabled_ns;
+    uint64_t time_running_ns;
+    uint32_t threads;
+    double ipc;
+    double llc_misses_per_kinstr;
+    double branch_misses_per_kinstr;
+};
+
+// 1 if perf_event_open works on the calling thread
+int counters_available() {
+    return benchperf::available() ? 1 : 0;
+}
+
+// Collection is off by default; when off, begin/end are no-ops
+void counters_set_enabled(int enabled) {
+    benchperf::set_enabled(enabled != 0);
+}
+
+void counters_begin(int region_id) {
+    benchperf::begin(region_id);
+}
+
+void counters_end(int region_id) {
+    benchperf::end(region_id);
+}
+
+// Sums every thread that ran the region (live and exited)
+void counters_read(int region_id, CounterStats* out_stats) {
+    benchperf::RegionStats stats = benchperf::read(region_id);
+    out_stats->calls = stats.calls;
+    out_stats->cycles = stats.values[benchperf::CYCLES];
+    out_stats->instructions = stats.values[benchperf::INSTRUCTIONS];
+    out_stats->llc_misses = stats.values[benchperf::LLC_MISSES];
+    out_stats->branch_misses = stats.values[benchperf::BRANCH_MISSES];
+    out_stats->time_enabled_ns = stats.time_enabled_ns;
+    out_stats->time_running_ns = stats.time_running_ns;
+    out_stats->threads = stats.threads;
+
+    double kinstr = static_cast<double>(stats.values[benchperf::INSTRUCTIONS]) / 1000.0;
+    out_stats->ipc = stats.values[benchperf::CYCLES] > 0
+        ? static_cast<double>(stats.values[benchperf::INSTRUCTIONS]) /
+          static_cast<double>(stats.values[benchperf::CYCLES])
+        : 0.0;
+    out_stats->llc_misses_per_kinstr = kinstr > 0.0
+        ? static_cast<double>(stats.values[benchperf::LLC_MISSES]) / kinstr
+        : 0.0;
+    out_stats->branch_misses_per_kinstr = kinstr > 0.0
+        ? static_cast<double>(stats.values[benchperf::BRANCH_MISSES]) / kinstr
+        : 0.0;
+}
+
+void counters_reset() {
+    benchperf::reset();
+}
+
+// ============================================================================
+// LEDGER - Many-account store with ordered per-stripe transfer locks
+// ============================================================================
+
+// GOOD: withdraw_safe generalised to many accounts. Each balance is an
+// atomic on its own cache line (like CounterShard), so reads never lock
+// and transfers on different stripes never false-share; a transfer
+// locks the stripes of both accounts in index order (one lock if they
+// share a stripe), checks funds and moves the amount. A two-word CAS is
+// not an option since two arbitrary accounts are never adjacent.
+// Stripes use AdaptiveMutex: the critical section is a few instructions.
+static constexpr long LEDGER_STRIPES = 1024;
+
+// Bulk transfer record for ledger_batch_apply
+struct LedgerOp {
+    long from;
+    long to;
+    long amount;
+};
+
+struct alignas(THREADTEST_CACHE_LINE) LedgerAccount {
+    std::atomic<long> balance;
+};
+
+static AdaptiveMutex ledger_stripes[LEDGER_STRIPES];
+static LedgerAccount* ledger_balances = nullptr;
+static long ledger_accounts = 0;
+
+static void free_ledger() {
+    if (ledger_balances == nullptr) return;
+    std::destroy_n(ledger_balances, ledger_accounts);
+    ::operator delete(ledger_balances, std::align_val_t{THREADTEST_CACHE_LINE});
+    ledger_balances = nullptr;
+    ledger_accounts = 0;
+}
+
+// (Re)creates the ledger with `accounts` accounts holding `initial_balance`.
+// Not safe to call while transfers are running. Returns 0, or -1 on bad args.
+int ledger_init(long accounts, long initial_balance) {
+    if (accounts <= 0 || initial_balance < 0) return -1;
+    free_ledger();
+    void* memory = ::operator new(static_cast<std::size_t>(accounts) * sizeof(LedgerAccount),
+                                  std::align_val_t{THREADTEST_CACHE_LINE}, std::nothrow);
+    if (memory == nullptr) return -1;
+    ledger_balances = static_cast<LedgerAccount*>(memory);
+    for (long i = 0; i < accounts; i++) {
+        std::construct_at(ledger_balances + i, initial_balance);
+    }
+    ledger_accounts = accounts;
+    return 0;
+}
+
+long ledger_account_count() {
+    return ledger_accounts;
+}
+
+// Returns -1 for an unknown account
+long ledger_balance(long account) {
+    if (account < 0 || account >= ledger_accounts) return -1;
+    return ledger_balances[account].balance.load(std::memory_order_relaxed);
+}
+
+// Sum of all balances; only exact while no transfer is in flight
+long ledger_total() {
+    long total = 0;
+    for (long i = 0; i < ledger_accounts; i++) {
+        total += ledger_balances[i].balance.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+static int ledger_transfer_unchecked(long from, long to, long amount) {
+    long first = from % LEDGER_STRIPES;
+    long second = to % LEDGER_STRIPES;
+    if (first > second) std::swap(first, second);
+    ledger_stripes[first].lock();
+    if (second != first) ledger_stripes[second].lock();
+
+    int moved = 0;
+    long balance = ledger_balances[from].balance.load(std::memory_order_relaxed);
+    if (balance >= amount) {
+        ledger_balances[from].balance.store(balance - amount, std::memory_order_relaxed);
+        ledger_balances[to].balance.fetch_add(amount, std::memory_order_relaxed);
+        moved = 1;
+    }
+
+    if (second != first) ledger_stripes[second].unlock();
+    ledger_stripes[first].unlock();
+    return moved;
+}
+
+static bool valid_ledger_transfer(long from, long to, long amount) {
+    return from >= 0 && from < ledger_accounts && to >= 0 && to < ledger_accounts && amount >= 0;
+}
+
+// 1 if moved, 0 for insufficient funds, -1 for bad accounts or amount
+int ledger_transfer(long from, long to, long amount) {
+    if (!valid_ledger_transfer(from, to, amount)) return -1;
+    if (from == to) return 1;
+    return ledger_transfer_unchecked(from, to, amount);
+}
+
+// Applies ops in order (each one atomic on its own, not the batch as a
+// whole); per-op results go to `results` if given. Returns how many moved,
+// or -1 if ops is null.
+long ledger_batch_apply(const LedgerOp* ops, long n, int* results) {
+    if (ops == nullptr || n < 0) return -1;
+    long moved = 0;
+    for (long i = 0; i < n; i++) {
+        const LedgerOp& op = ops[i];
+        int result;
+        if (!valid_ledger_transfer(op.from, op.to, op.amount)) {
+            result = -1;
+        } else if (op.from == op.to) {
+            result = 1;
+        } else {
+            result = ledger_transfer_unchecked(op.from, op.to, op.amount);
+        }
+        if (result == 1) moved++;
+        if (results != nullptr) results[i] = result;
+    }
+    return moved;
+}
+
+// ============================================================================
+// WORK-STEALING TASK POOL - Persistent workers with Chase-Lev deques
+// ============================================================================
+
+using pool_task_fn = void (*)(void*);
+
+// Filled by pool_get_task_stats
+struct TaskPoolStats {
+    long submitted;
+    long executed;
+    long local_pushes;  // Submitted by a task onto its worker's own deque
+    long injected;      // Submitted from outside the pool (or a full deque)
+    long steals;        // Tasks taken from another worker's deque
+    int workers;
+};
+
+// Chase-Lev deque after Le et al. (PPoPP'13): the owner pushes and takes at
+// the bottom without atomic RMWs, thieves CAS the top. Their fences are
+// folded into seq_cst operations on top/bottom (take's bottom store and top
+// load, steal's two loads and both CASes), which gives the same total order
+// without standalone fences TSAN can't model. Capacity is fixed; push fails
+// when full and the caller falls back to the injection queue. Slots are
+// relaxed atomics since a thief may read a slot the owner is about to reuse
+// (its CAS then fails).
+class WorkStealingDeque {
+public:
+    static constexpr long CAPACITY = 1 << 12;
+
+    bool push(pool_task_fn fn, void* arg) {
+        long bottom = bottom_.load(std::memory_order_relaxed);
+        long top = top_.load(std::memory_order_acquire);
+        if (bottom - top >= CAPACITY) return false;
+        Slot& slot = slots_[bottom & (CAPACITY - 1)];
+        slot.fn.store(fn, std::memory_order_relaxed);
+        slot.arg.store(arg, std::memory_order_relaxed);
+        bottom_.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool take(pool_task_fn& fn, void*& arg) {
+        long bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_seq_cst);
+        long top = top_.load(std::memory_order_seq_cst);
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        read_slot(bottom, fn, arg);
+        if (top == bottom) {
+            // Last task: race thieves for it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(pool_task_fn& fn, void*& arg) {
+        long top = top_.load(std::memory_order_seq_cst);
+        long bottom = bottom_.load(std::memory_order_seq_cst);
+        if (top >= bottom) return false;
+        read_slot(top, fn, arg);
+        return top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<pool_task_fn> fn{nullptr};
+        std::atomic<void*> arg{nullptr};
+    };
+
+    void read_slot(long index, pool_task_fn& fn, void*& arg) const {
+        const Slot& slot = slots_[index & (CAPACITY - 1)];
+        fn = slot.fn.load(std::memory_order_relaxed);
+        arg = slot.arg.load(std::memory_order_relaxed);
+    }
+
+    alignas(THREADTEST_CACHE_LINE) std::atomic<long> top_{0};
+    alignas(THREADTEST_CACHE_LINE) std::atomic<long> bottom_{0};
+    alignas(THREADTEST_CACHE_LINE) Slot slots_[CAPACITY];
+};
+
+// GOOD: Persistent workers, each draining its own deque first, then the
+// shared injection queue (submissions from non-pool threads), then stealing
+// from siblings. Idle workers sleep on an epoch word bumped per submission,
+// so an idle pool costs nothing and a submit wakes at most one worker.
+class TaskPool {
+public:
+    // Static teardown: queued tasks may never finish, so don't wait for them
+    ~TaskPool() { join_workers(); }
+
+    // Caller holds task_pool_control exclusively and nothing is in flight
+    void start(int workers) {
+        stopping_.store(false, std::memory_order_relaxed);
+        workers_.clear();
+        for (int i = 0; i < workers; i++) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (int i = 0; i < workers; i++) {
+            workers_[i]->thread = std::thread([this, i] { run(i); });
+        }
+        running_.store(workers, std::memory_order_release);
+    }
+
+    // Drains every submitted task, then joins the workers
+    void stop() {
+        if (running_.load(std::memory_order_acquire) == 0) return;
+        wait_all();
+        join_workers();
+    }
+
+    int workers() const { return running_.load(std::memory_order_acquire); }
+
+    void submit(pool_task_fn fn, void* arg) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        submitted_.fetch_add(1, std::memory_order_relaxed);
+        if (current_pool == this && workers_[current_worker]->deque.push(fn, arg)) {
+            local_pushes_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            std::lock_guard lock(inject_mutex_);
+            injected_.push_back({fn, arg});
+            injected_size_.fetch_add(1, std::memory_order_relaxed);
+            injected_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        work_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            work_epoch_.notify_one();
+        }
+    }
+
+    // Blocks until every submitted task (including ones tasks submitted) ran
+    void wait_all() {
+        long pending = pending_.load(std::memory_order_acquire);
+        while (pending != 0) {
+            pending_.wait(pending, std::memory_order_acquire);
+            pending = pending_.load(std::memory_order_acquire);
+        }
+    }
+
+    bool on_worker_thread() const { return current_pool == this; }
+
+    void stats(TaskPoolStats* out) const {
+        out->submitted = submitted_.load(std::memory_order_relaxed);
+        out->executed = executed_.load(std::memory_order_relaxed);
+        out->local_pushes = local_pushes_.load(std::memory_order_relaxed);
+        out->injected = injected_count_.load(std::memory_order_relaxed);
+        out->steals = steals_.load(std::memory_order_relaxed);
+        out->workers = workers();
+    }
+
+    void reset_stats() {
+        for (auto* counter : {&submitted_, &executed_, &local_pushes_, &injected_count_, &steals_}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Task {
+        pool_task_fn fn;
+        void* arg;
+    };
+
+    struct Worker {
+        WorkStealingDeque deque;
+        std::thread thread;
+    };
+
+    static constexpr int IDLE_SPINS = 64;
+
+    static inline thread_local TaskPool* current_pool = nullptr;
+    static inline thread_local int current_worker = -1;
+
+    // Workers finish their current task and exit; anything still queued stays queued
+    void join_workers() {
+        if (running_.load(std::memory_order_acquire) == 0) return;
+        stopping_.store(true, std::memory_order_seq_cst);
+        work_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        work_epoch_.notify_all();
+        for (auto& worker : workers_) {
+            worker->thread.join();
+        }
+        workers_.clear();
+        running_.store(0, std::memory_order_release);
+    }
+
+    bool pop_injected(Task& task) {
+        if (injected_size_.load(std::memory_order_relaxed) == 0) return false;
+        std::lock_guard lock(inject_mutex_);
+        if (injected_.empty()) return false;
+        task = injected_.front();
+        injected_.pop_front();
+        injected_size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool find_task(int index, Task& task) {
+        if (workers_[index]->deque.take(task.fn, task.arg)) return true;
+        if (pop_injected(task)) return true;
+        const int count = static_cast<int>(workers_.size());
+        for (int offset = 1; offset < count; offset++) {
+            if (workers_[(index + offset) % count]->deque.steal(task.fn, task.arg)) {
+                steals_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(const Task& task) {
+        task.fn(task.arg);
+        executed_.fetch_add(1, std::memory_order_relaxed);
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pending_.notify_all();
+        }
+    }
+
+    void run(int index) {
+        current_pool = this;
+        current_worker = index;
+        Task task;
+        int idle = 0;
+        for (;;) {
+            // Checked after the epoch load: a stop that bumps it later wakes the wait below
+            unsigned epoch = work_epoch_.load(std::memory_order_seq_cst);
+            if (stopping_.load(std::memory_order_seq_cst)) break;
+            if (find_task(index, task)) {
+                execute(task);
+                idle = 0;
+                continue;
+            }
+            if (++idle < IDLE_SPINS) {
+                if ((idle & 7) == 0) {
+                    std::this_thread::yield();
+                } else {
+                    CPU_RELAX();
+                }
+                continue;
+            }
+            // A submit after the epoch load changes it, so wait() returns at once
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            work_epoch_.wait(epoch, std::memory_order_seq_cst);
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            idle = 0;
+        }
+        current_pool = nullptr;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex inject_mutex_;
+    std::deque<Task> injected_;
+    std::atomic<long> injected_size_{0};
+    std::atomic<long> pending_{0};
+    std::atomic<unsigned> work_epoch_{0};
+    std::atomic<int> sleepers_{0};
+    std::atomic<int> running_{0};
+    std::atomic<bool> stopping_{false};
+    std::atomic<long> submitted_{0};
+    std::atomic<long> executed_{0};
+    std::atomic<long> local_pushes_{0};
+    std::atomic<long> injected_count_{0};
+    std::atomic<long> steals_{0};
+};
+
+static TaskPool task_pool;
+// Exclusive for start/stop/resize, shared across each outside submission
+static std::shared_mutex task_pool_control;
+
+static int default_pool_workers() {
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// Submits `count` copies of fn(arg), starting the pool on first use. Outside
+// threads hold task_pool_control shared, so a concurrent resize or shutdown
+// either drains their tasks first or runs them on the new workers. Tasks
+// skip the lock: a resize waits for them, so their pool can't go away.
+static void task_pool_submit(pool_task_fn fn, void* arg, long count) {
+    std::shared_lock lock(task_pool_control, std::defer_lock);
+    if (!task_pool.on_worker_thread()) {
+        lock.lock();
+        while (task_pool.workers() == 0) {
+            lock.unlock();
+            {
+                std::lock_guard start_lock(task_pool_control);
+                if (task_pool.workers() == 0) task_pool.start(default_pool_workers());
+            }
+            lock.lock();
+        }
+    }
+    for (long i = 0; i < count; i++) {
+        task_pool.submit(fn, arg);
+    }
+}
+
+// Resize the pool (0 = one worker per CPU) after draining it; returns the
+// new worker count, or -1 for a negative count or a call from a task.
+// Submissions from other threads wait until the new workers are running.
+int pool_set_workers(int workers) {
+    if (workers < 0 || task_pool.on_worker_thread()) return -1;
+    std::lock_guard lock(task_pool_control);
+    task_pool.stop();
+    task_pool.start(workers == 0 ? default_pool_workers() : workers);
+    return task_pool.workers();
+}
+
+int pool_worker_count() {
+    return task_pool.workers();
+}
+
+// Starts the pool on first use. Returns 0, or -1 for a null task.
+int pool_submit(pool_task_fn fn, void* arg) {
+    if (fn == nullptr) return -1;
+    task_pool_submit(fn, arg, 1);
+    return 0;
+}
+
+// `count` copies of the same task, for cheap bulk submission over FFI
+int pool_submit_n(pool_task_fn fn, void* arg, long count) {
+    if (fn == nullptr || count < 0) return -1;
+    task_pool_submit(fn, arg, count);
+    return 0;
+}
+
+// Returns -1 if called from inside a task (it would wait on itself)
+int pool_wait_all() {
+    if (task_pool.on_worker_thread()) return -1;
+    task_pool.wait_all();
+    return 0;
+}
+
+void pool_shutdown() {
+    if (task_pool.on_worker_thread()) return;
+    std::lock_guard lock(task_pool_control);
+    task_pool.stop();
+}
+
+void pool_get_task_stats(TaskPoolStats* out_stats) {
+    task_pool.stats(out_stats);
+}
+
+void pool_reset_task_stats() {
+    task_pool.reset_stats();
+}
+
+// Sample native tasks, addressable from Python via ctypes.cast(lib.fn, c_void_p)
+
+// arg: long* incremented atomically
+void pool_task_add(void* arg) {
+    std::atomic_ref<long>(*static_cast<long*>(arg)).fetch_add(1, std::memory_order_relaxed);
+}
+
+static std::atomic<std::uint64_t> pool_spin_sink{0};
+
+// arg: iteration count (cast to a pointer) of pure ALU work
+void pool_task_spin(void* arg) {
+    auto iterations = reinterpret_cast<std::uintptr_t>(arg);
+    std::uint64_t x = 0x9e3779b97f4a7c15ULL ^ iterations;
+    for (std::uintptr_t i = 0; i < iterations; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    pool_spin_sink.fetch_add(x, std::memory_order_relaxed);
+}
+
+static std::atomic<long> pool_tree_leaves{0};
+
+static void pool_tree_task(void* arg) {
+    auto depth = reinterpret_cast<std::uintptr_t>(arg);
+    if (depth == 0) {
+        pool_tree_leaves.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // Children go on this worker's deque; idle siblings steal them
+    task_pool.submit(pool_tree_task, reinterpret_cast<void*>(depth - 1));
+    task_pool.submit(pool_tree_task, reinterpret_cast<void*>(depth - 1));
+}
+
+// Binary tree of 2^depth leaf tasks spawned from inside the pool; returns
+// the leaf count once everything has run, or -1 for a bad depth
+long pool_run_tree(int depth) {
+    if (depth < 0 || depth > 24 || task_pool.on_worker_thread()) return -1;
+    pool_tree_leaves.store(0, std::memory_order_relaxed);
+    task_pool_submit(pool_tree_task, reinterpret_cast<void*>(static_cast<std::uintptr_t>(depth)), 1);
+    task_pool.wait_all();
+    return pool_tree_leaves.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// ASYNC COMPLETIONS - Results reported through a pollable fd, no parked threads
+// ============================================================================
+
+// GOOD: wait_for_data, atomic_wait_for_value and acquire_resource_timeout
+// park the calling OS thread. The async forms register a waiter instead,
+// and signal_data_ready / atomic_notify_* / release_resource complete it
+// directly, so nothing blocks while waiting. CPU-bound work goes through
+// async_submit onto the task pool. Either way the (tag, result) pair lands
+// in the queue's completion ring, and the queue's fd becomes readable when
+// the ring goes from empty to non-empty, so an event loop (asyncio
+// add_reader) can await thousands of operations from one thread. eventfd
+// on Linux, a non-blocking pipe elsewhere (pollable by kqueue/select alike).
+
+using async_op_fn = long (*)(long);
+
+// One finished operation
+struct CompletionEntry {
+    long tag;
+    long result;
+};
+
+struct CompletionQueue {
+    explicit CompletionQueue(long capacity)
+        : ring(static_cast<std::size_t>(capacity)) {}
+
+    ~CompletionQueue() {
+        if (read_fd >= 0) ::close(read_fd);
+        if (write_fd >= 0 && write_fd != read_fd) ::close(write_fd);
+    }
+
+    bool open_fds() {
+#ifdef __linux__
+        read_fd = write_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        return read_fd >= 0;
+#else
+        int fds[2];
+        if (::pipe(fds) != 0) return false;
+        for (int fd : fds) {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        read_fd = fds[0];
+        write_fd = fds[1];
+        return true;
+#endif
+    }
+
+    // A full pipe or saturated eventfd already reads as ready, so EAGAIN is fine
+    void signal() {
+#ifdef __linux__
+        std::uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = ::write(write_fd, &one, sizeof(one));
+#else
+        char byte = 1;
+        [[maybe_unused]] ssize_t n = ::write(write_fd, &byte, 1);
+#endif
+    }
+
+    void drain() {
+        char buffer[64];
+        while (::read(read_fd, buffer, sizeof(buffer)) > 0) {
+        }
+    }
+
+    // Claims one of `capacity` result slots; false if all are outstanding
+    bool reserve() {
+        long outstanding = in_flight.load(std::memory_order_relaxed);
+        do {
+            if (outstanding >= static_cast<long>(ring.size())) return false;
+        } while (!in_flight.compare_exchange_weak(outstanding, outstanding + 1,
+                                                  std::memory_order_relaxed));
+        running.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Capacity is enforced by reserve(), so the ring never overflows. Only
+    // the empty -> non-empty edge signals; poll re-arms if it leaves entries.
+    // Everything happens under the mutex, so once an entry can be polled
+    // the poster is done with the queue and destroy is safe.
+    void post(CompletionEntry entry) {
+        std::lock_guard lock(mutex);
+        if (count == 0) signal();
+        ring[(head + count) % ring.size()] = entry;
+        count++;
+        running.fetch_sub(1, std::memory_order_release);
+    }
+
+    // For a reservation that will never post (cancelled waiter)
+    void unreserve() {
+        in_flight.fetch_sub(1, std::memory_order_relaxed);
+        running.fetch_sub(1, std::memory_order_release);
+    }
+
+    std::mutex mutex;
+    std::vector<CompletionEntry> ring;
+    std::size_t head = 0;
+    std::size_t count = 0;
+    std::atomic<long> in_flight{0};  // Reserved and not yet polled; bounded by capacity
+    std::atomic<long> running{0};    // Reserved and not yet posted
+    int read_fd = -1;
+    int write_fd = -1;
+};
+
+struct AsyncTask {
+    CompletionQueue* queue;
+    async_op_fn fn;
+    long arg;
+    long tag;
+};
+
+static void run_async_task(void* raw) {
+    AsyncTask* task = static_cast<AsyncTask*>(raw);
+    CompletionQueue* queue = task->queue;
+    CompletionEntry entry{task->tag, task->fn(task->arg)};
+    delete task;
+    queue->post(entry);
+}
+
+// Registered async waits. A signal goes to the semaphore (or counter) as if
+// nobody were registered, then reads the list's waiter count with a seq_cst
+// RMW and only takes async_waiters_mutex if it is non-zero. Registration
+// bumps the count the same way before checking the semaphore. The two RMWs
+// are totally ordered, so whichever side goes second sees the other: a unit
+// never sits in the semaphore while a waiter stays registered, and signals
+// with nobody registered never touch the mutex.
+struct AsyncWaiter {
+    CompletionQueue* queue;
+    long tag;
+    long value;  // Unchanged-value for counter waits
+};
+
+static std::mutex async_waiters_mutex;
+static std::deque<AsyncWaiter> async_data_waiters;
+static std::deque<AsyncWaiter> async_resource_waiters;
+static std::vector<AsyncWaiter> async_value_waiters;
+// Entries in each list above; changed under the mutex, read lock-free by signals
+static std::atomic<long> async_data_waiter_count{0};
+static std::atomic<long> async_resource_waiter_count{0};
+static std::atomic<long> async_value_waiter_count{0};
+
+// True if a waiter may be registered; fetch_add(0) rather than a load, see above
+static bool async_waiters_registered(std::atomic<long>& count) {
+    return count.fetch_add(0, std::memory_order_seq_cst) != 0;
+}
+
+// Moves units the semaphore holds to registered waiters, oldest first.
+// Caller holds async_waiters_mutex.
+static void async_hand_off(std::deque<AsyncWaiter>& waiters, std::atomic<long>& count,
+                           bool (*try_take)()) {
+    while (!waiters.empty() && try_take()) {
+        AsyncWaiter waiter = waiters.front();
+        waiters.pop_front();
+        count.fetch_sub(1, std::memory_order_relaxed);
+        waiter.queue->post({waiter.tag, 1});
+    }
+}
+
+static void async_deliver_data_signal() {
+    data_ready.release();
+    if (!async_waiters_registered(async_data_waiter_count)) return;
+    std::lock_guard lock(async_waiters_mutex);
+    async_hand_off(async_data_waiters, async_data_waiter_count,
+                   [] { return data_ready.try_acquire(); });
+}
+
+static void async_deliver_resource_release() {
+    resource_pool.release();
+    if (!async_waiters_registered(async_resource_waiter_count)) return;
+    std::lock_guard lock(async_waiters_mutex);
+    async_hand_off(async_resource_waiters, async_resource_waiter_count,
+                   [] { return resource_pool.try_acquire(); });
+}
+
+static long async_notify_value_waiters(bool only_one) {
+    if (!async_waiters_registered(async_value_waiter_count)) return 0;
+    std::lock_guard lock(async_waiters_mutex);
+    long current = atomic_counter.load(std::memory_order_acquire);
+    long woken = 0;
+    for (auto it = async_value_waiters.begin(); it != async_value_waiters.end();) {
+        if (it->value == current) {
+            ++it;
+            continue;
+        }
+        it->queue->post({it->tag, current});
+        it = async_value_waiters.erase(it);
+        async_value_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+        woken++;
+        if (only_one) break;
+    }
+    return woken;
+}
+
+// Returns nullptr if capacity <= 0 or the fd cannot be created
+void* completion_queue_create(long capacity) {
+    if (capacity <= 0) return nullptr;
+    auto queue = std::make_unique<CompletionQueue>(capacity);
+    if (!queue->open_fds()) return nullptr;
+    return queue.release();
+}
+
+// Returns -1 (and keeps the queue) while operations or waits are pending
+int completion_queue_destroy(void* handle) {
+    CompletionQueue* queue = static_cast<CompletionQueue*>(handle);
+    {
+        std::lock_guard lock(queue->mutex);
+        if (queue->running.load(std::memory_order_acquire) > 0) return -1;
+    }
+    delete queue;
+    return 0;
+}
+
+// Readable whenever completions are waiting to be polled
+int completion_queue_fd(void* handle) {
+    return static_cast<CompletionQueue*>(handle)->read_fd;
+}
+
+// Runs fn(arg) on the task pool and posts (tag, result) when it returns.
+// Returns 1 if submitted, 0 if `capacity` completions are already
+// outstanding, -1 on bad arguments.
+int async_submit(void* handle, async_op_fn fn, long arg, long tag) {
+    CompletionQueue* queue = static_cast<CompletionQueue*>(handle);
+    if (queue == nullptr || fn == nullptr) return -1;
+    if (!queue->reserve()) return 0;
+    task_pool_submit(run_async_task, new AsyncTask{queue, fn, arg, tag}, 1);
+    return 1;
+}
+
+// Async wait_for_data: posts (tag, 1) once a data_ready signal is taken.
+// Same return codes as async_submit.
+int async_wait_for_data(void* handle, long tag) {
+    CompletionQueue* queue = static_cast<CompletionQueue*>(handle);
+    if (queue == nullptr) return -1;
+    if (!queue->reserve()) return 0;
+    std::lock_guard lock(async_waiters_mutex);
+    async_data_waiter_count.fetch_add(1, std::memory_order_seq_cst);  // Before the check, see above
+    if (data_ready.try_acquire()) {
+        async_data_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+        queue->post({tag, 1});
+    } else {
+        async_data_waiters.push_back({queue, tag, 0});
+    }
+    return 1;
+}
+
+// Async acquire_resource: posts (tag, 1) once a resource unit is held.
+// There is no timeout; use async_cancel (e.g. from asyncio.wait_for).
+int async_acquire_resource(void* handle, long tag) {
+    CompletionQueue* queue = static_cast<CompletionQueue*>(handle);
+    if (queue == nullptr) return -1;
+    if (!queue->reserve()) return 0;
+    std::lock_guard lock(async_waiters_mutex);
+    async_resource_waiter_count.fetch_add(1, std::memory_order_seq_cst);
+    if (resource_pool.try_acquire()) {
+        async_resource_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+        queue->post({tag, 1});
+    } else {
+        async_resource_waiters.push_back({queue, tag, 0});
+    }
+    return 1;
+}
+
+// Async atomic_wait_for_value: posts (tag, new value) at the first
+// atomic_notify_* that finds atomic_counter != value
+int async_wait_for_value(void* handle, long value, long tag) {
+    CompletionQueue* queue = static_cast<CompletionQueue*>(handle);
+    if (queue == nullptr) return -1;
+    if (!queue->reserve()) return 0;
+    std::lock_guard lock(async_waiters_mutex);
+    async_value_waiter_count.fetch_add(1, std::memory_order_seq_cst);
+    long current = atomic_counter.load(std::memory_order_acquire);
+    if (current != value) {
+        async_value_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+        queue->post({tag, current});
+    } else {
+        async_value_waiters.push_back({queue, tag, value});
+    }
+    return 1;
+}
+
+// Drops a registered wait that has not completed; returns 1 if one was
+// removed, 0 if none matched (it may already be in the ring)
+int async_cancel(void* handle, long tag) {
+    CompletionQueue* queue = static_cast<CompletionQueue*>(handle);
+    std::lock_guard lock(async_waiters_mutex);
+    auto matches = [&](const AsyncWaiter& w) { return w.queue == queue && w.tag == tag; };
+    std::pair<std::deque<AsyncWaiter>*, std::atomic<long>*> lists[] = {
+        {&async_data_waiters, &async_data_waiter_count},
+        {&async_resource_waiters, &async_resource_waiter_count},
+    };
+    for (auto [waiters, count] : lists) {
+        if (auto it = std::ranges::find_if(*waiters, matches); it != waiters->end()) {
+            waiters->erase(it);
+            count->fetch_sub(1, std::memory_order_relaxed);
+            queue->unreserve();
+            return 1;
+        }
+    }
+    if (auto it = std::ranges::find_if(async_value_waiters, matches); it != async_value_waiters.end()) {
+        async_value_waiters.erase(it);
+        async_value_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+        queue->unreserve();
+        return 1;
+    }
+    return 0;
+}
+
+// Non-blocking: clears the fd and copies up to max_entries completions to
+// out. If more remain the fd is signalled again. Returns the count copied.
+long completion_queue_poll(void* handle, CompletionEntry* out, long max_entries) {
+    CompletionQueue* queue = static_cast<CompletionQueue*>(handle);
+    if (queue == nullptr || out == nullptr || max_entries < 0) return -1;
+    queue->drain();
+    std::lock_guard lock(queue->mutex);
+    std::size_t n = std::min(queue->count, static_cast<std::size_t>(max_entries));
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = queue->ring[(queue->head + i) % queue->ring.size()];
+    }
+    queue->head = (queue->head + n) % queue->ring.size();
+    queue->count -= n;
+    queue->in_flight.fetch_sub(static_cast<long>(n), std::memory_order_relaxed);
+    if (queue->count > 0) queue->signal();
+    return static_cast<long>(n);
+}
+
+// Submitted operations and waits not yet returned by poll
+long completion_queue_outstanding(void* handle) {
+    return static_cast<CompletionQueue*>(handle)->in_flight.load(std::memory_order_relaxed);
+}
+
+// CPU-bound operation for async_submit: `iterations` rounds of xorshift
+long async_op_spin(long iterations) {
+    std::uint64_t x = 0x9e3779b97f4a7c15ULL ^ static_cast<std::uint64_t>(iterations);
+    for (long i = 0; i < iterations; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return static_cast<long>(x >> 1);
+}
+
+// ============================================================================
+// SYNC PRIMITIVE BENCHMARK - Native baseline without FFI/GIL overhead
+// ============================================================================
+
+enum SyncPrimitive : int {
+    SYNC_MUTEX = 0,          // global_mutex, as in safe_increment
+    SYNC_SHARED_READ = 1,    // shared_mutex shared lock, as in safe_read
+    SYNC_SHARED_WRITE = 2,   // shared_mutex exclusive lock, as in safe_write
+    SYNC_ATOMIC = 3,         // atomic_counter.fetch_add
+    SYNC_SEMAPHORE = 4,      // resource_pool acquire/release
+    SYNC_BARRIER = 5,        // arrive_and_wait on a barrier sized to `threads`
+    SYNC_SHARDED = 6,        // sharded_increment slot
+    SYNC_BUFFER_MUTEX = 7,   // safe_write_buffer on buffer_mutex
+    SYNC_BUFFER_ARENA = 8,   // arena_write_buffer + arena_reset_thread
+    SYNC_ADAPTIVE = 9,       // adaptive_mutex, as in adaptive_increment
+    SYNC_COMBINING = 10,     // combining_increment(1); latency covers the whole op
+    SYNC_PRIMITIVE_COUNT
+};
+
+// Filled by run_sync_benchmark
+struct SyncBenchStats {
+    int primitive_id;
+    int threads;
+    long total_ops;
+    double elapsed_seconds;
+    double ops_per_sec;
+    double p50_acquire_ns;
+    double p99_acquire_ns;
+    double max_acquire_ns;
+};
+
+// Cap per-thread latency samples so large runs don't allocate unboundedly.
+// Samples only feed the percentiles; the max is taken over every acquire.
+static constexpr int SYNC_BENCH_MAX_SAMPLES = 1 << 16;
+
+// Raise `target` to `value` if larger; relaxed, as nothing is published with it
+static void atomic_fetch_max(std::atomic<std::int64_t>& target, std::int64_t value) {
+    std::int64_t current = target.load(std::memory_order_relaxed);
+    while (current < value &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        // current is reloaded by the failed CAS
+    }
+}
+
+// Nearest-rank percentile of an already sorted sample set
+static double sorted_percentile(const std::vector<std::int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    std::size_t idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+    return static_cast<double>(sorted[idx]);
+}
+
+// One operation of the given primitive; returns nanoseconds spent acquiring.
+// Every op is timed so the max can't miss a stall between samples; for the
+// atomic cases the clock reads are a large share of the reported throughput.
+static std::int64_t sync_bench_op(int primitive_id, std::barrier<>& barrier) {
+    using clock = std::chrono::steady_clock;
+    clock::time_point start = clock::now();
+    std::int64_t acquire_ns = 0;
+    auto acquired = [&] {
+        acquire_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now() - start).count();
+    };
+
+    switch (primitive_id) {
+        case SYNC_MUTEX: {
+            std::lock_guard lock(global_mutex);
+            acquired();
+            safe_counter++;
+            published_safe_counter.value.store(safe_counter, std::memory_order_relaxed);
+            break;
+        }
+        case SYNC_SHARED_READ: {
+            std::shared_lock lock(shared_mutex);
+            acquired();
+            long value = shared_data;
+            COMPILER_BARRIER();
+            (void)value;
+            break;
+        }
+        case SYNC_SHARED_WRITE: {
+            std::unique_lock lock(shared_mutex);
+            acquired();
+            shared_data++;
+            break;
+        }
+        case SYNC_ATOMIC:
+            atomic_counter.fetch_add(1, std::memory_order_relaxed);
+            acquired();
+            break;
+        case SYNC_SEMAPHORE:
+            resource_pool.acquire();
+            acquired();
+            resource_pool.release();
+            break;
+        case SYNC_BARRIER:
+            barrier.arrive_and_wait();
+            acquired();
+            break;
+        case SYNC_SHARDED:
+            this_thread_shard().value.fetch_add(1, std::memory_order_relaxed);
+            acquired();
+            break;
+        case SYNC_ADAPTIVE: {
+            std::lock_guard lock(adaptive_mutex);
+            acquired();
+            adaptive_counter++;
+            published_adaptive_counter.value.store(adaptive_counter, std::memory_order_relaxed);
+            break;
+        }
+        case SYNC_COMBINING:
+            combining_increment(1);
+            acquired();
+            break;
+        case SYNC_BUFFER_MUTEX: {
+            // Latency here covers the whole write, since the lock is internal
+            const char* result = safe_write_buffer("bench");
+            acquired();
+            COMPILER_BARRIER();
+            (void)result;
+            break;
+        }
+        case SYNC_BUFFER_ARENA: {
+            const char* result = arena_write_buffer("bench");
+            acquired();
+            COMPILER_BARRIER();
+            (void)result;
+            arena_reset_thread();
+            break;
+        }
+    }
+    return acquire_ns;
+}
+
+// Spawn `threads` native threads doing `iterations` operations each on the
+// selected primitive. Returns 0 on success, -1 on invalid arguments.
+int run_sync_benchmark(int primitive_id, int threads, int iterations, SyncBenchStats* out_stats) {
+    if (out_stats == nullptr || threads <= 0 || iterations <= 0 ||
+        primitive_id < 0 || primitive_id >= SYNC_PRIMITIVE_COUNT) {
+        return -1;
+    }
+
+    const int sample_stride = std::max(1, iterations / SYNC_BENCH_MAX_SAMPLES);
+    std::vector<std::vector<std::int64_t>> samples(threads);
+    std::atomic<std::int64_t> max_acquire_ns{0};
+    std::barrier<> op_barrier{threads};
+    std::latch ready{threads + 1};
+    std::latch go{1};
+
+    // std::thread rather than jthread so this also builds under THREADTEST_NO_JTHREAD
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            std::vector<std::int64_t>& mine = samples[t];
+            mine.reserve(iterations / sample_stride + 1);
+            ready.count_down();
+            go.wait();
+            benchperf::ScopedRegion counted(COUNTER_REGION_SYNC_BENCH);
+            for (int i = 0; i < iterations; i++) {
+                std::int64_t ns = sync_bench_op(primitive_id, op_barrier);
+                atomic_fetch_max(max_acquire_ns, ns);
+                if (i % sample_stride == 0) mine.push_back(ns);
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto start = std::chrono::steady_clock::now();
+    go.count_down();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::vector<std::int64_t> all;
+    for (const auto& mine : samples) {
+        all.insert(all.end(), mine.begin(), mine.end());
+    }
+    std::ranges::sort(all);
+
+    out_stats->primitive_id = primitive_id;
+    out_stats->threads = threads;
+    out_stats->total_ops = static_cast<long>(threads) * iterations;
+    out_stats->elapsed_seconds = elapsed.count();
+    out_stats->ops_per_sec = elapsed.count() > 0.0
+        ? static_cast<double>(out_stats->total_ops) / elapsed.count()
+        : 0.0;
+    out_stats->p50_acquire_ns = sorted_percentile(all, 0.50);
+    out_stats->p99_acquire_ns = sorted_percentile(all, 0.99);
+    out_stats->max_acquire_ns = static_cast<double>(max_acquire_ns.load(std::memory_order_relaxed));
+    return 0;
+}
+
+// ============================================================================
+// ALLOCATOR BENCHMARK - malloc vs pool under a multi-threaded arena pattern
+// ============================================================================
+
+enum BenchAllocator : int {
+    ALLOC_MALLOC = 0,
+    ALLOC_POOL = 1,
+    ALLOC_COUNT
+};
+
+struct AllocBenchStats {
+    int allocator;
+    int threads;
+    long total_ops;          // alloc+free pairs
+    double elapsed_seconds;
+    double ops_per_sec;
+    double p50_alloc_ns;
+    double p99_alloc_ns;
+    double p50_free_ns;
+    double p99_free_ns;
+    long rss_before_bytes;
+    long rss_after_bytes;    // After every block has been freed again
+};
+
+static long current_rss_bytes() {
+#ifdef __linux__
+    long pages = 0;
+    if (std::FILE* f = std::fopen("/proc/self/statm", "r")) {
+        long total = 0;
+        if (std::fscanf(f, "%ld %ld", &total, &pages) != 2) pages = 0;
+        std::fclose(f);
+    }
+    static const long page_size = sysconf(_SC_PAGESIZE);
+    return pages * page_size;
+#else
+    return 0;
+#endif
+}
+
+// Each thread keeps a window of live blocks and replaces one per iteration
+// with a 64..4095-byte block (the mixed sizes trigger_arena_pattern uses to
+// fragment glibc arenas). Halfway through, threads swap windows so the
+// second half frees blocks another thread allocated.
+int run_alloc_benchmark(int allocator, int threads, int iterations, AllocBenchStats* out_stats) {
+    if (out_stats == nullptr || threads <= 0 || iterations <= 0 ||
+        allocator < 0 || allocator >= ALLOC_COUNT) {
+        return -1;
+    }
+
+    static constexpr std::size_t WINDOW = 512;
+    auto do_alloc = [allocator](std::size_t size) -> void* {
+        return allocator == ALLOC_POOL ? benchpool::allocate(size) : std::malloc(size);
+    };
+    auto do_free = [allocator](void* ptr) {
+        if (allocator == ALLOC_POOL) benchpool::deallocate(ptr); else std::free(ptr);
+    };
+
+    const long rss_before = current_rss_bytes();
+    const int sample_stride = std::max(1, iterations / SYNC_BENCH_MAX_SAMPLES);
+    std::vector<std::vector<void*>> windows(threads, std::vector<void*>(WINDOW, nullptr));
+    std::vector<std::vector<std::int64_t>> alloc_samples(threads), free_samples(threads);
+    std::barrier<> halfway{threads};
+    std::latch ready{threads + 1};
+    std::latch go{1};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            using clock = std::chrono::steady_clock;
+            alloc_samples[t].reserve(iterations / sample_stride + 1);
+            free_samples[t].reserve(iterations / sample_stride + 1);
+            std::uint32_t rng = 0x9E3779B9u * static_cast<std::uint32_t>(t + 1);
+            ready.count_down();
+            go.wait();
+            benchperf::ScopedRegion counted(COUNTER_REGION_ALLOC_BENCH);
+            for (int i = 0; i < iterations; i++) {
+                if (i == iterations / 2) {
+                    halfway.arrive_and_wait();
+                }
+                std::vector<void*>& window = windows[i < iterations / 2 ? t : (t + 1) % threads];
+                rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;  // xorshift32
+                void*& slot = window[rng % WINDOW];
+                std::size_t size = 64 + (rng >> 8) % 4032;
+                bool timed = (i % sample_stride) == 0;
+
+                auto t0 = clock::now();
+                if (slot != nullptr) do_free(slot);
+                auto t1 = clock::now();
+                slot = do_alloc(size);
+                auto t2 = clock::now();
+                if (slot != nullptr) static_cast<char*>(slot)[0] = static_cast<char>(i);
+
+                if (timed) {
+                    free_samples[t].push_back(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+                    alloc_samples[t].push_back(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+                }
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto start = std::chrono::steady_clock::now();
+    go.count_down();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (std::vector<void*>& window : windows) {
+        for (void* ptr : window) {
+            if (ptr != nullptr) do_free(ptr);
+        }
+    }
+    const long rss_after = current_rss_bytes();
+
+    auto merge_sorted = [](const std::vector<std::vector<std::int64_t>>& per_thread) {
+        std::vector<std::int64_t> all;
+        for (const auto& samples : per_thread) {
+            all.insert(all.end(), samples.begin(), samples.end());
+        }
+        std::ranges::sort(all);
+        return all;
+    };
+    std::vector<std::int64_t> allocs = merge_sorted(alloc_samples);
+    std::vector<std::int64_t> frees = merge_sorted(free_samples);
+
+    out_stats->allocator = allocator;
+    out_stats->threads = threads;
+    out_stats->total_ops = static_cast<long>(threads) * iterations;
+    out_stats->elapsed_seconds = elapsed.count();
+    out_stats->ops_per_sec = elapsed.count() > 0.0
+        ? static_cast<double>(out_stats->total_ops) / elapsed.count()
+        : 0.0;
+    out_stats->p50_alloc_ns = sorted_percentile(allocs, 0.50);
+    out_stats->p99_alloc_ns = sorted_percentile(allocs, 0.99);
+    out_stats->p50_free_ns = sorted_percentile(frees, 0.50);
+    out_stats->p99_free_ns = sorted_percentile(frees, 0.99);
+    out_stats->rss_before_bytes = rss_before;
+    out_stats->rss_after_bytes = rss_after;
+    return 0;
+}
+
+// ============================================================================
+// READER-WRITER BENCHMARK - shared_mutex vs seqlock vs RCU-style snapshots
+// ============================================================================
+
+enum RwPrimitive : int {
+    RW_SHARED_MUTEX = 0,  // shared_config under shared_mutex
+    RW_SEQLOCK = 1,       // seqlock_read / seqlock_write
+    RW_RCU = 2,           // rcu_read / rcu_publish
+    RW_PRIMITIVE_COUNT
+};
+
+struct RwBenchStats {
+    int primitive_id;
+    int threads;
+    int write_permille;      // Writes per 1000 operations
+    long total_reads;
+    long total_writes;
+    double elapsed_seconds;
+    double ops_per_sec;
+    double p50_read_ns;
+    double p99_read_ns;
+    double p50_write_ns;
+    double p99_write_ns;
+    long torn_reads;         // Reads that saw a half-written record; must be 0
+    long read_retries;       // Seqlock retries (0 for the other primitives)
+};
+
+// Each of `threads` workers does `iterations` operations, picking a write
+// with probability write_permille/1000. Returns 0, or -1 on invalid arguments.
+int run_rw_benchmark(int primitive_id, int threads, int iterations, int write_permille,
+                     RwBenchStats* out_stats) {
+    if (out_stats == nullptr || threads <= 0 || iterations <= 0 ||
+        write_permille < 0 || write_permille > 1000 ||
+        primitive_id < 0 || primitive_id >= RW_PRIMITIVE_COUNT) {
+        return -1;
+    }
+
+    struct WorkerResult {
+        std::vector<std::int64_t> read_ns;
+        std::vector<std::int64_t> write_ns;
+        long reads = 0;
+        long writes = 0;
+        long torn = 0;
+        long retries = 0;
+    };
+
+    const int sample_stride = std::max(1, iterations / SYNC_BENCH_MAX_SAMPLES);
+    std::vector<WorkerResult> results(threads);
+    std::latch ready{threads + 1};
+    std::latch go{1};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            using clock = std::chrono::steady_clock;
+            WorkerResult& mine = results[t];
+            mine.read_ns.reserve(iterations / sample_stride + 1);
+            std::uint32_t rng = 0x9e3779b9u ^ static_cast<std::uint32_t>(t + 1);
+            long words[CONFIG_WORDS];
+            ready.count_down();
+            go.wait();
+            for (int i = 0; i < iterations; i++) {
+                rng ^= rng << 13;
+                rng ^= rng >> 17;
+                rng ^= rng << 5;
+                bool write = static_cast<int>(rng % 1000) < write_permille;
+                bool timed = (i % sample_stride) == 0;
+                clock::time_point start;
+                if (timed) start = clock::now();
+
+                if (write) {
+                    long value = (static_cast<long>(t) << 32) | i;
+                    switch (primitive_id) {
+                        case RW_SHARED_MUTEX: shared_config_write(value); break;
+                        case RW_SEQLOCK: seqlock_write(value); break;
+                        case RW_RCU: rcu_publish(value); break;
+                    }
+                    mine.writes++;
+                } else {
+                    switch (primitive_id) {
+                        case RW_SHARED_MUTEX: shared_config_read(words); break;
+                        case RW_SEQLOCK: mine.retries += seqlock_read_words(words); break;
+                        case RW_RCU: rcu_read_words(words); break;
+                    }
+                    if (!config_consistent(words)) mine.torn++;
+                    mine.reads++;
+                }
+
+                if (timed) {
+                    std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock::now() - start).count();
+                    (write ? mine.write_ns : mine.read_ns).push_back(ns);
+                }
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto start = std::chrono::steady_clock::now();
+    go.count_down();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    RwBenchStats stats{};
+    std::vector<std::int64_t> read_ns;
+    std::vector<std::int64_t> write_ns;
+    for (const WorkerResult& mine : results) {
+        read_ns.insert(read_ns.end(), mine.read_ns.begin(), mine.read_ns.end());
+        write_ns.insert(write_ns.end(), mine.write_ns.begin(), mine.write_ns.end());
+        stats.total_reads += mine.reads;
+        stats.total_writes += mine.writes;
+        stats.torn_reads += mine.torn;
+        stats.read_retries += mine.retries;
+    }
+    std::ranges::sort(read_ns);
+    std::ranges::sort(write_ns);
+
+    stats.primitive_id = primitive_id;
+    stats.threads = threads;
+    stats.write_permille = write_permille;
+    stats.elapsed_seconds = elapsed.count();
+    stats.ops_per_sec = elapsed.count() > 0.0
+        ? static_cast<double>(stats.total_reads + stats.total_writes) / elapsed.count()
+        : 0.0;
+    stats.p50_read_ns = sorted_percentile(read_ns, 0.50);
+    stats.p99_read_ns = sorted_percentile(read_ns, 0.99);
+    stats.p50_write_ns = sorted_percentile(write_ns, 0.50);
+    stats.p99_write_ns = sorted_percentile(write_ns, 0.99);
+    *out_stats = stats;
+    return 0;
+}
+
+// ============================================================================
+// MULTI-LOCK BENCHMARK - Ordered lock table vs std::lock-style back-off
+// ============================================================================
+
+enum MultiLockStrategy : int {
+    MULTI_LOCK_ORDERED = 0,  // multi_lock: ascending stripe order, no retries
+    MULTI_LOCK_BACKOFF = 1,  // std::lock's algorithm: lock one, try the rest, release on failure
+    MULTI_LOCK_STRATEGY_COUNT
+};
+
+struct MultiLockBenchStats {
+    int strategy;
+    int threads;
+    int locks_per_op;
+    int resources;           // Ids are drawn from [0, resources); fewer means more overlap
+    long total_ops;
+    double elapsed_seconds;
+    double ops_per_sec;
+    double p50_acquire_ns;
+    double p99_acquire_ns;
+    long backoffs;           // Times a back-off attempt released everything and retried
+    long lost_updates;       // Expected minus observed table total; must be 0
+};
+
+// std::lock's try-and-back-off over a runtime-sized stripe set: block on
+// the stripe that failed last time, try_lock the others, and on any failure
+// release everything and start again from the one that failed
+static long lock_stripes_backoff(const int* stripes, int count) {
+    long backoffs = 0;
+    int first = 0;
+    for (;;) {
+        lock_table[stripes[first]].mutex.lock();
+        int failed = -1;
+        for (int k = 1; k < count; k++) {
+            int i = (first + k) % count;
+            if (!lock_table[stripes[i]].mutex.try_lock()) {
+                failed = i;
+                for (int j = k - 1; j >= 1; j--) {
+                    lock_table[stripes[(first + j) % count]].mutex.unlock();
+                }
+                lock_table[stripes[first]].mutex.unlock();
+                break;
+            }
+        }
+        if (failed < 0) return backoffs;
+        backoffs++;
+        first = failed;
+        std::this_thread::yield();
+    }
+}
+
+// Each operation picks `locks_per_op` ids from [0, resources), locks them
+// with the chosen strategy and bumps every stripe by one. Returns 0, or -1
+// on invalid arguments. Uses (and resets) the shared lock table.
+int run_multi_lock_benchmark(int strategy, int threads, int iterations, int locks_per_op,
+                             int resources, MultiLockBenchStats* out_stats) {
+    if (out_stats == nullptr || threads <= 0 || iterations <= 0 ||
+        locks_per_op <= 0 || locks_per_op > MULTI_LOCK_MAX || resources <= 0 ||
+        strategy < 0 || strategy >= MULTI_LOCK_STRATEGY_COUNT) {
+        return -1;
+    }
+
+    struct WorkerResult {
+        std::vector<std::int64_t> acquire_ns;
+        long backoffs = 0;
+        long increments = 0;
+    };
+
+    lock_table_reset();
+    const int sample_stride = std::max(1, iterations / SYNC_BENCH_MAX_SAMPLES);
+    std::vector<WorkerResult> results(threads);
+    std::latch ready{threads + 1};
+    std::latch go{1};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            using clock = std::chrono::steady_clock;
+            WorkerResult& mine = results[t];
+            mine.acquire_ns.reserve(iterations / sample_stride + 1);
+            std::uint32_t rng = 0x85ebca6bu ^ static_cast<std::uint32_t>(t + 1) * 0x9e3779b9u;
+            long ids[MULTI_LOCK_MAX];
+            int stripes[MULTI_LOCK_MAX];
+            ready.count_down();
+            go.wait();
+            for (int i = 0; i < iterations; i++) {
+                for (int k = 0; k < locks_per_op; k++) {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 17;
+                    rng ^= rng << 5;
+                    ids[k] = static_cast<long>(rng % static_cast<std::uint32_t>(resources));
+                }
+                int count = sorted_stripes(ids, locks_per_op, stripes);
+                if (strategy == MULTI_LOCK_BACKOFF) {
+                    // Request order as the caller listed them, not sorted
+                    for (int k = count - 1; k > 0; k--) {
+                        std::swap(stripes[k], stripes[rng % static_cast<std::uint32_t>(k + 1)]);
+                    }
+                }
+
+                bool timed = (i % sample_stride) == 0;
+                clock::time_point start;
+                if (timed) start = clock::now();
+                if (strategy == MULTI_LOCK_ORDERED) {
+                    for (int k = 0; k < count; k++) lock_table[stripes[k]].mutex.lock();
+                } else {
+                    mine.backoffs += lock_stripes_backoff(stripes, count);
+                }
+                if (timed) {
+                    mine.acquire_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock::now() - start).count());
+                }
+
+                for (int k = 0; k < count; k++) lock_table[stripes[k]].value++;
+                mine.increments += count;
+                for (int k = count - 1; k >= 0; k--) lock_table[stripes[k]].mutex.unlock();
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto start = std::chrono::steady_clock::now();
+    go.count_down();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    MultiLockBenchStats stats{};
+    std::vector<std::int64_t> acquire_ns;
+    long expected = 0;
+    for (const WorkerResult& mine : results) {
+        acquire_ns.insert(acquire_ns.end(), mine.acquire_ns.begin(), mine.acquire_ns.end());
+        stats.backoffs += mine.backoffs;
+        expected += mine.increments;
+    }
+    std::ranges::sort(acquire_ns);
+
+    stats.strategy = strategy;
+    stats.threads = threads;
+    stats.locks_per_op = locks_per_op;
+    stats.resources = resources;
+    stats.total_ops = static_cast<long>(threads) * iterations;
+    stats.elapsed_seconds = elapsed.count();
+    stats.ops_per_sec = elapsed.count() > 0.0
+        ? static_cast<double>(stats.total_ops) / elapsed.count()
+        : 0.0;
+    stats.p50_acquire_ns = sorted_percentile(acquire_ns, 0.50);
+    stats.p99_acquire_ns = sorted_percentile(acquire_ns, 0.99);
+    stats.lost_updates = expected - lock_table_total();
+    *out_stats = stats;
+    return 0;
+}
+
+
+// ============================================================================
+// LEDGER BENCHMARK - Transfer throughput across threads and account skew
+// ============================================================================
+
+struct LedgerBenchStats {
+    int threads;
+    int batch;               // Transfers per ledger_batch_apply call; 1 calls ledger_transfer
+    long accounts;
+    double zipf_s;           // Skew exponent; 0 is uniform, ~1 concentrates on a few hot accounts
+    long total_ops;
+    long moved;              // Transfers that went through
+    long insufficient;       // Transfers refused for lack of funds
+    double elapsed_seconds;
+    double ops_per_sec;
+    double p50_op_ns;        // Per-transfer latency, sampled per call and divided by the batch
+    double p99_op_ns;
+    double hottest_share;    // Probability mass of account 0 under the Zipf distribution
+    long imbalance;          // Initial total minus final total; must be 0
+    long min_balance;        // Must never go negative
+};
+
+// Inverse-CDF Zipf sampler: weight of rank k (0-based) is 1/(k+1)^s
+static std::vector<double> zipf_cdf(long n, double s) {
+    std::vector<double> cdf(static_cast<std::size_t>(n));
+    double sum = 0.0;
+    for (long k = 0; k < n; k++) {
+        sum += s == 0.0 ? 1.0 : 1.0 / std::pow(static_cast<double>(k + 1), s);
+        cdf[k] = sum;
+    }
+    for (double& c : cdf) c /= sum;
+    cdf.back() = 1.0;
+    return cdf;
+}
+
+static long zipf_sample(const std::vector<double>& cdf, std::uint64_t& rng) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    double u = static_cast<double>(rng >> 11) * 0x1.0p-53;
+    auto it = std::ranges::upper_bound(cdf, u);
+    return std::min<long>(it - cdf.begin(), static_cast<long>(cdf.size()) - 1);
+}
+
+// Each worker moves 1..8 units between two Zipf-chosen accounts, either one
+// ledger_transfer per op or `batch` ops per ledger_batch_apply. The ledger
+// is re-created with 1000 per account. Returns 0, or -1 on invalid arguments.
+int run_ledger_benchmark(int threads, int iterations, long accounts, double zipf_s, int batch,
+                         LedgerBenchStats* out_stats) {
+    static constexpr long LEDGER_BENCH_BALANCE = 1000;
+    if (out_stats == nullptr || threads <= 0 || iterations <= 0 || accounts < 2 ||
+        !(zipf_s >= 0.0) || batch <= 0 || batch > iterations) {
+        return -1;
+    }
+    if (ledger_init(accounts, LEDGER_BENCH_BALANCE) != 0) return -1;
+
+    struct WorkerResult {
+        std::vector<std::int64_t> op_ns;
+        long moved = 0;
+        long insufficient = 0;
+    };
+
+    const std::vector<double> cdf = zipf_cdf(accounts, zipf_s);
+    const int calls = iterations / batch;
+    const int sample_stride = std::max(1, calls / SYNC_BENCH_MAX_SAMPLES);
+    std::vector<WorkerResult> results(threads);
+    std::latch ready{threads + 1};
+    std::latch go{1};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            using clock = std::chrono::steady_clock;
+            WorkerResult& mine = results[t];
+            mine.op_ns.reserve(calls / sample_stride + 1);
+            std::uint64_t rng = 0x9e3779b97f4a7c15ull * static_cast<std::uint64_t>(t + 1);
+            std::vector<LedgerOp> ops(batch);
+            std::vector<int> outcome(batch);
+            ready.count_down();
+            go.wait();
+            for (int c = 0; c < calls; c++) {
+                for (LedgerOp& op : ops) {
+                    op.from = zipf_sample(cdf, rng);
+                    op.to = zipf_sample(cdf, rng);
+                    if (op.to == op.from) op.to = (op.to + 1) % accounts;
+                    op.amount = 1 + static_cast<long>(rng & 7);
+                }
+
+                bool timed = (c % sample_stride) == 0;
+                clock::time_point start;
+                if (timed) start = clock::now();
+                if (batch == 1) {
+                    outcome[0] = ledger_transfer(ops[0].from, ops[0].to, ops[0].amount);
+                } else {
+                    ledger_batch_apply(ops.data(), batch, outcome.data());
+                }
+                if (timed) {
+                    mine.op_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock::now() - start).count() / batch);
+                }
+
+                for (int result : outcome) {
+                    if (result == 1) mine.moved++;
+                    else mine.insufficient++;
+                }
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto start = std::chrono::steady_clock::now();
+    go.count_down();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    LedgerBenchStats stats{};
+    std::vector<std::int64_t> op_ns;
+    for (const WorkerResult& mine : results) {
+        op_ns.insert(op_ns.end(), mine.op_ns.begin(), mine.op_ns.end());
+        stats.moved += mine.moved;
+        stats.insufficient += mine.insufficient;
+    }
+    std::ranges::sort(op_ns);
+
+    stats.threads = threads;
+    stats.batch = batch;
+    stats.accounts = accounts;
+    stats.zipf_s = zipf_s;
+    stats.total_ops = static_cast<long>(threads) * calls * batch;
+    stats.elapsed_seconds = elapsed.count();
+    stats.ops_per_sec = elapsed.count() > 0.0
+        ? static_cast<double>(stats.total_ops) / elapsed.count()
+        : 0.0;
+    stats.p50_op_ns = sorted_percentile(op_ns, 0.50);
+    stats.p99_op_ns = sorted_percentile(op_ns, 0.99);
+    stats.hottest_share = cdf.front();
+    stats.imbalance = accounts * LEDGER_BENCH_BALANCE - ledger_total();
+    stats.min_balance = LEDGER_BENCH_BALANCE;
+    for (long i = 0; i < accounts; i++) {
+        stats.min_balance = std::min(stats.min_balance, ledger_balance(i));
+    }
+    *out_stats = stats;
+    return 0;
+}
+
+
+// ============================================================================
+// BARRIER BENCHMARK - Phase overhead of central vs tree barriers
+// ============================================================================
+
+struct BarrierBenchStats {
+    int threads;
+    int fan_in;              // 0 asks for a central barrier; reported as the effective fan-in
+    int depth;
+    int work_iterations;     // CPU_RELAX spins per thread between phases
+    long phases;
+    double elapsed_seconds;
+    double ns_per_phase;
+    double mean_wait_ns;
+    double p50_wake_ns;      // Last arrival to a waiter running again
+    double p99_wake_ns;
+    long completions;        // Completion callbacks seen; must equal phases
+};
+
+static void count_barrier_completion(void* context, long) {
+    static_cast<std::atomic<long>*>(context)->fetch_add(1, std::memory_order_relaxed);
+}
+
+// Each thread does `work_iterations` of spinning then arrives, `phases`
+// times. Thread t also spins t extra rounds so arrivals are staggered.
+// Returns 0, or -1 on invalid arguments.
+int run_barrier_benchmark(int threads, int fan_in, int phases, int work_iterations,
+                          BarrierBenchStats* out_stats) {
+    if (out_stats == nullptr || threads <= 0 || phases <= 0 || work_iterations < 0 ||
+        fan_in < 0 || fan_in == 1) {
+        return -1;
+    }
+
+    std::atomic<long> completions{0};
+    std::unique_ptr<PhaseBarrier> barrier(static_cast<PhaseBarrier*>(
+        fan_in == 0 ? barrier_create(threads, count_barrier_completion, &completions)
+                    : barrier_create_tree(threads, fan_in, count_barrier_completion, &completions)));
+
+    const int sample_stride = std::max(1, phases / SYNC_BENCH_MAX_SAMPLES);
+    std::vector<std::vector<std::int64_t>> wake_samples(threads);
+    std::latch ready{threads + 1};
+    std::latch go{1};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            std::vector<std::int64_t>& mine = wake_samples[t];
+            mine.reserve(phases / sample_stride + 1);
+            ready.count_down();
+            go.wait();
+            for (int p = 0; p < phases; p++) {
+                for (int i = 0; i < work_iterations + t; i++) CPU_RELAX();
+                std::int64_t wake_ns = 0;
+                barrier_arrive(*barrier, t, &wake_ns);
+                if (p % sample_stride == 0 && wake_ns > 0) mine.push_back(wake_ns);
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto start = std::chrono::steady_clock::now();
+    go.count_down();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::vector<std::int64_t> wake_ns;
+    for (const auto& mine : wake_samples) {
+        wake_ns.insert(wake_ns.end(), mine.begin(), mine.end());
+    }
+    std::ranges::sort(wake_ns);
+
+    BarrierStats barrier_stats;
+    barrier_get_stats(barrier.get(), &barrier_stats);
+
+    BarrierBenchStats stats{};
+    stats.threads = threads;
+    stats.fan_in = barrier_stats.fan_in;
+    stats.depth = barrier_stats.depth;
+    stats.work_iterations = work_iterations;
+    stats.phases = barrier_stats.phases;
+    stats.elapsed_seconds = elapsed.count();
+    stats.ns_per_phase = elapsed.count() * 1e9 / static_cast<double>(phases);
+    stats.mean_wait_ns = barrier_stats.mean_wait_ns;
+    stats.p50_wake_ns = sorted_percentile(wake_ns, 0.50);
+    stats.p99_wake_ns = sorted_percentile(wake_ns, 0.99);
+    stats.completions = completions.load();
+    *out_stats = stats;
+    return 0;
+}
+
+
+// ============================================================================
+// OBJECT POOL BENCHMARK - Bare semaphore vs handle pool, shared vs cached
+// ============================================================================
+
+enum ObjectPoolBenchMode : int {
+    OBJECT_POOL_BENCH_SEMAPHORE = 0,  // Counting semaphore alone, like resource_pool: no handle
+    OBJECT_POOL_BENCH_SHARED = 1,     // ObjectPool without thread caches
+    OBJECT_POOL_BENCH_CACHED = 2,     // ObjectPool with OBJECT_POOL_CACHE_MAX cached slots per thread
+    OBJECT_POOL_BENCH_MODE_COUNT
+};
+
+struct ObjectPoolBenchStats {
+    int mode;
+    int threads;
+    long capacity;           // threads > capacity means threads queue for slots
+    long total_ops;          // acquire + release pairs
+    double elapsed_seconds;
+    double ops_per_sec;
+    double p50_acquire_ns;
+    double p99_acquire_ns;
+    double p50_release_ns;
+    double p99_release_ns;
+    double cache_hit_rate;   // Acquires served from the caller's own cache
+    long steals;
+    long waits;
+    long overlaps;           // A payload seen held by two threads at once; must be 0
+};
+
+// Each iteration acquires (waiting forever), stamps the payload with the
+// thread id, spins `hold_iterations`, checks the stamp and releases.
+// Returns 0, or -1 on invalid arguments.
+int run_object_pool_benchmark(int mode, int threads, int iterations, long capacity,
+                              int hold_iterations, ObjectPoolBenchStats* out_stats) {
+    if (out_stats == nullptr || threads <= 0 || iterations <= 0 || capacity <= 0 ||
+        hold_iterations < 0 || mode < 0 || mode >= OBJECT_POOL_BENCH_MODE_COUNT) {
+        return -1;
+    }
+
+    struct WorkerResult {
+        std::vector<std::int64_t> acquire_ns;
+        std::vector<std::int64_t> release_ns;
+        long overlaps = 0;
+    };
+
+    std::counting_semaphore<> semaphore(static_cast<std::ptrdiff_t>(capacity));
+    std::unique_ptr<ObjectPool> pool;
+    if (mode != OBJECT_POOL_BENCH_SEMAPHORE) {
+        pool.reset(static_cast<ObjectPool*>(object_pool_create(
+            capacity, sizeof(long), mode == OBJECT_POOL_BENCH_CACHED ? OBJECT_POOL_CACHE_MAX : 0)));
+        if (!pool) return -1;
+    }
+
+    const int sample_stride = std::max(1, iterations / SYNC_BENCH_MAX_SAMPLES);
+    std::vector<WorkerResult> results(threads);
+    std::latch ready{threads + 1};
+    std::latch go{1};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            using clock = std::chrono::steady_clock;
+            WorkerResult& mine = results[t];
+            mine.acquire_ns.reserve(iterations / sample_stride + 1);
+            mine.release_ns.reserve(iterations / sample_stride + 1);
+            ready.count_down();
+            go.wait();
+            for (int i = 0; i < iterations; i++) {
+                bool timed = (i % sample_stride) == 0;
+                clock::time_point start;
+                if (timed) start = clock::now();
+
+                ObjectHandle h{-1, nullptr};
+                if (pool) {
+                    object_pool_acquire(pool.get(), -1, &h);
+                } else {
+                    semaphore.acquire();
+                }
+                if (timed) {
+                    mine.acquire_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock::now() - start).count());
+                }
+
+                if (h.payload != nullptr) {
+                    std::atomic_ref<long> stamp(*static_cast<long*>(h.payload));
+                    stamp.store(t + 1, std::memory_order_relaxed);
+                    for (int k = 0; k < hold_iterations; k++) CPU_RELAX();
+                    if (stamp.load(std::memory_order_relaxed) != t + 1) mine.overlaps++;
+                } else {
+                    for (int k = 0; k < hold_iterations; k++) CPU_RELAX();
+                }
+
+                if (timed) start = clock::now();
+                if (pool) {
+                    object_pool_release(pool.get(), h.slot);
+                } else {
+                    semaphore.release();
+                }
+                if (timed) {
+                    mine.release_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock::now() - start).count());
+                }
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto start = std::chrono::steady_clock::now();
+    go.count_down();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    ObjectPoolBenchStats stats{};
+    std::vector<std::int64_t> acquire_ns;
+    std::vector<std::int64_t> release_ns;
+    for (const WorkerResult& mine : results) {
+        acquire_ns.insert(acquire_ns.end(), mine.acquire_ns.begin(), mine.acquire_ns.end());
+        release_ns.insert(release_ns.end(), mine.release_ns.begin(), mine.release_ns.end());
+        stats.overlaps += mine.overlaps;
+    }
+    std::ranges::sort(acquire_ns);
+    std::ranges::sort(release_ns);
+
+    stats.mode = mode;
+    stats.threads = threads;
+    stats.capacity = capacity;
+    stats.total_ops = static_cast<long>(threads) * iterations;
+    stats.elapsed_seconds = elapsed.count();
+    stats.ops_per_sec = elapsed.count() > 0.0
+        ? static_cast<double>(stats.total_ops) / elapsed.count()
+        : 0.0;
+    stats.p50_acquire_ns = sorted_percentile(acquire_ns, 0.50);
+    stats.p99_acquire_ns = sorted_percentile(acquire_ns, 0.99);
+    stats.p50_release_ns = sorted_percentile(release_ns, 0.50);
+    stats.p99_release_ns = sorted_percentile(release_ns, 0.99);
+    if (pool) {
+        ObjectPoolStats pool_stats;
+        object_pool_get_stats(pool.get(), &pool_stats);
+        long slow = pool_stats.shared_acquires + pool_stats.steals;
+        stats.cache_hit_rate = 1.0 - static_cast<double>(slow) / static_cast<double>(stats.total_ops);
+        stats.steals = pool_stats.steals;
+        stats.waits = pool_stats.waits;
+    }
+    *out_stats = stats;
+    return 0;
+}
+
+
+// ============================================================================
+// SHARED MEMORY - Counters, channel and ledger in a shm_open segment
+// ============================================================================
+
+// Every global above is private to the process that loaded the library, so
+// two Python processes never contend on it. This optional mode maps one
+// named POSIX segment; every process attaching the same name shares the
+// counters, a bounded channel and a small ledger in it, and
+// run_shm_benchmark compares the same operations between forked processes
+// and between threads. Only lock-free atomics and PTHREAD_PROCESS_SHARED
+// mutexes live in the segment: std::atomic::wait (and so AdaptiveMutex and
+// the blocking channel paths) parks on process-private futexes, so the
+// shared channel is try-only.
+static_assert(std::atomic<long>::is_always_lock_free);
+static_assert(std::atomic<std::size_t>::is_always_lock_free);
+
+static constexpr std::uint64_t SHM_MAGIC = 0x7468726474657374ULL;  // "thrdtest"
+static constexpr std::uint32_t SHM_VERSION = 2;
+static constexpr std::size_t SHM_CHANNEL_CAPACITY = 1024;
+static constexpr long SHM_LEDGER_MAX_ACCOUNTS = 4096;
+static constexpr long SHM_LEDGER_STRIPES = 64;
+static constexpr int SHM_BENCH_MAX_WORKERS = 256;
+static constexpr int SHM_MAX_ATTACHED = 256;
+
+struct alignas(THREADTEST_CACHE_LINE) ShmMutex {
+    pthread_mutex_t handle;
+};
+
+// The creator placement-constructs this over the zero-filled mapping, then
+// publishes `ready`; attachers wait for it before touching anything else.
+struct ShmSegment {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::atomic<int> ready{0};
+    std::atomic<int> attached{0};  // Processes currently mapping it
+    std::atomic<pid_t> attached_pids[SHM_MAX_ATTACHED];  // One slot per attached process, 0 if free
+
+    alignas(THREADTEST_CACHE_LINE) std::atomic<long> atomic_counter{0};
+    alignas(THREADTEST_CACHE_LINE) std::atomic<long> bank_balance{1000};
+    ShmMutex counter_mutex;
+    long safe_counter = 0;  // Guarded by counter_mutex
+    CounterShard shards[SHARD_COUNT];
+
+    alignas(THREADTEST_CACHE_LINE) std::atomic<std::size_t> enqueue_pos{0};
+    alignas(THREADTEST_CACHE_LINE) std::atomic<std::size_t> dequeue_pos{0};
+    ChannelCell cells[SHM_CHANNEL_CAPACITY];
+
+    ShmMutex ledger_stripes[SHM_LEDGER_STRIPES];
+    long ledger_accounts = 0;  // Accounts in use; set by shm_ledger_init
+    alignas(THREADTEST_CACHE_LINE) std::atomic<long> ledger_balances[SHM_LEDGER_MAX_ACCOUNTS];
+
+    // run_shm_benchmark start gate, shared by forked workers
+    alignas(THREADTEST_CACHE_LINE) std::atomic<int> bench_ready{0};
+    std::atomic<int> bench_go{0};
+    std::atomic<long> bench_checksum{0};
+};
+
+static ShmSegment* shm_segment = nullptr;
+
+static void shm_mutex_init(pthread_mutex_t* mutex) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+#endif
+    pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+// A process that exits without shm_detach keeps its pid slot and its share
+// of `attached`; this frees both for every such process. The CAS makes each
+// correction happen once however many processes prune at the same time.
+static void shm_prune_dead_attachers(ShmSegment& seg) {
+    for (std::atomic<pid_t>& slot : seg.attached_pids) {
+        pid_t pid = slot.load(std::memory_order_acquire);
+        if (pid == 0 || kill(pid, 0) == 0 || errno != ESRCH) continue;
+        if (slot.compare_exchange_strong(pid, 0, std::memory_order_acq_rel)) {
+            seg.attached.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Robust on Linux: if a process dies holding the lock the next locker gets
+// EOWNERDEAD and takes it over. The guarded state is a counter or one
+// transfer, so it is marked consistent rather than abandoned, and the dead
+// owner is pruned from the attached count. `held` is false if the mutex is
+// ENOTRECOVERABLE (or recovery failed); callers then report -1.
+struct ShmLock {
+    explicit ShmLock(ShmMutex& m) : mutex(&m.handle) {
+        int rc = pthread_mutex_lock(mutex);
+#ifdef __linux__
+        if (rc == EOWNERDEAD) {
+            rc = pthread_mutex_consistent(mutex);
+            if (rc != 0) {
+                pthread_mutex_unlock(mutex);  // Leaves it ENOTRECOVERABLE for everyone
+            } else if (shm_segment != nullptr) {
+                shm_prune_dead_attachers(*shm_segment);
+            }
+        }
+#endif
+        held = rc == 0;
+    }
+    ~ShmLock() {
+        if (held) pthread_mutex_unlock(mutex);
+    }
+    ShmLock(const ShmLock&) = delete;
+    ShmLock& operator=(const ShmLock&) = delete;
+
+    pthread_mutex_t* mutex;
+    bool held;
+};
+
+// Records the calling process in a free pid slot; false if all are taken
+static bool shm_register_attacher(ShmSegment& seg) {
+    pid_t self = getpid();
+    for (int pass = 0; pass < 2; pass++) {
+        for (std::atomic<pid_t>& slot : seg.attached_pids) {
+            pid_t empty = 0;
+            if (slot.compare_exchange_strong(empty, self, std::memory_order_acq_rel)) {
+                seg.attached.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        shm_prune_dead_attachers(seg);  // Full: reclaim slots of crashed processes once
+    }
+    return false;
+}
+
+static void shm_init_segment(void* memory) {
+    auto* seg = new (memory) ShmSegment;
+    seg->magic = SHM_MAGIC;
+    seg->version = SHM_VERSION;
+    shm_mutex_init(&seg->counter_mutex.handle);
+    for (ShmMutex& stripe : seg->ledger_stripes) shm_mutex_init(&stripe.handle);
+    for (std::size_t i = 0; i < SHM_CHANNEL_CAPACITY; i++) {
+        seg->cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    seg->ready.store(1, std::memory_order_release);
+}
+
+// An attacher can open the name before the creator has sized or
+// initialised it; wait up to a second for both
+static bool shm_wait_ready(int fd, void*& memory) {
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) return false;
+        if (static_cast<std::size_t>(st.st_size) >= sizeof(ShmSegment)) {
+            if (memory == nullptr) {
+                memory = mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (memory == MAP_FAILED) {
+                    memory = nullptr;
+                    return false;
+                }
+            }
+            auto* seg = static_cast<ShmSegment*>(memory);
+            if (seg->ready.load(std::memory_order_acquire) == 1) return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+// Maps the segment `name` ("/something", as for shm_open). With create != 0
+// the segment is created if it does not exist yet. Returns 1 if this call
+// created it, 0 if it attached an existing one, -1 on error, on a layout
+// mismatch, if this process is already attached or if SHM_MAX_ATTACHED
+// processes already are.
+int shm_attach(const char* name, int create) {
+    if (name == nullptr || shm_segment != nullptr) return -1;
+    int created = 0;
+    int fd = -1;
+    if (create) {
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            created = 1;
+        } else if (errno != EEXIST) {
+            return -1;
+        }
+    }
+    if (fd < 0) fd = shm_open(name, O_RDWR, 0600);
+    if (fd < 0) return -1;
+
+    void* memory = nullptr;
+    bool ok = true;
+    if (created) {
+        ok = ftruncate(fd, sizeof(ShmSegment)) == 0;
+        if (ok) {
+            memory = mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ok = memory != MAP_FAILED;
+            if (ok) shm_init_segment(memory);
+        }
+    } else {
+        ok = shm_wait_ready(fd, memory);
+    }
+    close(fd);
+
+    auto* seg = ok ? static_cast<ShmSegment*>(memory) : nullptr;
+    if (seg != nullptr && (seg->magic != SHM_MAGIC || seg->version != SHM_VERSION ||
+                           !shm_register_attacher(*seg))) {
+        munmap(memory, sizeof(ShmSegment));
+        seg = nullptr;
+    }
+    if (seg == nullptr) {
+        if (created) shm_unlink(name);
+        return -1;
+    }
+    shm_segment = seg;
+    return created;
+}
+
+// Unmaps this process's view; the segment itself lives until it is unlinked
+// and every process has detached. Returns -1 if not attached.
+int shm_detach() {
+    if (shm_segment == nullptr) return -1;
+    pid_t self = getpid();
+    for (std::atomic<pid_t>& slot : shm_segment->attached_pids) {
+        pid_t owned = self;
+        if (slot.compare_exchange_strong(owned, 0, std::memory_order_acq_rel)) {
+            shm_segment->attached.fetch_sub(1, std::memory_order_relaxed);
+            break;  // A forked child inherits the mapping but owns no slot
+        }
+    }
+    munmap(shm_segment, sizeof(ShmSegment));
+    shm_segment = nullptr;
+    return 0;
+}
+
+int shm_unlink_segment(const char* name) {
+    if (name == nullptr) return -1;
+    return shm_unlink(name) == 0 ? 0 : -1;
+}
+
+int shm_is_attached() {
+    return shm_segment != nullptr ? 1 : 0;
+}
+
+// Same results as the atomic_* / safe_* / sharded_* families, on the
+// segment's copies; -1 if not attached (or iterations < 0, or the mutex is
+// unrecoverable)
+long shm_atomic_increment(int iterations) {
+    if (shm_segment == nullptr || iterations < 0) return -1;
+    for (int i = 0; i < iterations; i++) {
+        shm_segment->atomic_counter.fetch_add(1, std::memory_order_relaxed);
+    }
+    return shm_segment->atomic_counter.load(std::memory_order_acquire);
+}
+
+long shm_safe_increment(int iterations) {
+    if (shm_segment == nullptr || iterations < 0) return -1;
+    long value = 0;
+    for (int i = 0; i < iterations; i++) {
+        ShmLock lock(shm_segment->counter_mutex);
+        if (!lock.held) return -1;
+        value = ++shm_segment->safe_counter;
+    }
+    if (iterations == 0) {
+        ShmLock lock(shm_segment->counter_mutex);
+        if (!lock.held) return -1;
+        value = shm_segment->safe_counter;
+    }
+    return value;
+}
+
+// this_thread_slot() is inherited across fork, so mix in the pid to keep
+// each process's threads off each other's shards
+static CounterShard& shm_this_thread_shard() {
+    unsigned pid = static_cast<unsigned>(getpid());
+    return shm_segment->shards[(this_thread_slot() + pid * 7) % SHARD_COUNT];
+}
+
+// Returns this thread's shard value, like sharded_increment
+long shm_sharded_increment(int iterations) {
+    if (shm_segment == nullptr || iterations < 0) return -1;
+    CounterShard& shard = shm_this_thread_shard();
+    for (int i = 0; i < iterations; i++) {
+        shard.value.fetch_add(1, std::memory_order_relaxed);
+    }
+    return shard.value.load(std::memory_order_relaxed);
+}
+
+static long shm_sharded_total(const ShmSegment& seg) {
+    long total = 0;
+    for (const CounterShard& shard : seg.shards) {
+        total += shard.value.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+// 1 if withdrawn, 0 for insufficient funds, -1 if not attached or amount < 0
+int shm_withdraw(long amount) {
+    if (shm_segment == nullptr || amount < 0) return -1;
+    long current = shm_segment->bank_balance.load();
+    while (current >= amount) {
+        if (shm_segment->bank_balance.compare_exchange_weak(current, current - amount)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 1 if pushed, 0 if full (or popped / empty), -1 if not attached
+int shm_channel_try_push(long value) {
+    if (shm_segment == nullptr) return -1;
+    return ring_try_push(shm_segment->cells, SHM_CHANNEL_CAPACITY - 1, shm_segment->enqueue_pos, value)
+        ? 1 : 0;
+}
+
+int shm_channel_try_pop(long* out_value) {
+    if (shm_segment == nullptr || out_value == nullptr) return -1;
+    long value = 0;
+    if (!ring_try_pop(shm_segment->cells, SHM_CHANNEL_CAPACITY - 1, shm_segment->dequeue_pos, value)) {
+        return 0;
+    }
+    *out_value = value;
+    return 1;
+}
+
+// Fixed-size twin of ledger_init: up to SHM_LEDGER_MAX_ACCOUNTS accounts.
+// Not safe while any process is transferring. Returns 0 or -1.
+int shm_ledger_init(long accounts, long initial_balance) {
+    if (shm_segment == nullptr || accounts <= 0 || accounts > SHM_LEDGER_MAX_ACCOUNTS ||
+        initial_balance < 0) {
+        return -1;
+    }
+    for (long i = 0; i < SHM_LEDGER_MAX_ACCOUNTS; i++) {
+        shm_segment->ledger_balances[i].store(i < accounts ? initial_balance : 0,
+                                              std::memory_order_relaxed);
+    }
+    shm_segment->ledger_accounts = accounts;
+    return 0;
+}
+
+// Returns -1 for an unknown account or if not attached
+long shm_ledger_balance(long account) {
+    if (shm_segment == nullptr || account < 0 || account >= shm_segment->ledger_accounts) return -1;
+    return shm_segment->ledger_balances[account].load(std::memory_order_relaxed);
+}
+
+static long shm_ledger_total(const ShmSegment& seg) {
+    long total = 0;
+    for (long i = 0; i < seg.ledger_accounts; i++) {
+        total += seg.ledger_balances[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// Same stripe ordering as ledger_transfer_unchecked; -1 if a stripe is unrecoverable
+static int shm_ledger_transfer_unchecked(ShmSegment& seg, long from, long to, long amount) {
+    long first = from % SHM_LEDGER_STRIPES;
+    long second = to % SHM_LEDGER_STRIPES;
+    if (first > second) std::swap(first, second);
+    ShmLock first_lock(seg.ledger_stripes[first]);
+    if (!first_lock.held) return -1;
+    std::optional<ShmLock> second_lock;
+    if (second != first) {
+        second_lock.emplace(seg.ledger_stripes[second]);
+        if (!second_lock->held) return -1;
+    }
+
+    long balance = seg.ledger_balances[from].load(std::memory_order_relaxed);
+    if (balance < amount) return 0;
+    seg.ledger_balances[from].store(balance - amount, std::memory_order_relaxed);
+    seg.ledger_balances[to].fetch_add(amount, std::memory_order_relaxed);
+    return 1;
+}
+
+// 1 if moved, 0 for insufficient funds, -1 for bad accounts or amount (or
+// an unrecoverable stripe)
+int shm_ledger_transfer(long from, long to, long amount) {
+    if (shm_segment == nullptr) return -1;
+    long accounts = shm_segment->ledger_accounts;
+    if (from < 0 || from >= accounts || to < 0 || to >= accounts || amount < 0) return -1;
+    if (from == to) return 1;
+    return shm_ledger_transfer_unchecked(*shm_segment, from, to, amount);
+}
+
+// Zeroes the counters, refills the bank to 1000 and drains the channel;
+// only meaningful while no other process is using the segment. -1 if not
+// attached or the counter mutex is unrecoverable.
+int shm_reset() {
+    if (shm_segment == nullptr) return -1;
+    ShmSegment& seg = *shm_segment;
+    seg.atomic_counter.store(0);
+    seg.bank_balance.store(1000);
+    {
+        ShmLock lock(seg.counter_mutex);
+        if (!lock.held) return -1;
+        seg.safe_counter = 0;
+    }
+    for (CounterShard& shard : seg.shards) shard.value.store(0);
+    long value = 0;
+    while (ring_try_pop(seg.cells, SHM_CHANNEL_CAPACITY - 1, seg.dequeue_pos, value)) {
+    }
+    return 0;
+}
+
+// Filled by shm_get_stats
+struct ShmStats {
+    long attached_processes;
+    long atomic_counter;
+    long safe_counter;
+    long sharded_counter;
+    long bank_balance;
+    long channel_size;
+    long ledger_accounts;
+    long ledger_total;  // Only exact while no transfer is in flight
+};
+
+int shm_get_stats(ShmStats* out_stats) {
+    if (shm_segment == nullptr || out_stats == nullptr) return -1;
+    ShmSegment& seg = *shm_segment;
+    ShmStats stats{};
+    shm_prune_dead_attachers(seg);
+    stats.attached_processes = seg.attached.load(std::memory_order_relaxed);
+    stats.atomic_counter = seg.atomic_counter.load(std::memory_order_acquire);
+    {
+        ShmLock lock(seg.counter_mutex);
+        if (!lock.held) return -1;
+        stats.safe_counter = seg.safe_counter;
+    }
+    stats.sharded_counter = shm_sharded_total(seg);
+    stats.bank_balance = seg.bank_balance.load(std::memory_order_acquire);
+    stats.channel_size = static_cast<long>(seg.enqueue_pos.load(std::memory_order_acquire) -
+                                           seg.dequeue_pos.load(std::memory_order_acquire));
+    stats.ledger_accounts = seg.ledger_accounts;
+    stats.ledger_total = shm_ledger_total(seg);
+    *out_stats = stats;
+    return 0;
+}
+
+// Operations run_shm_benchmark can drive
+enum ShmBenchOp : int {
+    SHM_BENCH_ATOMIC = 0,   // fetch_add on one shared counter
+    SHM_BENCH_MUTEX = 1,    // Increment under the process-shared mutex
+    SHM_BENCH_SHARDED = 2,  // fetch_add on the worker's own shard
+    SHM_BENCH_LEDGER = 3,   // Transfers between 64 accounts
+    SHM_BENCH_CHANNEL = 4,  // Push then pop one value
+};
+
+// Filled by run_shm_benchmark
+struct ShmBenchStats {
+    int op;
+    int workers;
+    int processes;            // 1 if each worker was a forked process, 0 for threads
+    long total_ops;
+    double elapsed_seconds;
+    double ops_per_sec;
+    long expected;            // Counter delta, ledger total or value checksum...
+    long observed;            // ...and what the segment holds afterwards; must match
+};
+
+static constexpr long SHM_BENCH_ACCOUNTS = 64;
+static constexpr auto SHM_BENCH_START_TIMEOUT = std::chrono::seconds(10);
+
+// Runs in a forked child as well as a thread, so it must not allocate:
+// another thread of the parent may have held the allocator lock at fork.
+// False if a segment mutex turned out to be unrecoverable.
+static bool shm_bench_worker(ShmSegment& seg, int op, int worker, int iterations) {
+    seg.bench_ready.fetch_add(1, std::memory_order_acq_rel);
+    while (seg.bench_go.load(std::memory_order_acquire) == 0) {
+        CPU_RELAX();
+    }
+
+    CounterShard& shard = seg.shards[static_cast<unsigned>(worker) % SHARD_COUNT];
+    std::uint64_t rng = 0x9E3779B97F4A7C15ULL * static_cast<std::uint64_t>(worker + 1);
+    long checksum = 0;
+    for (int i = 0; i < iterations; i++) {
+        switch (op) {
+        case SHM_BENCH_ATOMIC:
+            seg.atomic_counter.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case SHM_BENCH_MUTEX: {
+            ShmLock lock(seg.counter_mutex);
+            if (!lock.held) return false;
+            seg.safe_counter++;
+            break;
+        }
+        case SHM_BENCH_SHARDED:
+            shard.value.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case SHM_BENCH_LEDGER: {
+            rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+            long from = static_cast<long>((rng >> 33) % SHM_BENCH_ACCOUNTS);
+            long to = static_cast<long>((rng >> 17) % SHM_BENCH_ACCOUNTS);
+            if (from != to && shm_ledger_transfer_unchecked(seg, from, to, static_cast<long>(rng >> 59)) < 0) {
+                return false;
+            }
+            break;
+        }
+        case SHM_BENCH_CHANNEL: {
+            // At most `workers` values are ever queued, so neither side spins
+            // for long; the checksum proves every value came out exactly once
+            long value = static_cast<long>(worker) * iterations + i;
+            while (!ring_try_push(seg.cells, SHM_CHANNEL_CAPACITY - 1, seg.enqueue_pos, value)) {
+                CPU_RELAX();
+            }
+            while (!ring_try_pop(seg.cells, SHM_CHANNEL_CAPACITY - 1, seg.dequeue_pos, value)) {
+                CPU_RELAX();
+            }
+            checksum += value;
+            break;
+        }
+        }
+    }
+    seg.bench_checksum.fetch_add(checksum, std::memory_order_relaxed);
+    return true;
+}
+
+static long shm_bench_observed(const ShmSegment& seg, int op) {
+    switch (op) {
+    case SHM_BENCH_ATOMIC: return seg.atomic_counter.load(std::memory_order_acquire);
+    case SHM_BENCH_MUTEX: return seg.safe_counter;
+    case SHM_BENCH_SHARDED: return shm_sharded_total(seg);
+    case SHM_BENCH_LEDGER: return shm_ledger_total(seg);
+    default: return seg.bench_checksum.load(std::memory_order_acquire);
+    }
+}
+
+// Drives `op` from `workers` forked processes (processes != 0) or threads
+// (processes == 0) on the attached segment, so cross-process contention is
+// measured against cross-thread contention on exactly the same memory.
+// Resets the segment first (shm_reset, and shm_ledger_init for the ledger),
+// so no other process should be using it. Returns 0, or -1 if not attached,
+// on bad arguments, if a worker failed or if the workers did not all start
+// within SHM_BENCH_START_TIMEOUT.
+int run_shm_benchmark(int op, int workers, int iterations, int processes, ShmBenchStats* out_stats) {
+    if (shm_segment == nullptr || op < SHM_BENCH_ATOMIC || op > SHM_BENCH_CHANNEL ||
+        workers <= 0 || workers > SHM_BENCH_MAX_WORKERS || iterations <= 0 || out_stats == nullptr) {
+        return -1;
+    }
+    ShmSegment& seg = *shm_segment;
+    if (shm_reset() != 0) return -1;
+    if (op == SHM_BENCH_LEDGER) shm_ledger_init(SHM_BENCH_ACCOUNTS, 1000);
+    seg.bench_ready.store(0);
+    seg.bench_go.store(0);
+    seg.bench_checksum.store(0);
+
+    long total_ops = static_cast<long>(workers) * iterations;
+    long expected = total_ops;
+    if (op == SHM_BENCH_LEDGER) expected = SHM_BENCH_ACCOUNTS * 1000;
+    if (op == SHM_BENCH_CHANNEL) expected = total_ops * (total_ops - 1) / 2;
+
+    std::vector<pid_t> children;
+    std::vector<std::thread> threads;
+    std::atomic<bool> thread_failed{false};
+    bool failed = false;
+    for (int w = 0; w < workers && !failed; w++) {
+        if (processes) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                _exit(shm_bench_worker(seg, op, w, iterations) ? 0 : 1);
+            }
+            if (pid < 0) failed = true;
+            else children.push_back(pid);
+        } else {
+            threads.emplace_back([&seg, &thread_failed, op, w, iterations] {
+                if (!shm_bench_worker(seg, op, w, iterations)) thread_failed.store(true);
+            });
+        }
+    }
+
+    // A child that dies before checking in would leave this waiting forever,
+    // so poll the children and give up at the deadline
+    int started = static_cast<int>(children.size() + threads.size());
+    auto deadline = std::chrono::steady_clock::now() + SHM_BENCH_START_TIMEOUT;
+    while (!failed && seg.bench_ready.load(std::memory_order_acquire) < started) {
+        for (pid_t& pid : children) {
+            int status = 0;
+            if (pid > 0 && waitpid(pid, &status, WNOHANG) == pid) {
+                pid = -1;  // Reaped; exiting before the go signal is a failure
+                failed = true;
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) failed = true;
+        std::this_thread::yield();
+    }
+    if (failed) {
+        for (pid_t pid : children) {
+            if (pid > 0) kill(pid, SIGKILL);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    seg.bench_go.store(1, std::memory_order_release);  // Also lets started threads finish on failure
+    for (auto& t : threads) t.join();
+    for (pid_t pid : children) {
+        if (pid < 0) continue;
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = true;
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (failed || thread_failed.load()) return -1;
+
+    ShmBenchStats stats{};
+    stats.op = op;
+    stats.workers = workers;
+    stats.processes = processes ? 1 : 0;
+    stats.total_ops = total_ops;
+    stats.elapsed_seconds = elapsed.count();
+    stats.ops_per_sec = elapsed.count() > 0
+        ? static_cast<double>(total_ops) / elapsed.count()
+        : 0.0;
+    stats.expected = expected;
+    stats.observed = shm_bench_observed(seg, op);
+    *out_stats = stats;
+    return 0;
+}
+
+
+// ============================================================================
+// PGO TRAINING - Representative workload for the profile-guided build
+// ============================================================================
+
+// Run by `make libthreadtest_pgo.so` against the instrumented library so
+// the profile reflects how the tests drive it: every native benchmark at 1
+// and 4 threads plus the direct per-call entry points. `scale` multiplies
+// the iteration counts. Returns 0, or -1 if scale <= 0 or any run fails.
+int run_pgo_training(int scale) {
+    if (scale <= 0) return -1;
+    const int iterations = 5000 * scale;
+    int failures = 0;
+    for (int threads : {1, 4}) {
+        SyncBenchStats sync;
+        for (int p = 0; p < SYNC_PRIMITIVE_COUNT; p++) {
+            failures += run_sync_benchmark(p, threads, iterations, &sync) != 0;
+        }
+        AllocBenchStats alloc;
+        for (int a = 0; a < ALLOC_COUNT; a++) {
+            failures += run_alloc_benchmark(a, threads, iterations, &alloc) != 0;
+        }
+        RwBenchStats rw;
+        for (int p = 0; p < RW_PRIMITIVE_COUNT; p++) {
+            failures += run_rw_benchmark(p, threads, iterations, 50, &rw) != 0;
+        }
+        MultiLockBenchStats multi;
+        for (int strategy = 0; strategy < MULTI_LOCK_STRATEGY_COUNT; strategy++) {
+            failures += run_multi_lock_benchmark(strategy, threads, iterations, 4, 64, &multi) != 0;
+        }
+        LedgerBenchStats ledger;
+        failures += run_ledger_benchmark(threads, iterations, 1000, 0.99, 1, &ledger) != 0;
+        failures += run_ledger_benchmark(threads, iterations, 1000, 0.99, 32, &ledger) != 0;
+        BarrierBenchStats barrier;
+        failures += run_barrier_benchmark(threads, 0, iterations / 10, 50, &barrier) != 0;
+        failures += run_barrier_benchmark(threads, 4, iterations / 10, 50, &barrier) != 0;
+        ObjectPoolBenchStats objects;
+        for (int mode = 0; mode < OBJECT_POOL_BENCH_MODE_COUNT; mode++) {
+            failures += run_object_pool_benchmark(mode, threads, iterations, 8, 10, &objects) != 0;
+        }
+    }
+
+    // Direct entry points, one call per FFI crossing as Python makes them
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 4; t++) {
+        callers.emplace_back([iterations] {
+            for (int i = 0; i < iterations; i++) {
+                safe_increment(1);
+                atomic_increment(1);
+                sharded_increment(1);
+                adaptive_increment(1);
+                combining_increment(1);
+                withdraw_safe(1);
+                seqlock_read();
+                rcu_read();
+                if (i % 16 == 0) {
+                    seqlock_write(i);
+                    rcu_publish(i);
+                }
+            }
+        });
+    }
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+
+    void* channel = channel_create(256);
+    for (int i = 0; i < iterations; i++) {
+        long value;
+        channel_try_push(channel, i);
+        channel_try_pop(channel, &value);
+    }
+    channel_destroy(channel);
+
+    failures += pool_run_tree(10) != 1024;
+    reset_counters();
+    return failures == 0 ? 0 : -1;
+}
+
 } // extern "C"
\ No newline at end of file
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""
+Locate, build and load a libthreadtest variant.
+
+THREADTEST_VARIANT selects the build the tests load, the way PROFILE does
+for setup_pybind11.py, so optimised numbers are never compared against
+the -O2 baseline by accident:
+
+    release  -O2 (default)            make all
+    fast     -O3 -march=native LTO    make libthreadtest_fast.so
+    pgo      fast + PGO               make libthreadtest_pgo.so
+    debug    -O0 -g                   make all
+    tsan     ThreadSanitizer          make all
+"""
+
+import ctypes
+import os
+import subprocess
+import sys
+from pathlib import Path
+
+RACE_DIR = Path(__file__).parent
+SHLIB_EXT = "dylib" if sys.platform == "darwin" else "so"
+
+VARIANTS = {
+    "release": "libthreadtest",
+    "fast": "libthreadtest_fast",
+    "pgo": "libthreadtest_pgo",
+    "debug": "libthreadtest_debug",
+    "tsan": "libthreadtest_tsan",
+}
+
+
+def variant_name(variant=None):
+    """Resolve the requested variant, defaulting to $THREADTEST_VARIANT or 'release'."""
+    name = variant or os.environ.get("THREADTEST_VARIANT", "release")
+    if name not in VARIANTS:
+        raise ValueError(f"Unknown THREADTEST_VARIANT '{name}', expected one of {sorted(VARIANTS)}")
+    return name
+
+
+def library_path(variant=None):
+    """Path of the shared library for a variant (it may not be built yet)."""
+    return RACE_DIR / f"{VARIANTS[variant_name(variant)]}.{SHLIB_EXT}"
+
+
+def build(variant=None):
+    """Run make for the default libraries plus the variant's own target."""
+    targets = ["all"]
+    if variant_name(variant) in ("fast", "pgo"):
+        targets.append(library_path(variant).name)
+    return subprocess.run(["make", *targets], cwd=RACE_DIR, capture_output=True, text=True)
+
+
+def load(variant=None):
+    """Load an already built variant."""
+    return ctypes.CDLL(str(library_path(variant)))